@@ -0,0 +1,185 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/Crypto/SHA1.h"
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+#include <mbedtls/sha1.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
+#include "Common/Swap.h"
+
+namespace Common
+{
+namespace SHA1
+{
+namespace
+{
+class ContextMbed final : public Context
+{
+public:
+  ContextMbed()
+  {
+    mbedtls_sha1_init(&m_ctx);
+    mbedtls_sha1_starts(&m_ctx);
+  }
+  ~ContextMbed() override { mbedtls_sha1_free(&m_ctx); }
+  void Update(const u8* msg, size_t len) override { mbedtls_sha1_update(&m_ctx, msg, len); }
+  Digest Finish() override
+  {
+    Digest digest;
+    mbedtls_sha1_finish(&m_ctx, digest.data());
+    return digest;
+  }
+
+private:
+  mbedtls_sha1_context m_ctx;
+};
+
+#if defined(_M_X86)
+FUNCTION_TARGET_SHA inline void Rounds(std::integral_constant<int, 20>, __m128i&, __m128i (&)[2],
+                                       __m128i (&)[4])
+{
+}
+
+// Four rounds per call. e alternates between holding the next E value and the saved ABCD, and
+// msg holds the message schedule as a ring of four vectors.
+template <int I>
+FUNCTION_TARGET_SHA inline void Rounds(std::integral_constant<int, I>, __m128i& abcd,
+                                       __m128i (&e)[2], __m128i (&msg)[4])
+{
+  if (I == 0)
+    e[0] = _mm_add_epi32(e[0], msg[0]);
+  else
+    e[I % 2] = _mm_sha1nexte_epu32(e[I % 2], msg[I % 4]);
+  e[(I + 1) % 2] = abcd;
+
+  if (I >= 3 && I <= 18)
+    msg[(I + 1) % 4] = _mm_sha1msg2_epu32(msg[(I + 1) % 4], msg[I % 4]);
+  abcd = _mm_sha1rnds4_epu32(abcd, e[I % 2], I / 5);
+  if (I >= 1 && I <= 16)
+    msg[(I + 3) % 4] = _mm_sha1msg1_epu32(msg[(I + 3) % 4], msg[I % 4]);
+  if (I >= 2 && I <= 17)
+    msg[(I + 2) % 4] = _mm_xor_si128(msg[(I + 2) % 4], msg[I % 4]);
+
+  Rounds(std::integral_constant<int, I + 1>(), abcd, e, msg);
+}
+
+FUNCTION_TARGET_SHA void CompressSHANI(u32* state, const u8* data, size_t num_blocks)
+{
+  const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+  __m128i abcd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+  abcd = _mm_shuffle_epi32(abcd, 0x1B);
+  __m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+  for (size_t i = 0; i < num_blocks; ++i, data += 64)
+  {
+    const __m128i abcd_save = abcd;
+    const __m128i e0_save = e0;
+
+    __m128i msg[4];
+    for (int j = 0; j < 4; ++j)
+    {
+      msg[j] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j * 16)),
+                                byte_swap);
+    }
+
+    __m128i e[2] = {e0, _mm_setzero_si128()};
+    Rounds(std::integral_constant<int, 0>(), abcd, e, msg);
+
+    e0 = _mm_sha1nexte_epu32(e[0], e0_save);
+    abcd = _mm_add_epi32(abcd, abcd_save);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+  state[4] = _mm_extract_epi32(e0, 3);
+}
+
+class ContextSHANI final : public Context
+{
+public:
+  void Update(const u8* msg, size_t len) override
+  {
+    m_length += len;
+
+    if (m_buffer_size != 0)
+    {
+      const size_t to_copy = std::min(len, m_buffer.size() - m_buffer_size);
+      std::copy_n(msg, to_copy, m_buffer.data() + m_buffer_size);
+      m_buffer_size += to_copy;
+      msg += to_copy;
+      len -= to_copy;
+      if (m_buffer_size != m_buffer.size())
+        return;
+      CompressSHANI(m_state.data(), m_buffer.data(), 1);
+      m_buffer_size = 0;
+    }
+
+    CompressSHANI(m_state.data(), msg, len / 64);
+    m_buffer_size = len % 64;
+    std::copy_n(msg + len - m_buffer_size, m_buffer_size, m_buffer.data());
+  }
+
+  Digest Finish() override
+  {
+    const u64 length_be = Common::swap64(m_length * 8);
+
+    // A 0x80 byte, then zeroes up to 8 bytes before a block boundary, then the length in bits.
+    std::array<u8, 72> padding{};
+    padding[0] = 0x80;
+    const size_t padding_size = (m_buffer_size < 56 ? 56 : 120) - m_buffer_size;
+    Update(padding.data(), padding_size);
+    Update(reinterpret_cast<const u8*>(&length_be), sizeof(length_be));
+
+    Digest digest;
+    for (size_t i = 0; i < m_state.size(); ++i)
+    {
+      const u32 word_be = Common::swap32(m_state[i]);
+      std::copy_n(reinterpret_cast<const u8*>(&word_be), sizeof(word_be), &digest[i * 4]);
+    }
+    return digest;
+  }
+
+private:
+  std::array<u32, 5> m_state = {{0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0}};
+  std::array<u8, 64> m_buffer;
+  size_t m_buffer_size = 0;
+  u64 m_length = 0;
+};
+#endif
+}  // Anonymous namespace
+
+std::unique_ptr<Context> CreateContext()
+{
+#if defined(_M_X86)
+  if (cpu_info.bSHA1 && cpu_info.bSSE4_1)
+    return std::make_unique<ContextSHANI>();
+#endif
+  return std::make_unique<ContextMbed>();
+}
+
+Digest CalculateDigest(const u8* msg, size_t len)
+{
+  // This is used for lots of small inputs (like the 1 KiB hashes of Wii discs), so avoid the
+  // allocation in CreateContext.
+#if defined(_M_X86)
+  if (cpu_info.bSHA1 && cpu_info.bSSE4_1)
+  {
+    ContextSHANI context;
+    context.Update(msg, len);
+    return context.Finish();
+  }
+#endif
+  Digest digest;
+  mbedtls_sha1(msg, len, digest.data());
+  return digest;
+}
+}  // namespace SHA1
+}  // namespace Common
@@ -0,0 +1,32 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+namespace SHA1
+{
+using Digest = std::array<u8, 20>;
+
+class Context
+{
+public:
+  virtual ~Context() = default;
+  virtual void Update(const u8* msg, size_t len) = 0;
+  virtual Digest Finish() = 0;
+};
+
+// Uses the SHA extensions of the host CPU if they are available, and mbedtls otherwise.
+std::unique_ptr<Context> CreateContext();
+
+Digest CalculateDigest(const u8* msg, size_t len);
+}  // namespace SHA1
+}  // namespace Common
@@ -101,6 +101,8 @@ public:
   bool IsFile() const;
   // Returns the size of a file (or returns 0 if the path doesn't refer to a file)
   u64 GetSize() const;
+  // Returns when the path was last modified, in seconds since the epoch (or 0 if it doesn't exist)
+  s64 GetModificationTime() const;
 
 private:
   struct stat m_stat;
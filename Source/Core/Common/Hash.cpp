@@ -501,14 +501,232 @@ static u64 GetMurmurHash3(const u8* src, u32 len, u32 samples)
 }
 #endif
 
+//-----------------------------------------------------------------------------
+// Full hash, modelled on the loop XXH3 uses for long inputs. Every byte is hashed, and the loop
+// maps directly to SIMD: eight 64-bit accumulators, each of which takes one 64-bit word of every
+// 64-byte stripe. The SSE2 and AVX2 versions give the same results as the generic one.
+
+constexpr u32 FULL_HASH_STRIPE_SIZE = 64;
+constexpr u32 FULL_HASH_STRIPES_PER_BLOCK = 16;
+constexpr u32 FULL_HASH_BLOCK_SIZE = FULL_HASH_STRIPE_SIZE * FULL_HASH_STRIPES_PER_BLOCK;
+constexpr u32 FULL_HASH_PRIME32 = 0x9E3779B1;
+constexpr u64 FULL_HASH_PRIME64 = 0x9E3779B185EBCA87;
+
+// Each stripe of a block uses the key one word further along, and the words after those scramble
+// the accumulators after each block.
+alignas(32) static const u64 s_full_hash_key[24] = {
+    0xC0E16B163A85A4DC, 0x890ACD8DD443C47C, 0xB3889D8A6DC47761, 0x6A0398E528F0AE6A,
+    0x048344ECE48A855E, 0xF175CFEA21871330, 0x391CEEF02702C2FD, 0x4BAF8CAC4784CB12,
+    0x3547744583A3F88E, 0xD9CF2B15C6B6C90E, 0x961FACC76D5FE21C, 0x0094AB49D50F11F9,
+    0xE3211E37BDBEB6DC, 0x62FE6C274FF3511A, 0x5AC30B329FDF0574, 0x1450582C6B65B406,
+    0x7A30FCC7888EB791, 0x5540F5BA6A15576E, 0x16CEF0559096D3E9, 0x2CF8F14B06874899,
+    0xC9C9263B6E2CE103, 0xD6FF920B0A9FAA6D, 0x53192697DB998DC1, 0x73EA9B9BC7CD18D7,
+};
+static const u64* const s_full_hash_scramble_key = s_full_hash_key + FULL_HASH_STRIPES_PER_BLOCK;
+static const u64* const s_full_hash_last_key = s_full_hash_key + 13;
+
+// Where the parts of the data are. Every version walks them the same way: whole blocks, then the
+// whole stripes before the last one, then the last 64 bytes, which may overlap the stripe before.
+// Needs len >= FULL_HASH_STRIPE_SIZE.
+struct FullHashLayout
+{
+  explicit FullHashLayout(u32 len)
+      : num_blocks((len - 1) / FULL_HASH_BLOCK_SIZE),
+        num_stripes(((len - 1) % FULL_HASH_BLOCK_SIZE) / FULL_HASH_STRIPE_SIZE),
+        last_stripe_offset(len - FULL_HASH_STRIPE_SIZE)
+  {
+  }
+
+  u32 num_blocks;
+  u32 num_stripes;  // in the last block, not counting the last stripe
+  u32 last_stripe_offset;
+};
+
+static void FullHashStripeGeneric(u64* acc, const u8* src, const u64* key)
+{
+  for (int i = 0; i < 8; ++i)
+  {
+    u64 data;
+    std::memcpy(&data, src + i * sizeof(u64), sizeof(u64));
+    const u64 data_key = data ^ key[i];
+    acc[i ^ 1] += data;
+    acc[i] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+  }
+}
+
+static void FullHashAccumulateGeneric(u64* acc, const u8* src, u32 len)
+{
+  const FullHashLayout layout(len);
+  const u8* block = src;
+  for (u32 i = 0; i < layout.num_blocks; ++i, block += FULL_HASH_BLOCK_SIZE)
+  {
+    for (u32 j = 0; j < FULL_HASH_STRIPES_PER_BLOCK; ++j)
+      FullHashStripeGeneric(acc, block + j * FULL_HASH_STRIPE_SIZE, s_full_hash_key + j);
+
+    for (int j = 0; j < 8; ++j)
+      acc[j] = (acc[j] ^ (acc[j] >> 47) ^ s_full_hash_scramble_key[j]) * FULL_HASH_PRIME32;
+  }
+
+  for (u32 j = 0; j < layout.num_stripes; ++j)
+    FullHashStripeGeneric(acc, block + j * FULL_HASH_STRIPE_SIZE, s_full_hash_key + j);
+  FullHashStripeGeneric(acc, src + layout.last_stripe_offset, s_full_hash_last_key);
+}
+
+#if defined(_M_X86)
+static inline void FullHashStripeSSE2(__m128i* acc, const u8* src, const u64* key)
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src) + i);
+    const __m128i data_key =
+        _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key) + i));
+    const __m128i product = _mm_mul_epu32(data_key, _mm_srli_epi64(data_key, 32));
+    // Swapping the two words adds each of them to the other accumulator, like acc[i ^ 1]
+    const __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+    acc[i] = _mm_add_epi64(acc[i], _mm_add_epi64(product, swapped));
+  }
+}
+
+static void FullHashAccumulateSSE2(u64* acc_out, const u8* src, u32 len)
+{
+  __m128i acc[4];
+  for (int i = 0; i < 4; ++i)
+    acc[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc_out) + i);
+
+  const FullHashLayout layout(len);
+  const __m128i prime = _mm_set1_epi32(static_cast<int>(FULL_HASH_PRIME32));
+  const u8* block = src;
+  for (u32 i = 0; i < layout.num_blocks; ++i, block += FULL_HASH_BLOCK_SIZE)
+  {
+    for (u32 j = 0; j < FULL_HASH_STRIPES_PER_BLOCK; ++j)
+      FullHashStripeSSE2(acc, block + j * FULL_HASH_STRIPE_SIZE, s_full_hash_key + j);
+
+    for (int j = 0; j < 4; ++j)
+    {
+      const __m128i key =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(s_full_hash_scramble_key) + j);
+      const __m128i value = _mm_xor_si128(_mm_xor_si128(acc[j], _mm_srli_epi64(acc[j], 47)), key);
+      // A 64-bit by 32-bit multiplication out of two 32-bit by 32-bit ones
+      const __m128i low = _mm_mul_epu32(value, prime);
+      const __m128i high = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+      acc[j] = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+    }
+  }
+
+  for (u32 j = 0; j < layout.num_stripes; ++j)
+    FullHashStripeSSE2(acc, block + j * FULL_HASH_STRIPE_SIZE, s_full_hash_key + j);
+  FullHashStripeSSE2(acc, src + layout.last_stripe_offset, s_full_hash_last_key);
+
+  for (int i = 0; i < 4; ++i)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc_out) + i, acc[i]);
+}
+
+FUNCTION_TARGET_AVX2
+static inline void FullHashStripeAVX2(__m256i* acc, const u8* src, const u64* key)
+{
+  for (int i = 0; i < 2; ++i)
+  {
+    const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src) + i);
+    const __m256i data_key =
+        _mm256_xor_si256(data, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key) + i));
+    const __m256i product = _mm256_mul_epu32(data_key, _mm256_srli_epi64(data_key, 32));
+    const __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+    acc[i] = _mm256_add_epi64(acc[i], _mm256_add_epi64(product, swapped));
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void FullHashAccumulateAVX2(u64* acc_out, const u8* src, u32 len)
+{
+  __m256i acc[2];
+  for (int i = 0; i < 2; ++i)
+    acc[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc_out) + i);
+
+  const FullHashLayout layout(len);
+  const __m256i prime = _mm256_set1_epi32(static_cast<int>(FULL_HASH_PRIME32));
+  const u8* block = src;
+  for (u32 i = 0; i < layout.num_blocks; ++i, block += FULL_HASH_BLOCK_SIZE)
+  {
+    for (u32 j = 0; j < FULL_HASH_STRIPES_PER_BLOCK; ++j)
+      FullHashStripeAVX2(acc, block + j * FULL_HASH_STRIPE_SIZE, s_full_hash_key + j);
+
+    for (int j = 0; j < 2; ++j)
+    {
+      const __m256i key =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s_full_hash_scramble_key) + j);
+      const __m256i value =
+          _mm256_xor_si256(_mm256_xor_si256(acc[j], _mm256_srli_epi64(acc[j], 47)), key);
+      const __m256i low = _mm256_mul_epu32(value, prime);
+      const __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(value, 32), prime);
+      acc[j] = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+    }
+  }
+
+  for (u32 j = 0; j < layout.num_stripes; ++j)
+    FullHashStripeAVX2(acc, block + j * FULL_HASH_STRIPE_SIZE, s_full_hash_key + j);
+  FullHashStripeAVX2(acc, src + layout.last_stripe_offset, s_full_hash_last_key);
+
+  for (int i = 0; i < 2; ++i)
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc_out) + i, acc[i]);
+}
+#endif
+
+static void (*s_full_hash_accumulate)(u64* acc, const u8* src, u32 len) =
+    FullHashAccumulateGeneric;
+
+static u64 FullHashAvalanche(u64 h)
+{
+  h ^= h >> 37;
+  h *= 0x165667919E3779F9;
+  h ^= h >> 32;
+  return h;
+}
+
+// The samples are ignored, since hashing everything is fast enough
+static u64 GetFullHash(const u8* src, u32 len, u32 samples)
+{
+  u64 acc[8] = {0xC2B2AE3D,         FULL_HASH_PRIME64,  0xC2B2AE3D27D4EB4F, 0x165667B19E3779F9,
+                0x85EBCA77C2B2AE63, 0x85EBCA77,         0x27D4EB2F165667C5, FULL_HASH_PRIME32};
+
+  if (len >= FULL_HASH_STRIPE_SIZE)
+  {
+    s_full_hash_accumulate(acc, src, len);
+  }
+  else
+  {
+    // Short data is zero extended to one stripe, and the length tells the two apart
+    alignas(16) u8 stripe[FULL_HASH_STRIPE_SIZE] = {};
+    std::memcpy(stripe, src, len);
+    s_full_hash_accumulate(acc, stripe, FULL_HASH_STRIPE_SIZE);
+  }
+
+  u64 h = len * FULL_HASH_PRIME64;
+  for (int i = 0; i < 8; ++i)
+    h = (h ^ FullHashAvalanche(acc[i] ^ s_full_hash_key[i + 3])) * FULL_HASH_PRIME64;
+  return FullHashAvalanche(h);
+}
+
 u64 GetHash64(const u8* src, u32 len, u32 samples)
 {
   return ptrHashFunction(src, len, samples);
 }
 
 // sets the hash function used for the texture cache
-void SetHash64Function()
+void SetHash64Function(bool full_hash)
 {
+  if (full_hash)
+  {
+    s_full_hash_accumulate = FullHashAccumulateGeneric;
+#if defined(_M_X86)
+    if (cpu_info.bAVX2)
+      s_full_hash_accumulate = FullHashAccumulateAVX2;
+    else if (cpu_info.bSSE2)
+      s_full_hash_accumulate = FullHashAccumulateSSE2;
+#endif
+    ptrHashFunction = &GetFullHash;
+    return;
+  }
+
 #if defined(_M_X86_64) || defined(_M_X86)
   if (cpu_info.bSSE4_2)  // sse crc32 version
   {
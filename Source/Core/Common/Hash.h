@@ -14,5 +14,7 @@ u32 HashFletcher(const u8* data_u8, size_t length);  // FAST. Length & 1 == 0.
 u32 HashAdler32(const u8* data, size_t len);         // Fairly accurate, slightly slower
 u32 HashEctor(const u8* ptr, int length);            // JUNK. DO NOT USE FOR NEW THINGS
 u64 GetHash64(const u8* src, u32 len, u32 samples);
-void SetHash64Function();
+// With full_hash set, GetHash64 ignores the samples and hashes every byte with a hash which is
+// fast enough for that. Its hashes differ from the sampled hash, even with samples = 0.
+void SetHash64Function(bool full_hash);
 }  // namespace Common
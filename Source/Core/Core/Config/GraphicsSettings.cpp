@@ -55,6 +55,11 @@ const ConfigInfo<bool> GFX_INTERNAL_RESOLUTION_FRAME_DUMPS{
     {System::GFX, "Settings", "InternalResolutionFrameDumps"}, false};
 const ConfigInfo<bool> GFX_ENABLE_GPU_TEXTURE_DECODING{
     {System::GFX, "Settings", "EnableGPUTextureDecoding"}, false};
+const ConfigInfo<int> GFX_TEXTURE_DECODING_THREADS{
+    {System::GFX, "Settings", "TextureDecodingThreads"}, -1};
+const ConfigInfo<bool> GFX_TRACK_TEXTURE_WRITES{{System::GFX, "Settings", "TrackTextureWrites"},
+                                                false};
+const ConfigInfo<bool> GFX_FULL_TEXTURE_HASH{{System::GFX, "Settings", "FullTextureHash"}, false};
 const ConfigInfo<bool> GFX_ENABLE_PIXEL_LIGHTING{{System::GFX, "Settings", "EnablePixelLighting"},
                                                  false};
 const ConfigInfo<bool> GFX_FAST_DEPTH_CALC{{System::GFX, "Settings", "FastDepthCalc"}, true};
@@ -49,6 +49,9 @@ extern const ConfigInfo<std::string> GFX_DUMP_PATH;
 extern const ConfigInfo<int> GFX_BITRATE_KBPS;
 extern const ConfigInfo<bool> GFX_INTERNAL_RESOLUTION_FRAME_DUMPS;
 extern const ConfigInfo<bool> GFX_ENABLE_GPU_TEXTURE_DECODING;
+extern const ConfigInfo<int> GFX_TEXTURE_DECODING_THREADS;
+extern const ConfigInfo<bool> GFX_TRACK_TEXTURE_WRITES;
+extern const ConfigInfo<bool> GFX_FULL_TEXTURE_HASH;
 extern const ConfigInfo<bool> GFX_ENABLE_PIXEL_LIGHTING;
 extern const ConfigInfo<bool> GFX_FAST_DEPTH_CALC;
 extern const ConfigInfo<u32> GFX_MSAA;
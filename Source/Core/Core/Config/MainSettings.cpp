@@ -105,6 +105,22 @@ const ConfigInfo<bool> MAIN_ENABLE_SIGNATURE_CHECKS{{System::Main, "Core", "Enab
                                                     true};
 const ConfigInfo<bool> MAIN_REDUCE_POLLING_RATE{{System::Main, "Core", "ReducePollingRate"}, false};
 const ConfigInfo<bool> MAIN_AUTO_DISC_CHANGE{{System::Main, "Core", "AutoDiscChange"}, false};
+const ConfigInfo<bool> MAIN_JIT_PERSISTENT_CACHE{{System::Main, "Core", "JITPersistentCache"},
+                                                 false};
+const ConfigInfo<int> MAIN_JIT_TIER_UP_THRESHOLD{{System::Main, "Core", "JITTierUpThreshold"}, 0};
+const ConfigInfo<bool> MAIN_JIT_TRACE_FORMATION{{System::Main, "Core", "JITTraceFormation"}, false};
+const ConfigInfo<bool> MAIN_JIT_REGISTER_RESIDENCY{{System::Main, "Core", "JITRegisterResidency"},
+                                                   false};
+// In seconds. 0 disables the periodic dump (and the block profiling it enables).
+const ConfigInfo<int> MAIN_JIT_PROFILE_DUMP_INTERVAL{
+    {System::Main, "Core", "JITProfileDumpInterval"}, 0};
+// In MiB. Compressed disc images share decompressed chunks with other running instances of
+// Dolphin through a cache of this size (one for each chunk size in use). 0 disables it.
+const ConfigInfo<int> MAIN_SHARED_CHUNK_CACHE_SIZE{{System::Main, "Core", "SharedChunkCacheSize"},
+                                                   0};
+// Plain disc images are read through a memory mapping. Off by default, since a mapped image
+// that gets truncated or whose drive or share goes away crashes Dolphin instead of failing reads.
+const ConfigInfo<bool> MAIN_MAP_DISC_IMAGES{{System::Main, "Core", "MapDiscImages"}, false};
 
 // Main.Display
 
@@ -79,6 +79,13 @@ extern const ConfigInfo<u32> MAIN_CUSTOM_RTC_VALUE;
 extern const ConfigInfo<bool> MAIN_ENABLE_SIGNATURE_CHECKS;
 extern const ConfigInfo<bool> MAIN_REDUCE_POLLING_RATE;
 extern const ConfigInfo<bool> MAIN_AUTO_DISC_CHANGE;
+extern const ConfigInfo<bool> MAIN_JIT_PERSISTENT_CACHE;
+extern const ConfigInfo<int> MAIN_JIT_TIER_UP_THRESHOLD;
+extern const ConfigInfo<bool> MAIN_JIT_TRACE_FORMATION;
+extern const ConfigInfo<bool> MAIN_JIT_REGISTER_RESIDENCY;
+extern const ConfigInfo<int> MAIN_JIT_PROFILE_DUMP_INTERVAL;
+extern const ConfigInfo<int> MAIN_SHARED_CHUNK_CACHE_SIZE;
+extern const ConfigInfo<bool> MAIN_MAP_DISC_IMAGES;
 
 // Main.DSP
 
@@ -32,6 +32,13 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::MAIN_MEMCARD_A_PATH.location,
       Config::MAIN_MEMCARD_B_PATH.location,
       Config::MAIN_AUTO_DISC_CHANGE.location,
+      Config::MAIN_JIT_PERSISTENT_CACHE.location,
+      Config::MAIN_JIT_TIER_UP_THRESHOLD.location,
+      Config::MAIN_JIT_TRACE_FORMATION.location,
+      Config::MAIN_JIT_REGISTER_RESIDENCY.location,
+      Config::MAIN_JIT_PROFILE_DUMP_INTERVAL.location,
+      Config::MAIN_SHARED_CHUNK_CACHE_SIZE.location,
+      Config::MAIN_MAP_DISC_IMAGES.location,
 
       // Main.Display
       Config::MAIN_FULLSCREEN_DISPLAY_RES.location,
@@ -72,6 +79,9 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_BITRATE_KBPS.location,
       Config::GFX_INTERNAL_RESOLUTION_FRAME_DUMPS.location,
       Config::GFX_ENABLE_GPU_TEXTURE_DECODING.location,
+      Config::GFX_TEXTURE_DECODING_THREADS.location,
+      Config::GFX_TRACK_TEXTURE_WRITES.location,
+      Config::GFX_FULL_TEXTURE_HASH.location,
       Config::GFX_ENABLE_PIXEL_LIGHTING.location,
       Config::GFX_FAST_DEPTH_CALC.location,
       Config::GFX_MSAA.location,
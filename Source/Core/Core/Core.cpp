@@ -50,6 +50,7 @@
 #include "Core/HW/GCKeyboard.h"
 #include "Core/HW/GCPad.h"
 #include "Core/HW/HW.h"
+#include "Core/HW/Memmap.h"
 #include "Core/HW/SystemTimers.h"
 #include "Core/HW/VideoInterface.h"
 #include "Core/HW/Wiimote.h"
@@ -313,8 +314,15 @@ static void CpuThread(const std::optional<std::string>& savestate_path, bool del
   DolphinAnalytics::Instance()->ReportGameStart();
 
   if (_CoreParameter.bFastmem)
+  {
     EMM::InstallExceptionHandler();  // Let's run under memory watch
 
+    // Tracked memory is also written by the video thread and the IOS code, so their faults have
+    // to reach the handler as well
+    if (EMM::IsExceptionHandlerProcessWide())
+      Memory::EnableWriteTracking(true);
+  }
+
 #ifdef USE_MEMORYWATCHER
   MemoryWatcher::Init();
 #endif
@@ -352,7 +360,10 @@ static void CpuThread(const std::optional<std::string>& savestate_path, bool del
   s_is_started = false;
 
   if (_CoreParameter.bFastmem)
+  {
+    Memory::EnableWriteTracking(false);
     EMM::UninstallExceptionHandler();
+  }
 }
 
 static void FifoPlayerThread(const std::optional<std::string>& savestate_path,
@@ -774,6 +785,9 @@ void VideoThrottle()
   }
 
   s_drawn_video++;
+
+  // VI runs on the CPU thread, which lets the JIT profile be read without pausing.
+  JitInterface::UpdateProfileDump();
 }
 
 // --- Callbacks for backends / engine ---
@@ -40,6 +40,9 @@ namespace DVDThread
 struct ReadRequest
 {
   bool copy_to_ram;
+  // Set by the DVD thread when the data can be copied straight from the memory-mapped disc image.
+  // The result buffer is then left empty and FinishRead copies from s_disc instead.
+  bool read_in_place;
   u32 output_address;
   u64 dvd_offset;
   u32 length;
@@ -73,6 +76,8 @@ static void StartReadInternal(bool copy_to_ram, u32 output_address, u64 dvd_offs
                               const DiscIO::Partition& partition,
                               DVDInterface::ReplyType reply_type, s64 ticks_until_completion);
 
+static void CopyInPlaceResultsToBuffers();
+
 static void FinishRead(u64 id, s64 cycles_late);
 static CoreTiming::EventType* s_finish_read;
 
@@ -141,9 +146,9 @@ void DoState(PointerWrap& p)
   // Move all results from s_result_queue to s_result_map because
   // PointerWrap::Do supports std::map but not Common::SPSCQueue.
   // This won't affect the behavior of FinishRead.
-  ReadResult result;
-  while (s_result_queue.Pop(result))
-    s_result_map.emplace(result.first.id, std::move(result));
+  // Savestates can't refer to the disc image, so results that would have been read in place
+  // get their buffers filled now.
+  CopyInPlaceResultsToBuffers();
 
   // Both queues are now empty, so we don't need to savestate them.
   p.Do(s_result_map);
@@ -178,6 +183,8 @@ void DoState(PointerWrap& p)
 void SetDisc(std::unique_ptr<DiscIO::Volume> disc)
 {
   WaitUntilIdle();
+  // Reads that haven't finished yet still need the data of the old disc.
+  CopyInPlaceResultsToBuffers();
   s_disc = std::move(disc);
 }
 
@@ -278,6 +285,7 @@ static void StartReadInternal(bool copy_to_ram, u32 output_address, u64 dvd_offs
   ReadRequest request;
 
   request.copy_to_ram = copy_to_ram;
+  request.read_in_place = false;
   request.output_address = output_address;
   request.dvd_offset = dvd_offset;
   request.length = length;
@@ -296,6 +304,25 @@ static void StartReadInternal(bool copy_to_ram, u32 output_address, u64 dvd_offs
   CoreTiming::ScheduleEvent(ticks_until_completion, s_finish_read, id);
 }
 
+// Must only be called while the DVD thread is idle. Moves all results to s_result_map.
+static void CopyInPlaceResultsToBuffers()
+{
+  ReadResult result;
+  while (s_result_queue.Pop(result))
+    s_result_map.emplace(result.first.id, std::move(result));
+
+  for (auto& entry : s_result_map)
+  {
+    ReadRequest& request = entry.second.first;
+    if (!request.read_in_place)
+      continue;
+
+    const u8* data = s_disc->GetMappedData(request.dvd_offset, request.length, request.partition);
+    entry.second.second.assign(data, data + request.length);
+    request.read_in_place = false;
+  }
+}
+
 static void FinishRead(u64 id, s64 cycles_late)
 {
   // We can't simply pop s_result_queue and always get the ReadResult
@@ -342,7 +369,14 @@ static void FinishRead(u64 id, s64 cycles_late)
             (CoreTiming::GetTicks() - request.time_started_ticks) /
                 (SystemTimers::GetTicksPerSecond() / 1000000));
 
-  if (buffer.size() != request.length)
+  if (request.read_in_place)
+  {
+    // The DVD thread has checked that the whole range is mapped, and s_disc can't have changed
+    // since then because SetDisc copies the data of pending in-place reads.
+    const u8* data = s_disc->GetMappedData(request.dvd_offset, request.length, request.partition);
+    Memory::CopyToEmu(request.output_address, data, request.length);
+  }
+  else if (buffer.size() != request.length)
   {
     PanicAlertT("The disc could not be read (at 0x%" PRIx64 " - 0x%" PRIx64 ").",
                 request.dvd_offset, request.dvd_offset + request.length);
@@ -358,6 +392,19 @@ static void FinishRead(u64 id, s64 cycles_late)
                                        buffer);
 }
 
+// Faults in the pages of memory-mapped data so that the CPU thread doesn't have to wait for
+// the disk when it later copies the data to emulated RAM.
+static void TouchPages(const u8* data, u32 length)
+{
+  constexpr u32 BYTES_PER_PAGE = 0x1000;
+
+  volatile u8 sink = 0;
+  for (u32 i = 0; i < length; i += BYTES_PER_PAGE)
+    sink = sink + data[i];
+  if (length != 0)
+    sink = sink + data[length - 1];
+}
+
 static void DVDThread()
 {
   Common::SetCurrentThreadName("DVD thread");
@@ -374,9 +421,23 @@ static void DVDThread()
     {
       FileMonitor::Log(*s_disc, request.partition, request.dvd_offset);
 
-      std::vector<u8> buffer(request.length);
-      if (!s_disc->Read(request.dvd_offset, request.length, buffer.data(), request.partition))
-        buffer.resize(0);
+      std::vector<u8> buffer;
+      const u8* mapped_data =
+          request.copy_to_ram ?
+              s_disc->GetMappedData(request.dvd_offset, request.length, request.partition) :
+              nullptr;
+      if (mapped_data)
+      {
+        // Skip the intermediate buffer. Any disk I/O still happens on this thread, though.
+        TouchPages(mapped_data, request.length);
+        request.read_in_place = true;
+      }
+      else
+      {
+        buffer.resize(request.length);
+        if (!s_disc->Read(request.dvd_offset, request.length, buffer.data(), request.partition))
+          buffer.resize(0);
+      }
 
       request.realtime_done_us = Common::Timer::GetTimeUs();
 
@@ -10,13 +10,21 @@
 #include "Core/HW/Memmap.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Common/Swap.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/AudioInterface.h"
@@ -109,10 +117,26 @@ struct PhysicalMemoryRegion
   u32 shm_position;
 };
 
+// Write tracking covers RAM followed by EXRAM. Offsets into this space are called tracking
+// offsets.
+constexpr u32 WRITE_TRACKING_PAGE_SHIFT = 12;
+constexpr u32 WRITE_TRACKING_PAGE_SIZE = 1 << WRITE_TRACKING_PAGE_SHIFT;
+constexpr u32 NOT_TRACKED = 0xFFFFFFFF;
+
+struct WriteTrackingPage
+{
+  u32 write_count = 0;
+  bool is_protected = false;
+  // HostWriteAccess objects for the page, which keep it from being protected
+  u32 host_writes = 0;
+};
+
 struct LogicalMemoryView
 {
   void* mapped_pointer;
   u32 mapped_size;
+  // NOT_TRACKED unless the view shows RAM or EXRAM
+  u32 tracking_offset;
 };
 
 // Dolphin allocates memory to represent four regions:
@@ -164,6 +188,112 @@ static PhysicalMemoryRegion physical_regions[] = {
 
 static std::vector<LogicalMemoryView> logical_mapped_entries;
 
+// Guards the pages and the protection of the views, including logical_mapped_entries while
+// tracking is enabled.
+// HandleWriteFault takes this lock from inside the SIGSEGV handler or the VEH. Code that holds
+// it must therefore never write to tracked memory, not even indirectly through e.g.
+// Memory::Write_U32 or a memcpy: the fault would try to take the lock again on the same thread
+// and deadlock. Keep the critical sections to the bookkeeping of the pages.
+static std::mutex s_write_tracking_lock;
+static std::atomic<bool> s_write_tracking_enabled{false};
+static std::vector<WriteTrackingPage> s_write_tracking_pages;
+
+static bool IsTrackedOffset(u32 offset)
+{
+  // The 8MB after the real RAM aren't tracked, so protected pages never run from RAM into EXRAM
+  return offset < REALRAM_SIZE ||
+         (m_pEXRAM && offset >= RAM_SIZE && offset - RAM_SIZE < EXRAM_SIZE);
+}
+
+// Maps addresses the same way as GetPointer
+static u32 GetTrackingOffset(u32 address)
+{
+  address &= 0x3FFFFFFF;
+  if (address < REALRAM_SIZE)
+    return address;
+  if (m_pEXRAM && (address >> 28) == 0x1 && (address & 0x0fffffff) < EXRAM_SIZE)
+    return RAM_SIZE + (address & EXRAM_MASK);
+  return NOT_TRACKED;
+}
+
+static u32 GetTrackingOffsetOfHostAddress(uintptr_t address)
+{
+  u32 offset = NOT_TRACKED;
+  if (address - reinterpret_cast<uintptr_t>(m_pRAM) < RAM_SIZE)
+  {
+    offset = static_cast<u32>(address - reinterpret_cast<uintptr_t>(m_pRAM));
+  }
+  else if (m_pEXRAM && address - reinterpret_cast<uintptr_t>(m_pEXRAM) < EXRAM_SIZE)
+  {
+    offset = RAM_SIZE + static_cast<u32>(address - reinterpret_cast<uintptr_t>(m_pEXRAM));
+  }
+  else
+  {
+    for (const LogicalMemoryView& view : logical_mapped_entries)
+    {
+      const uintptr_t view_offset = address - reinterpret_cast<uintptr_t>(view.mapped_pointer);
+      if (view.tracking_offset != NOT_TRACKED && view_offset < view.mapped_size)
+      {
+        offset = view.tracking_offset + static_cast<u32>(view_offset);
+        break;
+      }
+    }
+  }
+
+  return offset != NOT_TRACKED && IsTrackedOffset(offset) ? offset : NOT_TRACKED;
+}
+
+// Changes the protection of the pages in every view of them.
+static void SetWriteProtection(u32 first_page, u32 num_pages, bool protect)
+{
+  const auto set_protection = [protect](void* pointer, size_t size) {
+    if (protect)
+      Common::WriteProtectMemory(pointer, size);
+    else
+      Common::UnWriteProtectMemory(pointer, size);
+  };
+
+  const u32 begin = first_page << WRITE_TRACKING_PAGE_SHIFT;
+  const u32 end = (first_page + num_pages) << WRITE_TRACKING_PAGE_SHIFT;
+  set_protection(begin < RAM_SIZE ? m_pRAM + begin : m_pEXRAM + (begin - RAM_SIZE), end - begin);
+
+  for (const LogicalMemoryView& view : logical_mapped_entries)
+  {
+    if (view.tracking_offset == NOT_TRACKED)
+      continue;
+    const u32 view_begin = std::max(begin, view.tracking_offset);
+    const u32 view_end = std::min(end, view.tracking_offset + view.mapped_size);
+    if (view_begin < view_end)
+    {
+      set_protection(static_cast<u8*>(view.mapped_pointer) + (view_begin - view.tracking_offset),
+                     view_end - view_begin);
+    }
+  }
+}
+
+// Counts a write to every protected page, since tracking stops for them.
+static void UnprotectAllPages()
+{
+  const u32 num_pages = static_cast<u32>(s_write_tracking_pages.size());
+  u32 page = 0;
+  while (page < num_pages)
+  {
+    if (!s_write_tracking_pages[page].is_protected)
+    {
+      ++page;
+      continue;
+    }
+
+    const u32 first_page = page;
+    for (; page < num_pages && s_write_tracking_pages[page].is_protected; ++page)
+    {
+      s_write_tracking_pages[page].is_protected = false;
+      ++s_write_tracking_pages[page].write_count;
+    }
+    SetWriteProtection(first_page, page - first_page, false);
+  }
+}
+
 void Init()
 {
   bool wii = SConfig::GetInstance().bWii;
@@ -190,6 +320,8 @@ void Init()
     mem_size += region.size;
   }
   g_arena.GrabSHMSegment(mem_size);
+  s_write_tracking_pages.assign((RAM_SIZE + (wii ? EXRAM_SIZE : 0)) >> WRITE_TRACKING_PAGE_SHIFT,
+                                WriteTrackingPage());
   physical_base = Common::MemArena::FindMemoryBase();
 
   for (PhysicalMemoryRegion& region : physical_regions)
@@ -224,6 +356,10 @@ void Init()
 
 void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
 {
+  // The new views start out writable, so stop tracking everything
+  std::lock_guard<std::mutex> lk(s_write_tracking_lock);
+  UnprotectAllPages();
+
   for (auto& entry : logical_mapped_entries)
   {
     g_arena.ReleaseView(entry.mapped_pointer, entry.mapped_size);
@@ -256,7 +392,13 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
             PanicAlert("MemoryMap_Setup: Failed finding a memory base.");
             exit(0);
           }
-          logical_mapped_entries.push_back({mapped_pointer, mapped_size});
+          u32 tracking_offset = NOT_TRACKED;
+          if (physical_region.out_pointer == &m_pRAM)
+            tracking_offset = intersection_start - mapping_address;
+          else if (physical_region.out_pointer == &m_pEXRAM)
+            tracking_offset = RAM_SIZE + intersection_start - mapping_address;
+
+          logical_mapped_entries.push_back({mapped_pointer, mapped_size, tracking_offset});
         }
       }
     }
@@ -280,6 +422,11 @@ void DoState(PointerWrap& p)
 void Shutdown()
 {
   m_IsInitialized = false;
+  {
+    std::lock_guard<std::mutex> lk(s_write_tracking_lock);
+    s_write_tracking_enabled = false;
+    s_write_tracking_pages.clear();
+  }
   u32 flags = 0;
   if (SConfig::GetInstance().bWii)
     flags |= PhysicalMemoryRegion::WII_ONLY;
@@ -316,6 +463,135 @@ void Clear()
     memset(m_pEXRAM, 0, EXRAM_SIZE);
 }
 
+void EnableWriteTracking(bool enable)
+{
+#ifndef _WIN32
+  // Pages are protected one at a time, which doesn't work if the host's pages are bigger
+  if (sysconf(_SC_PAGESIZE) != WRITE_TRACKING_PAGE_SIZE)
+    enable = false;
+#endif
+
+  std::lock_guard<std::mutex> lk(s_write_tracking_lock);
+  if (!enable)
+    UnprotectAllPages();
+  s_write_tracking_enabled = enable;
+}
+
+bool GetWriteCount(u32 address, u32 size, bool track, u64* write_count)
+{
+  if (!s_write_tracking_enabled || size == 0)
+    return false;
+
+  const u32 first = GetTrackingOffset(address);
+  const u32 last = GetTrackingOffset(address + size - 1);
+  if (first == NOT_TRACKED || last == NOT_TRACKED || last - first != size - 1)
+    return false;
+  const u32 first_page = first >> WRITE_TRACKING_PAGE_SHIFT;
+  const u32 last_page = last >> WRITE_TRACKING_PAGE_SHIFT;
+
+  std::lock_guard<std::mutex> lk(s_write_tracking_lock);
+  if (!s_write_tracking_enabled)
+    return false;
+
+  u64 count = 0;
+  for (u32 page = first_page; page <= last_page; ++page)
+    count += s_write_tracking_pages[page].write_count;
+  *write_count = count;
+
+  if (track)
+  {
+    // Holding the lock keeps the handler from counting a write before the pages are protected, so
+    // every write after this point changes the count
+    u32 page = first_page;
+    while (page <= last_page)
+    {
+      const auto can_protect = [](const WriteTrackingPage& p) {
+        return !p.is_protected && p.host_writes == 0;
+      };
+      if (!can_protect(s_write_tracking_pages[page]))
+      {
+        ++page;
+        continue;
+      }
+
+      const u32 run_first_page = page;
+      for (; page <= last_page && can_protect(s_write_tracking_pages[page]); ++page)
+        s_write_tracking_pages[page].is_protected = true;
+      SetWriteProtection(run_first_page, page - run_first_page, true);
+    }
+  }
+
+  return true;
+}
+
+bool HandleWriteFault(uintptr_t fault_address)
+{
+  if (!s_write_tracking_enabled)
+    return false;
+
+  std::lock_guard<std::mutex> lk(s_write_tracking_lock);
+  const u32 offset = GetTrackingOffsetOfHostAddress(fault_address);
+  if (offset == NOT_TRACKED)
+    return false;
+
+  // If another thread has made the page writable since this fault, retrying is enough. Nothing
+  // else makes these views fault.
+  const u32 page = offset >> WRITE_TRACKING_PAGE_SHIFT;
+  if (s_write_tracking_pages[page].is_protected)
+  {
+    s_write_tracking_pages[page].is_protected = false;
+    ++s_write_tracking_pages[page].write_count;
+    SetWriteProtection(page, 1, false);
+  }
+  return true;
+}
+
+HostWriteAccess::HostWriteAccess(u32 address, u32 size)
+    : m_pointer(Memory::GetPointer(address))
+{
+  if (!s_write_tracking_enabled || size == 0)
+    return;
+
+  const u32 first = GetTrackingOffset(address);
+  const u32 last = GetTrackingOffset(address + size - 1);
+  if (first == NOT_TRACKED || last == NOT_TRACKED || last < first)
+    return;
+
+  std::lock_guard<std::mutex> lk(s_write_tracking_lock);
+  if (!s_write_tracking_enabled)
+    return;
+
+  m_first_page = first >> WRITE_TRACKING_PAGE_SHIFT;
+  m_last_page = last >> WRITE_TRACKING_PAGE_SHIFT;
+  m_tracked = true;
+  for (u32 page = m_first_page; page <= m_last_page; ++page)
+  {
+    ++s_write_tracking_pages[page].host_writes;
+    if (s_write_tracking_pages[page].is_protected)
+    {
+      s_write_tracking_pages[page].is_protected = false;
+      ++s_write_tracking_pages[page].write_count;
+      SetWriteProtection(page, 1, false);
+    }
+  }
+}
+
+HostWriteAccess::~HostWriteAccess()
+{
+  if (!m_tracked)
+    return;
+
+  // The counts are increased again, since they may have been read while the write was going on
+  std::lock_guard<std::mutex> lk(s_write_tracking_lock);
+  for (u32 page = m_first_page; page <= m_last_page && page < s_write_tracking_pages.size();
+       ++page)
+  {
+    if (s_write_tracking_pages[page].host_writes != 0)
+      --s_write_tracking_pages[page].host_writes;
+    ++s_write_tracking_pages[page].write_count;
+  }
+}
+
 static inline u8* GetPointerForRange(u32 address, size_t size)
 {
   // Make sure we don't have a range spanning 2 separate banks
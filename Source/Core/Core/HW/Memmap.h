@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -68,6 +69,41 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table);
 
 void Clear();
 
+// Write tracking for RAM and EXRAM, for finding out whether memory changed without hashing it.
+// Tracked pages are write protected in every view of them. The first write to one faults, and the
+// exception handler counts it and makes the page writable again. Only usable while an exception
+// handler which sees the faults of all threads is installed.
+void EnableWriteTracking(bool enable);
+// Gets a number which changes whenever the range is written to. With track set, it also starts
+// tracking the pages of the range which aren't tracked yet. Writes are only counted on tracked
+// pages, so only compare against numbers that were taken with track set.
+// Returns false if the range can't be tracked.
+bool GetWriteCount(u32 address, u32 size, bool track, u64* write_count);
+// Called by the exception handler. Returns true if the fault was a write to a tracked page.
+bool HandleWriteFault(uintptr_t fault_address);
+
+// Gives out a pointer to emulated memory which the OS can write to, e.g. with read(), which fails
+// instead of faulting when it hits a tracked page. The pages aren't tracked while this exists,
+// and they count as written. Every host call that writes straight into emulated memory must go
+// through one of these.
+class HostWriteAccess
+{
+public:
+  HostWriteAccess(u32 address, u32 size);
+  ~HostWriteAccess();
+  HostWriteAccess(const HostWriteAccess&) = delete;
+  HostWriteAccess& operator=(const HostWriteAccess&) = delete;
+
+  // Like GetPointer(address)
+  u8* GetPointer() const { return m_pointer; }
+
+private:
+  u8* m_pointer;
+  u32 m_first_page = 0;
+  u32 m_last_page = 0;
+  bool m_tracked = false;
+};
+
 // Routines to access physically addressed memory, designed for use by
 // emulated hardware outside the CPU. Use "Device_" prefix.
 std::string GetString(u32 em_address, size_t size = 0);
@@ -109,7 +109,8 @@ IPCCommandResult ES::ReadContent(u32 uid, const IOCtlVRequest& request)
   const u32 size = request.io_vectors[0].size;
   const u32 addr = request.io_vectors[0].address;
 
-  return GetDefaultReply(ReadContent(cfd, Memory::GetPointer(addr), size, uid));
+  const Memory::HostWriteAccess buffer(addr, size);
+  return GetDefaultReply(ReadContent(cfd, buffer.GetPointer(), size, uid));
 }
 
 ReturnCode ES::CloseContent(u32 cfd, u32 uid)
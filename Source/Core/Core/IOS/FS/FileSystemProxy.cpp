@@ -229,8 +229,9 @@ IPCCommandResult FS::Read(const ReadWriteRequest& request)
   // Simulate the FS read logic to estimate ticks. Note: this must be done before reading.
   const u64 ticks = EstimateTicksForReadWrite(handle, request);
 
-  const Result<u32> result = m_ios.GetFS()->ReadBytesFromFile(
-      handle.fs_fd, Memory::GetPointer(request.buffer), request.size);
+  const Memory::HostWriteAccess buffer(request.buffer, request.size);
+  const Result<u32> result =
+      m_ios.GetFS()->ReadBytesFromFile(handle.fs_fd, buffer.GetPointer(), request.size);
   LogResult(
       StringFromFormat("Read(%s, 0x%08x, %u)", handle.name.data(), request.buffer, request.size),
       result);
@@ -19,6 +19,7 @@
 #include "Common/FileUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/HW/Memmap.h"
 #include "Core/IOS/Device.h"
 #include "Core/IOS/IOS.h"
 
@@ -526,7 +527,8 @@ void WiiSocket::Update(bool read, bool write, bool except)
         {
           u32 flags = Memory::Read_U32(BufferIn + 0x04);
           // Not a string, Windows requires a char* for recvfrom
-          char* data = (char*)Memory::GetPointer(BufferOut);
+          const Memory::HostWriteAccess buffer(BufferOut, BufferOutSize);
+          char* data = (char*)buffer.GetPointer();
           int data_len = BufferOutSize;
 
           sockaddr_in local_name;
@@ -525,7 +525,8 @@ IPCCommandResult WFSI::IOCtl(const IOCtlRequest& request)
     }
     else
     {
-      fp.ReadBytes(Memory::GetPointer(dol_addr), max_dol_size);
+      const Memory::HostWriteAccess dol(dol_addr, max_dol_size);
+      fp.ReadBytes(dol.GetPointer(), max_dol_size);
     }
     Memory::Write_U32(real_dol_size, request.buffer_out);
     break;
@@ -573,7 +574,8 @@ u32 WFSI::GetTmd(u16 group_id, u32 title_id, u64 subtitle_id, u32 address, u32*
   }
   if (address)
   {
-    fp.ReadBytes(Memory::GetPointer(address), fp.GetSize());
+    const Memory::HostWriteAccess tmd(address, static_cast<u32>(fp.GetSize()));
+    fp.ReadBytes(tmd.GetPointer(), fp.GetSize());
   }
   *size = fp.GetSize();
   return IPC_SUCCESS;
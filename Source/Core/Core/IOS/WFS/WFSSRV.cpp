@@ -296,7 +296,8 @@ IPCCommandResult WFSSRV::IOCtl(const IOCtlRequest& request)
       fd_obj->file.Seek(position, SEEK_SET);
     }
     size_t read_bytes;
-    fd_obj->file.ReadArray(Memory::GetPointer(addr), size, &read_bytes);
+    const Memory::HostWriteAccess buffer(addr, size);
+    fd_obj->file.ReadArray(buffer.GetPointer(), size, &read_bytes);
     // TODO(wfs): Handle read errors.
     if (absolute)
     {
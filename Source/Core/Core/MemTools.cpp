@@ -14,6 +14,7 @@
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 
+#include "Core/HW/Memmap.h"
 #include "Core/MachineContext.h"
 #include "Core/PowerPC/JitInterface.h"
 
@@ -44,7 +45,7 @@ static LONG NTAPI Handler(PEXCEPTION_POINTERS pPtrs)
     uintptr_t badAddress = (uintptr_t)pPtrs->ExceptionRecord->ExceptionInformation[1];
     CONTEXT* ctx = pPtrs->ContextRecord;
 
-    if (JitInterface::HandleFault(badAddress, ctx))
+    if (Memory::HandleWriteFault(badAddress) || JitInterface::HandleFault(badAddress, ctx))
     {
       return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
     }
@@ -98,6 +99,11 @@ void UninstallExceptionHandler()
 {
 }
 
+bool IsExceptionHandlerProcessWide()
+{
+  return true;
+}
+
 #elif defined(__APPLE__) && !defined(USE_SIGACTION_ON_APPLE)
 
 static void CheckKR(const char* name, kern_return_t kr)
@@ -171,7 +177,8 @@ static void ExceptionThread(mach_port_t port)
 
     x86_thread_state64_t* state = (x86_thread_state64_t*)msg_in.old_state;
 
-    bool ok = JitInterface::HandleFault((uintptr_t)msg_in.code[1], state);
+    bool ok = Memory::HandleWriteFault((uintptr_t)msg_in.code[1]) ||
+              JitInterface::HandleFault((uintptr_t)msg_in.code[1], state);
 
     // Set up the reply.
     msg_out.Head.msgh_bits = MACH_MSGH_BITS(MACH_MSGH_BITS_REMOTE(msg_in.Head.msgh_bits), 0);
@@ -230,6 +237,12 @@ void UninstallExceptionHandler()
 {
 }
 
+bool IsExceptionHandlerProcessWide()
+{
+  // The exception port is only set for the CPU thread
+  return false;
+}
+
 #elif defined(_POSIX_VERSION) && !defined(_M_GENERIC)
 
 static struct sigaction old_sa_segv;
@@ -257,6 +270,9 @@ static void sigsegv_handler(int sig, siginfo_t* info, void* raw_context)
 #else
   mcontext_t* ctx = &context->uc_mcontext;
 #endif
+  if (Memory::HandleWriteFault(bad_address))
+    return;
+
   // assume it's not a write
   if (!JitInterface::HandleFault(bad_address,
 #ifdef __APPLE__
@@ -338,6 +354,11 @@ void UninstallExceptionHandler()
   sigaction(SIGBUS, &old_sa_bus, nullptr);
 #endif
 }
+
+bool IsExceptionHandlerProcessWide()
+{
+  return true;
+}
 #else  // _M_GENERIC or unsupported platform
 
 void InstallExceptionHandler()
@@ -346,6 +367,10 @@ void InstallExceptionHandler()
 void UninstallExceptionHandler()
 {
 }
+bool IsExceptionHandlerProcessWide()
+{
+  return false;
+}
 
 #endif
 
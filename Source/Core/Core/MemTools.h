@@ -8,4 +8,6 @@ namespace EMM
 {
 void InstallExceptionHandler();
 void UninstallExceptionHandler();
+// Whether the handler also sees faults on threads other than the one which installed it
+bool IsExceptionHandlerProcessWide();
 }
@@ -222,6 +222,18 @@ int Interpreter::SingleStepInner()
   return PPCTables::GetOpInfo(m_prev_inst)->numCycles;
 }
 
+int Interpreter::RunBlock()
+{
+  m_end_block = false;
+
+  int cycles = 0;
+  while (!m_end_block)
+  {
+    cycles += SingleStepInner();
+  }
+  return cycles;
+}
+
 void Interpreter::SingleStep()
 {
   // Declare start of new slice
@@ -321,14 +333,7 @@ void Interpreter::Run()
       // "fast" version of inner loop. well, it's not so fast.
       while (PowerPC::ppcState.downcount > 0)
       {
-        m_end_block = false;
-
-        int cycles = 0;
-        while (!m_end_block)
-        {
-          cycles += SingleStepInner();
-        }
-        PowerPC::ppcState.downcount -= cycles;
+        PowerPC::ppcState.downcount -= RunBlock();
       }
     }
   }
@@ -17,6 +17,8 @@ public:
   void Shutdown() override;
   void SingleStep() override;
   int SingleStepInner();
+  // Runs instructions until the end of the current block. Returns the number of cycles taken.
+  int RunBlock();
 
   void Run() override;
   void ClearCache() override;
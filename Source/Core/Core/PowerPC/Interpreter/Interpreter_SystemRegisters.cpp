@@ -12,6 +12,7 @@
 #include "Core/HW/SystemTimers.h"
 #include "Core/PowerPC/Interpreter/ExceptionUtils.h"
 #include "Core/PowerPC/Interpreter/Interpreter_FPUtils.h"
+#include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/MMU.h"
 #include "Core/PowerPC/PowerPC.h"
 
@@ -372,6 +373,8 @@ void Interpreter::mtspr(UGeckoInstruction inst)
   case SPR_GQR0 + 5:
   case SPR_GQR0 + 6:
   case SPR_GQR0 + 7:
+    if (old_value != rSPR(index))
+      JitInterface::GQRUpdated(index - SPR_GQR0);
     break;
 
   case SPR_DMAL:
@@ -4,6 +4,7 @@
 
 #include "Core/PowerPC/Jit64/Jit.h"
 
+#include <algorithm>
 #include <disasm.h>
 #include <map>
 #include <sstream>
@@ -23,6 +24,7 @@
 #include "Common/StringUtil.h"
 #include "Common/Swap.h"
 #include "Common/x64ABI.h"
+#include "Core/Config/MainSettings.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/HLE/HLE.h"
@@ -32,6 +34,7 @@
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/MachineContext.h"
 #include "Core/PatchEngine.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/RegCache/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/FarCodeCache.h"
@@ -356,6 +359,20 @@ void Jit64::Init()
                               !SConfig::GetInstance().bEnableDebugging;
   m_cleanup_after_stackfault = false;
 
+  m_tier_up_threshold = SConfig::GetInstance().bEnableDebugging ?
+                            0 :
+                            std::max(Config::Get(Config::MAIN_JIT_TIER_UP_THRESHOLD), 0);
+  m_interpreted_block_counts.clear();
+
+  m_enable_trace_formation = Config::Get(Config::MAIN_JIT_TRACE_FORMATION) &&
+                             !SConfig::GetInstance().bEnableDebugging &&
+                             !SConfig::GetInstance().bJITBranchOff;
+  m_branch_counters.clear();
+  analyzer.SetHotBranches(&js.hotBranchAddresses);
+
+  m_enable_register_residency = Config::Get(Config::MAIN_JIT_REGISTER_RESIDENCY) &&
+                                !SConfig::GetInstance().bEnableDebugging;
+
   m_stack = nullptr;
   if (m_enable_blr_optimization)
     AllocStack();
@@ -384,6 +401,8 @@ void Jit64::ClearCache()
   ClearCodeSpace();
   Clear();
   UpdateMemoryOptions();
+  m_interpreted_block_counts.clear();
+  m_branch_counters.clear();
 }
 
 void Jit64::Shutdown()
@@ -544,10 +563,17 @@ void Jit64::WriteExit(u32 destination, bool bl, u32 after)
 
   SUB(32, PPCSTATE(downcount), Imm32(js.downcountAmount));
 
-  JustWriteExit(destination, bl, after);
+  // The guest registers have just been flushed, but the ones in callee saved host registers are
+  // still there (Cleanup only calls functions), so the next block may not need to load them.
+  JitBlock::RegisterResidency residency{};
+  if (m_enable_register_residency)
+    residency = gpr.GetFlushedResidency(ABI_ALL_CALLEE_SAVED & ABI_ALL_GPRS);
+
+  JustWriteExit(destination, bl, after, residency);
 }
 
-void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
+void Jit64::JustWriteExit(u32 destination, bool bl, u32 after,
+                          const JitBlock::RegisterResidency& residency)
 {
   // If nobody has taken care of this yet (this can be removed when all branches are done)
   JitBlock* b = js.curBlock;
@@ -555,6 +581,7 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
   linkData.exitAddress = destination;
   linkData.linkStatus = false;
   linkData.call = bl;
+  linkData.residency = residency;
 
   MOV(32, PPCSTATE(pc), Imm32(destination));
 
@@ -655,6 +682,40 @@ void Jit64::WriteIdleExit(u32 destination)
   WriteExceptionExit();
 }
 
+void Jit64::WriteBranchProfile(const PPCAnalyst::CodeOp& op, bool taken)
+{
+  // Only conditional bcx can be followed by the analyzer, see PPCAnalyzer::Analyze.
+  if (!m_enable_trace_formation || op.inst.OPCD != 16 || op.inst.LK || op.branchIsIdleLoop ||
+      op.branchTo == js.blockStart)
+  {
+    return;
+  }
+
+  // Count how many times in a row the branch has been taken. Once that reaches the threshold,
+  // report it so that the blocks containing it get recompiled with the taken path inlined.
+  // On the taken path, all guest registers must already have been flushed.
+  u32* counter = &m_branch_counters.try_emplace(op.address, HOT_BRANCH_THRESHOLD).first->second;
+  MOV(64, R(RSCRATCH), ImmPtr(counter));
+  if (!taken)
+  {
+    MOV(32, MatR(RSCRATCH), Imm32(HOT_BRANCH_THRESHOLD));
+    return;
+  }
+
+  SUB(32, MatR(RSCRATCH), Imm8(1));
+  FixupBranch hot = J_CC(CC_Z, true);
+  SwitchToFarCode();
+  SetJumpTarget(hot);
+  MOV(32, PPCSTATE(pc), Imm32(op.address));
+  ABI_PushRegistersAndAdjustStack({}, 0);
+  ABI_CallFunctionC(JitInterface::CompileExceptionCheck,
+                    static_cast<u32>(JitInterface::ExceptionType::HotBranch));
+  ABI_PopRegistersAndAdjustStack({}, 0);
+  FixupBranch done = J(true);
+  SwitchToNearCode();
+  SetJumpTarget(done);
+}
+
 void Jit64::WriteExceptionExit()
 {
   Cleanup();
@@ -727,6 +788,13 @@ void Jit64::Jit(u32 em_address)
 #endif
   }
 
+  if (m_tier_up_threshold != 0 && ShouldInterpretBlock(em_address))
+  {
+    // Run the block in the interpreter. The dispatcher checks the downcount when we return.
+    PowerPC::ppcState.downcount -= Interpreter::getInstance()->RunBlock();
+    return;
+  }
+
   if (IsAlmostFull() || m_far_code.IsAlmostFull() || trampolines.IsAlmostFull() ||
       SConfig::GetInstance().bJITNoBlockCache)
   {
@@ -784,6 +852,60 @@ void Jit64::Jit(u32 em_address)
   JitBlock* b = blocks.AllocateBlock(em_address);
   DoJit(em_address, b, nextPC);
   blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+
+  if (blocks.IsPersistentCacheEnabled() && !CPU::IsStepping())
+  {
+    blocks.AddPersistentBlock(*b, HashAnalyzedCode());
+    CompilePersistentBlocks(b->physicalAddress);
+  }
+}
+
+bool Jit64::ShouldInterpretBlock(u32 em_address)
+{
+  // Most code which is loaded at runtime (e.g. overlays) only runs a handful of times, so
+  // compiling it on the first miss stalls the CPU thread for no gain. Interpret blocks until
+  // they have missed in the dispatcher often enough to be worth compiling.
+  u32& count = m_interpreted_block_counts[em_address];
+  if (count < static_cast<u32>(m_tier_up_threshold))
+  {
+    count++;
+    return true;
+  }
+
+  m_interpreted_block_counts.erase(em_address);
+  return false;
+}
+
+void Jit64::CompilePersistentBlocks(u32 physical_address)
+{
+  // Now that code in this page is running, compile the blocks which previous runs of the game
+  // executed in the same page, so that they don't each have to miss in the dispatcher first.
+  const u32 msr_bits = MSR.Hex & JitBaseBlockCache::JIT_CACHE_MSR_MASK;
+  for (const auto& record : blocks.TakePersistentBlocks(physical_address, msr_bits))
+  {
+    // Leave the remaining space to blocks which are actually being executed.
+    if (IsAlmostFull() || m_far_code.IsAlmostFull() || trampolines.IsAlmostFull())
+      return;
+
+    if (blocks.GetBlockFromStartAddress(record.effective_address, MSR.Hex))
+      continue;
+
+    const auto translated = PowerPC::JitCache_TranslateAddress(record.effective_address);
+    if (!translated.valid || translated.address != record.physical_address)
+      continue;
+
+    const u32 next_pc = analyzer.Analyze(record.effective_address, &code_block, &m_code_buffer,
+                                         m_code_buffer.size());
+    if (code_block.m_memory_exception || HashAnalyzedCode() != record.code_hash)
+      continue;
+
+    // The register state doesn't belong to this block, so it can't be used to guess constants.
+    m_compiling_persistent_block = true;
+    JitBlock* b = blocks.AllocateBlock(record.effective_address);
+    DoJit(record.effective_address, b, next_pc);
+    blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+    m_compiling_persistent_block = false;
+  }
 }
 
 u8* Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
@@ -830,6 +952,35 @@ u8* Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
   gpr.Start();
   fpr.Start();
 
+  // Load the first inputs of the block into callee saved registers, and give the block a second
+  // entry point after the loads. Exits which still have the same registers loaded get linked to
+  // it, see JitBlockCache::WriteLinkBlock.
+  b->residentEntry = nullptr;
+  b->entryResidency = {};
+  if (m_enable_register_residency && !jo.profile_blocks && !ImHereDebug)
+  {
+    BitSet32 inputs;
+    BitSet32 written;
+    for (u32 i = 0; i < code_block.m_num_instructions; i++)
+    {
+      const PPCAnalyst::CodeOp& op = m_code_buffer[i];
+      for (int reg : op.regsIn & ~written)
+      {
+        if (inputs.Count() < MAX_RESIDENT_GPRS)
+          inputs[reg] = true;
+      }
+      written |= op.regsOut;
+    }
+
+    b->entryResidency =
+        gpr.PreloadResidentRegisters(inputs, ABI_ALL_CALLEE_SAVED & ABI_ALL_GPRS);
+    if (std::any_of(b->entryResidency.begin(), b->entryResidency.end(),
+                    [](u8 preg) { return preg != 0; }))
+    {
+      b->residentEntry = GetWritableCodePtr();
+    }
+  }
+
   js.downcountAmount = 0;
   js.skipInstructions = 0;
   js.carryFlagSet = false;
@@ -842,34 +993,19 @@ u8* Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
   // fastmem).
   if (js.pairedQuantizeAddresses.find(js.blockStart) == js.pairedQuantizeAddresses.end())
   {
-    // If there are GQRs used but not set, we'll treat those as constant and optimize them
+    // If there are GQRs used but not set, we'll treat those as constant and optimize them.
+    // Rather than checking them on every block entry, writes to the GQRs invalidate the block
+    // in case our guess turns out wrong (see JitInterface::GQRUpdated).
     BitSet8 gqr_static = ComputeStaticGQRs(code_block);
-    if (gqr_static)
+    for (int gqr : gqr_static)
     {
-      SwitchToFarCode();
-      const u8* target = GetCodePtr();
-      MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
-      ABI_PushRegistersAndAdjustStack({}, 0);
-      ABI_CallFunctionC(JitInterface::CompileExceptionCheck,
-                        static_cast<u32>(JitInterface::ExceptionType::PairedQuantize));
-      ABI_PopRegistersAndAdjustStack({}, 0);
-      JMP(asm_routines.dispatcher_no_check, true);
-      SwitchToNearCode();
-
-      // Insert a check that the GQRs are still the value we expect at
-      // the start of the block in case our guess turns out wrong.
-      for (int gqr : gqr_static)
-      {
-        u32 value = GQR(gqr);
-        js.constantGqr[gqr] = value;
-        CMP_or_TEST(32, PPCSTATE(spr[SPR_GQR0 + gqr]), Imm32(value));
-        J_CC(CC_NZ, target);
-      }
+      js.constantGqr[gqr] = GQR(gqr);
+      js.constantGqrBlocks[gqr].emplace(b->physicalAddress, js.blockStart);
     }
   }
 
-  if (js.noSpeculativeConstantsAddresses.find(js.blockStart) ==
-      js.noSpeculativeConstantsAddresses.end())
+  if (!m_compiling_persistent_block && js.noSpeculativeConstantsAddresses.find(js.blockStart) ==
+                                           js.noSpeculativeConstantsAddresses.end())
   {
     IntializeSpeculativeConstants();
   }
@@ -1114,6 +1250,8 @@ void Jit64::EnableOptimization()
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+  if (m_enable_trace_formation)
+    analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_HOT_BRANCH_FOLLOW);
 }
 
 void Jit64::IntializeSpeculativeConstants()
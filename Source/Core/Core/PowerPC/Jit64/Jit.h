@@ -18,6 +18,8 @@
 // ----------
 #pragma once
 
+#include <unordered_map>
+
 #include "Common/CommonTypes.h"
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
@@ -78,13 +80,15 @@ public:
 
   void FakeBLCall(u32 after);
   void WriteExit(u32 destination, bool bl = false, u32 after = 0);
-  void JustWriteExit(u32 destination, bool bl, u32 after);
+  void JustWriteExit(u32 destination, bool bl, u32 after,
+                     const JitBlock::RegisterResidency& residency = {});
   void WriteExitDestInRSCRATCH(bool bl = false, u32 after = 0);
   void WriteBLRExit();
   void WriteExceptionExit();
   void WriteExternalExceptionExit();
   void WriteRfiExitDestInRSCRATCH();
   void WriteIdleExit(u32 destination);
+  void WriteBranchProfile(const PPCAnalyst::CodeOp& op, bool taken);
   bool Cleanup();
 
   void GenerateConstantOverflow(bool overflow);
@@ -125,6 +129,9 @@ public:
   void FloatCompare(UGeckoInstruction inst, bool upper = false);
   void UpdateMXCSR();
 
+  bool IsConstantFloatPairedLoad(UGeckoInstruction inst, int a, s32 offset) const;
+  void psq_lFused(int a, s32 offset, int s1, int s2);
+
   // OPCODES
   using Instruction = void (Jit64::*)(UGeckoInstruction instCode);
   void FallBackToInterpreter(UGeckoInstruction _inst);
@@ -241,6 +248,9 @@ private:
 
   bool HandleFunctionHooking(u32 address);
 
+  bool ShouldInterpretBlock(u32 em_address);
+  void CompilePersistentBlocks(u32 physical_address);
+
   void AllocStack();
   void FreeStack();
 
@@ -254,6 +264,23 @@ private:
 
   bool m_enable_blr_optimization;
   bool m_cleanup_after_stackfault;
+  bool m_compiling_persistent_block = false;
+
+  // Number of dispatcher misses after which an interpreted block gets compiled, or 0 to always
+  // compile on the first miss.
+  int m_tier_up_threshold = 0;
+  std::unordered_map<u32, u32> m_interpreted_block_counts;
+
+  // Number of consecutive times a conditional branch has to be taken before the blocks containing
+  // it get recompiled as traces through it (see PPCAnalyzer::OPTION_HOT_BRANCH_FOLLOW).
+  static constexpr u32 HOT_BRANCH_THRESHOLD = 64;
+  bool m_enable_trace_formation = false;
+  // Remaining taken count per branch address, updated by the generated code.
+  std::unordered_map<u32, u32> m_branch_counters;
+
+  // Number of input registers a block loads up front, so that linked blocks can skip the loads.
+  static constexpr u32 MAX_RESIDENT_GPRS = 4;
+  bool m_enable_register_residency = false;
   u8* m_stack;
 };
 
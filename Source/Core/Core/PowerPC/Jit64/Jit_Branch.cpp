@@ -147,6 +147,26 @@ void Jit64::bcx(UGeckoInstruction inst)
     return;
   }
 
+  if (js.op->branchIsFollowed)
+  {
+    // The analyzer continued the block at the branch target, so only the fall-through path needs
+    // an exit. It's the unlikely one, so keep it out of line.
+    SwitchToFarCode();
+    if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
+      SetJumpTarget(pConditionDontBranch);
+    if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
+      SetJumpTarget(pCTRDontBranch);
+    {
+      RCForkGuard gpr_guard = gpr.Fork();
+      RCForkGuard fpr_guard = fpr.Fork();
+      gpr.Flush();
+      fpr.Flush();
+      WriteExit(js.compilerPC + 4);
+    }
+    SwitchToNearCode();
+    return;
+  }
+
   {
     RCForkGuard gpr_guard = gpr.Fork();
     RCForkGuard fpr_guard = fpr.Fork();
@@ -159,6 +179,7 @@ void Jit64::bcx(UGeckoInstruction inst)
     }
     else
     {
+      WriteBranchProfile(*js.op, true);
       WriteExit(js.op->branchTo, inst.LK, js.compilerPC + 4);
     }
   }
@@ -167,6 +188,7 @@ void Jit64::bcx(UGeckoInstruction inst)
     SetJumpTarget(pConditionDontBranch);
   if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
     SetJumpTarget(pCTRDontBranch);
+  WriteBranchProfile(*js.op, false);
 
   if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
   {
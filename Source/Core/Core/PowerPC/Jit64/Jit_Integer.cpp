@@ -426,6 +426,22 @@ void Jit64::DoMergedBranchCondition()
   else  // SO bit, do not branch (we don't emulate SO for cmp).
     pDontBranch = J(true);
 
+  if (js.op[1].branchIsFollowed)
+  {
+    // The block continues at the branch target, see Jit64::bcx.
+    SwitchToFarCode();
+    SetJumpTarget(pDontBranch);
+    {
+      RCForkGuard gpr_guard = gpr.Fork();
+      RCForkGuard fpr_guard = fpr.Fork();
+      gpr.Flush();
+      fpr.Flush();
+      WriteExit(nextPC + 4);
+    }
+    SwitchToNearCode();
+    return;
+  }
+
   {
     RCForkGuard gpr_guard = gpr.Fork();
     RCForkGuard fpr_guard = fpr.Fork();
@@ -433,10 +449,12 @@ void Jit64::DoMergedBranchCondition()
     gpr.Flush();
     fpr.Flush();
 
+    WriteBranchProfile(js.op[1], true);
     DoMergedBranch();
   }
 
   SetJumpTarget(pDontBranch);
+  WriteBranchProfile(js.op[1], false);
 
   if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
   {
@@ -467,6 +485,18 @@ void Jit64::DoMergedBranchImmediate(s64 val)
   else  // SO bit, do not branch (we don't emulate SO for cmp).
     branch = false;
 
+  if (js.op[1].branchIsFollowed)
+  {
+    // The block continues at the branch target, see Jit64::bcx.
+    if (!branch)
+    {
+      gpr.Flush();
+      fpr.Flush();
+      WriteExit(nextPC + 4);
+    }
+    return;
+  }
+
   if (branch)
   {
     gpr.Flush();
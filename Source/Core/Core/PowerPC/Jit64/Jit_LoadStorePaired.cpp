@@ -7,6 +7,7 @@
 
 #include "Core/PowerPC/Jit64/Jit.h"
 
+#include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
 #include "Common/x64Emitter.h"
 #include "Core/PowerPC/Jit64/RegCache/JitRegCache.h"
@@ -59,30 +60,10 @@ void Jit64::psq_stXX(UGeckoInstruction inst)
 
   if (gqrIsConstant)
   {
-    int type = gqrValue & 0x7;
-
-    // Paired stores (other than w/type zero) don't yield any real change in
-    // performance right now, but if we can improve fastmem support this might change
-    if (gqrValue == 0)
-    {
-      if (w)
-        GenQuantizedStore(true, static_cast<EQuantizeType>(type), (gqrValue & 0x3F00) >> 8);
-      else
-        GenQuantizedStore(false, static_cast<EQuantizeType>(type), (gqrValue & 0x3F00) >> 8);
-    }
-    else
-    {
-      // Stash PC in case asm_routine causes exception
-      MOV(32, PPCSTATE(pc), Imm32(js.compilerPC));
-      // We know what GQR is here, so we can load RSCRATCH2 and call into the store method directly
-      // with just the scale bits.
-      MOV(32, R(RSCRATCH2), Imm32(gqrValue & 0x3F00));
-
-      if (w)
-        CALL(asm_routines.single_store_quantized[type]);
-      else
-        CALL(asm_routines.paired_store_quantized[type]);
-    }
+    // Inlining the quantization also lets the store itself use fastmem, which the shared
+    // routines can't.
+    GenQuantizedStore(w == 1, static_cast<EQuantizeType>(gqrValue & 0x7),
+                      (gqrValue & 0x3F00) >> 8);
   }
   else
   {
@@ -131,6 +112,14 @@ void Jit64::psq_lXX(UGeckoInstruction inst)
   bool gqrIsConstant = it != js.constantGqr.end();
   u32 gqrValue = gqrIsConstant ? it->second >> 16 : 0;
 
+  if (gqrIsConstant && !update && !indexed && !w && (gqrValue & 0x7) == QUANTIZE_FLOAT &&
+      IsConstantFloatPairedLoad(js.op[1].inst, a, offset + 8) && js.op[1].inst.FS != s &&
+      !jo.memcheck && cpu_info.bSSSE3 && CanMergeNextInstructions(1))
+  {
+    psq_lFused(a, offset, s, js.op[1].inst.FS);
+    return;
+  }
+
   RCX64Reg scratch_guard = gpr.Scratch(RSCRATCH_EXTRA);
   RCX64Reg Ra = gpr.Bind(a, update ? RCMode::ReadWrite : RCMode::Read);
   RCOpArg Rb = indexed ? gpr.Use(b, RCMode::Read) : RCOpArg::Imm32((u32)offset);
@@ -171,3 +160,35 @@ void Jit64::psq_lXX(UGeckoInstruction inst)
     ADD(32, Ra, Rb);
   }
 }
+
+bool Jit64::IsConstantFloatPairedLoad(UGeckoInstruction inst, int a, s32 offset) const
+{
+  if (inst.OPCD != 56 || inst.W || inst.RA != a || inst.SIMM_12 != offset)
+    return false;
+
+  auto it = js.constantGqr.find(inst.I);
+  return it != js.constantGqr.end() && ((it->second >> 16) & 0x7) == QUANTIZE_FLOAT;
+}
+
+// Merges two psq_l of unquantized pairs from consecutive addresses, like a four-element vector
+// being loaded into two registers, into a single 16-byte load.
+void Jit64::psq_lFused(int a, s32 offset, int s1, int s2)
+{
+  js.skipInstructions = 1;
+  js.downcountAmount++;
+
+  RCX64Reg scratch_guard = gpr.Scratch(RSCRATCH_EXTRA);
+  RCOpArg Ra = gpr.Use(a, RCMode::Read);
+  RCX64Reg Rs1 = fpr.Bind(s1, RCMode::Write);
+  RCX64Reg Rs2 = fpr.Bind(s2, RCMode::Write);
+  RegCache::Realize(scratch_guard, Ra, Rs1, Rs2);
+
+  // Like the unfused loads (see GenQuantizedLoadFloat), this assumes that the address is RAM.
+  MOV_sum(32, RSCRATCH_EXTRA, Ra, Imm32(static_cast<u32>(offset)));
+  MOVUPS(XMM0, MRegSum(RMEM, RSCRATCH_EXTRA));
+  PSHUFB(XMM0, MConst(pbswapShuffle4x4));
+
+  CVTPS2PD(Rs1, R(XMM0));
+  MOVHLPS(XMM0, XMM0);
+  CVTPS2PD(Rs2, R(XMM0));
+}
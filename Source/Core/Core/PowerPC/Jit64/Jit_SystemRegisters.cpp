@@ -11,6 +11,7 @@
 #include "Core/PowerPC/Jit64/Jit.h"
 #include "Core/PowerPC/Jit64/RegCache/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/Jit64PowerPCState.h"
+#include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
 
 using namespace Gen;
@@ -211,6 +212,8 @@ void Jit64::mtspr(UGeckoInstruction inst)
 
   case SPR_LR:
   case SPR_CTR:
+    // These are safe to do the easy way, see the bottom of this function.
+    break;
 
   case SPR_GQR0:
   case SPR_GQR0 + 1:
@@ -220,8 +223,22 @@ void Jit64::mtspr(UGeckoInstruction inst)
   case SPR_GQR0 + 5:
   case SPR_GQR0 + 6:
   case SPR_GQR0 + 7:
-    // These are safe to do the easy way, see the bottom of this function.
-    break;
+  {
+    // Blocks compiled for the old value of the GQR have to be thrown away. Games commonly write
+    // the same value over and over again, so only do that if the value actually changes.
+    RCOpArg Rd = gpr.BindOrImm(d, RCMode::Read);
+    RegCache::Realize(Rd);
+
+    CMP(32, PPCSTATE(spr[iIndex]), Rd);
+    FixupBranch unchanged = J_CC(CC_E);
+    MOV(32, PPCSTATE(spr[iIndex]), Rd);
+    BitSet32 regs = CallerSavedRegistersInUse();
+    ABI_PushRegistersAndAdjustStack(regs, 0);
+    ABI_CallFunctionC(JitInterface::GQRUpdated, iIndex - SPR_GQR0);
+    ABI_PopRegistersAndAdjustStack(regs, 0);
+    SetJumpTarget(unchanged);
+    return;
+  }
 
   case SPR_XER:
   {
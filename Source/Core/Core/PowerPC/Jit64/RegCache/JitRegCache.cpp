@@ -286,6 +286,7 @@ void RCForkGuard::EndFork()
   ASSERT(!rc->IsAnyConstraintActive());
   rc->m_regs = m_regs;
   rc->m_xregs = m_xregs;
+  rc->m_flushed_residency = {};
   rc = nullptr;
 }
 
@@ -295,6 +296,7 @@ RegCache::RegCache(Jit64& jit) : m_jit{jit}
 
 void RegCache::Start()
 {
+  m_flushed_residency = {};
   m_xregs.fill({});
   for (size_t i = 0; i < m_regs.size(); i++)
   {
@@ -387,6 +389,18 @@ void RegCache::Flush(BitSet32 pregs)
       std::none_of(m_xregs.begin(), m_xregs.end(), [](const auto& x) { return x.IsLocked(); }),
       "Someone forgot to unlock a X64 reg");
 
+  // Remember what the host registers still contain after a full flush, so that a block exit can
+  // pass them on to the next block.
+  m_flushed_residency = {};
+  if (pregs == BitSet32::AllTrue(32))
+  {
+    for (preg_t i = 0; i < m_regs.size(); i++)
+    {
+      if (m_regs[i].IsBound())
+        m_flushed_residency[RX(i)] = static_cast<u8>(i + 1);
+    }
+  }
+
   for (preg_t i : pregs)
   {
     ASSERT_MSG(DYNA_REC, !m_regs[i].IsLocked(),
@@ -414,6 +428,7 @@ void RegCache::Flush(BitSet32 pregs)
 void RegCache::Revert()
 {
   ASSERT(IsAllUnlocked());
+  m_flushed_residency = {};
   for (auto& reg : m_regs)
   {
     if (reg.IsRevertable())
@@ -449,6 +464,39 @@ void RegCache::PreloadRegisters(BitSet32 to_preload)
   }
 }
 
+JitBlock::RegisterResidency RegCache::PreloadResidentRegisters(BitSet32 pregs, BitSet32 xregs)
+{
+  JitBlock::RegisterResidency residency{};
+  for (preg_t preg : pregs)
+  {
+    if (m_regs[preg].IsAway() || NumFreeRegisters() < 2)
+      break;
+
+    size_t count;
+    const X64Reg* order = GetAllocationOrder(&count);
+    const X64Reg* xr = std::find_if(order, order + count, [this](X64Reg x) {
+      return m_xregs[x].IsFree();
+    });
+    if (xr == order + count || !xregs[*xr])
+      break;
+
+    BindToRegister(preg, true, false);
+    residency[*xr] = static_cast<u8>(preg + 1);
+  }
+  return residency;
+}
+
+JitBlock::RegisterResidency RegCache::GetFlushedResidency(BitSet32 xregs) const
+{
+  JitBlock::RegisterResidency residency{};
+  for (size_t xr = 0; xr < residency.size(); xr++)
+  {
+    if (xregs[xr])
+      residency[xr] = m_flushed_residency[xr];
+  }
+  return residency;
+}
+
 BitSet32 RegCache::RegistersInUse() const
 {
   BitSet32 result;
@@ -472,6 +520,7 @@ void RegCache::FlushX(X64Reg reg)
 
 void RegCache::DiscardRegContentsIfCached(preg_t preg)
 {
+  m_flushed_residency = {};
   if (m_regs[preg].IsBound())
   {
     X64Reg xr = m_regs[preg].Location().GetSimpleReg();
@@ -482,6 +531,7 @@ void RegCache::DiscardRegContentsIfCached(preg_t preg)
 
 void RegCache::BindToRegister(preg_t i, bool doLoad, bool makeDirty)
 {
+  m_flushed_residency = {};
   if (!m_regs[i].IsBound())
   {
     X64Reg xr = GetFreeXReg();
@@ -661,6 +711,7 @@ void RegCache::Unlock(preg_t preg)
 
 void RegCache::LockX(X64Reg xr)
 {
+  m_flushed_residency = {};
   m_xregs[xr].Lock();
 }
 
@@ -676,6 +727,7 @@ bool RegCache::IsRealized(preg_t preg) const
 
 void RegCache::Realize(preg_t preg)
 {
+  m_flushed_residency = {};
   if (m_constraints[preg].IsRealized())
     return;
 
@@ -12,6 +12,7 @@
 
 #include "Common/x64Emitter.h"
 #include "Core/PowerPC/Jit64/RegCache/CachedReg.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 
 class Jit64;
@@ -178,6 +179,13 @@ public:
   void PreloadRegisters(BitSet32 pregs);
   BitSet32 RegistersInUse() const;
 
+  // Binds the given guest registers to free host registers in xregs, in allocation order, for as
+  // long as there are any, and returns where they ended up.
+  JitBlock::RegisterResidency PreloadResidentRegisters(BitSet32 pregs, BitSet32 xregs);
+  // Returns the guest registers which were bound to host registers in xregs at the last full
+  // Flush(), provided that the register cache hasn't been used since.
+  JitBlock::RegisterResidency GetFlushedResidency(BitSet32 xregs) const;
+
 protected:
   friend class RCOpArg;
   friend class RCX64Reg;
@@ -218,5 +226,6 @@ protected:
   std::array<PPCCachedReg, 32> m_regs;
   std::array<X64CachedReg, NUM_XREGS> m_xregs;
   std::array<RCConstraint, 32> m_constraints;
+  JitBlock::RegisterResidency m_flushed_residency{};
   Gen::XEmitter* m_emitter = nullptr;
 };
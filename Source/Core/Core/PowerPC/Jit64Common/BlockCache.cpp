@@ -4,6 +4,8 @@
 
 #include "Core/PowerPC/Jit64Common/BlockCache.h"
 
+#include <algorithm>
+
 #include "Common/CommonTypes.h"
 #include "Common/x64Emitter.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
@@ -21,6 +23,16 @@ void JitBlockCache::WriteLinkBlock(const JitBlock::LinkData& source, const JitBl
 
   u8* location = source.exitPtrs;
   const u8* address = dest ? dest->checkedEntry : dispatcher;
+
+  // Skip the loads at the start of the destination block if the exit leaves all of the registers
+  // it wants where it wants them.
+  if (dest && dest->residentEntry &&
+      std::equal(dest->entryResidency.begin(), dest->entryResidency.end(),
+                 source.residency.begin(),
+                 [](u8 wanted, u8 available) { return wanted == 0 || wanted == available; }))
+  {
+    address = dest->residentEntry;
+  }
   Gen::XEmitter emit(location);
   if (source.call)
   {
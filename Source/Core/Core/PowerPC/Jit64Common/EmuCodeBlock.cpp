@@ -118,6 +118,78 @@ FixupBranch EmuCodeBlock::CheckIfSafeAddress(const OpArg& reg_value, X64Reg reg_
   return J_CC(CC_Z, m_far_code.Enabled());
 }
 
+FixupBranch EmuCodeBlock::CheckSoftwareTLB(X64Reg reg_addr, int access_size, bool write,
+                                           BitSet32 excluded, BitSet32 registers_in_use,
+                                           const std::function<void(const OpArg&)>& access)
+{
+  excluded[reg_addr] = true;
+
+  // Get ourselves a free register, preferably one which doesn't need to be saved
+  X64Reg scratch = INVALID_REG;
+  bool spill = false;
+  for (X64Reg reg : {RSCRATCH, RSCRATCH2, RSCRATCH_EXTRA})
+  {
+    if (excluded[reg])
+      continue;
+    if (!registers_in_use[reg])
+    {
+      scratch = reg;
+      spill = false;
+      break;
+    }
+    if (scratch == INVALID_REG)
+    {
+      scratch = reg;
+      spill = true;
+    }
+  }
+
+  if (spill)
+    PUSH(scratch);
+
+  // Accesses which cross into the next page would need a second lookup.
+  const int access_bytes = access_size / 8;
+  FixupBranch crosses_page;
+  if (access_bytes > 1)
+  {
+    LEA(32, scratch, MDisp(reg_addr, access_bytes - 1));
+    XOR(32, R(scratch), R(reg_addr));
+    TEST(32, R(scratch), Imm32(0xFFFFF000));
+    crosses_page = J_CC(CC_NZ);
+  }
+
+  MOV(32, R(scratch), R(reg_addr));
+  SHR(32, R(scratch), Imm8(12));
+  MOV(64, R(scratch), MComplex(RPPCSTATE, scratch, SCALE_8, PPCSTATE_OFF(software_tlb)));
+
+  // Missing entries are 0, which has neither the writable bit set nor anything else.
+  FixupBranch miss;
+  if (write)
+  {
+    BTR(64, R(scratch), Imm8(0));
+    miss = J_CC(CC_NC);
+  }
+  else
+  {
+    AND(64, R(scratch), Imm32(static_cast<u32>(~PowerPC::SOFTWARE_TLB_WRITABLE)));
+    miss = J_CC(CC_Z);
+  }
+
+  access(MRegSum(scratch, reg_addr));
+
+  if (spill)
+    POP(scratch);
+  FixupBranch hit = J(true);
+
+  if (access_bytes > 1)
+    SetJumpTarget(crosses_page);
+  SetJumpTarget(miss);
+  if (spill)
+    POP(scratch);
+
+  return hit;
+}
+
 void EmuCodeBlock::UnsafeLoadRegToReg(X64Reg reg_addr, X64Reg reg_value, int accessSize, s32 offset,
                                       bool signExtend)
 {
@@ -383,6 +455,20 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress,
     SetJumpTarget(slow);
   }
 
+  // Page table mappings can't use the fast path above (and fault when using fastmem), but a hit
+  // in the software TLB still lets us avoid calling into the MMU code.
+  const bool check_software_tlb = m_jit.jo.softwareTLB && dr_set;
+  FixupBranch software_tlb_hit;
+  if (check_software_tlb)
+  {
+    BitSet32 excluded;
+    excluded[reg_value] = true;
+
+    software_tlb_hit = CheckSoftwareTLB(
+        reg_addr, accessSize, false, excluded, registersInUse,
+        [&](const OpArg& src) { LoadAndSwap(accessSize, reg_value, src, signExtend); });
+  }
+
   // Helps external systems know which instruction triggered the read.
   // Invalid for calls from Jit64AsmCommon routines
   if (!(flags & SAFE_LOADSTORE_NO_UPDATE_PC))
@@ -420,6 +506,9 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress,
     MOVZX(64, accessSize, reg_value, R(ABI_RETURN));
   }
 
+  if (check_software_tlb)
+    SetJumpTarget(software_tlb_hit);
+
   if (fast_check_address)
   {
     if (m_far_code.Enabled())
@@ -551,6 +640,25 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
     SetJumpTarget(slow);
   }
 
+  const bool check_software_tlb = m_jit.jo.softwareTLB && dr_set;
+  FixupBranch software_tlb_hit;
+  if (check_software_tlb)
+  {
+    BitSet32 excluded;
+    if (reg_value.IsSimpleReg())
+      excluded[reg_value.GetSimpleReg()] = true;
+
+    software_tlb_hit = CheckSoftwareTLB(
+        reg_addr, accessSize, true, excluded, registersInUse, [&](const OpArg& dest) {
+          if (reg_value.IsImm())
+            MOV(accessSize, dest, swap ? SwapImmediate(accessSize, reg_value) : reg_value);
+          else if (swap)
+            SwapAndStore(accessSize, dest, reg_value.GetSimpleReg());
+          else
+            MOV(accessSize, dest, reg_value);
+        });
+  }
+
   // PC is used by memory watchpoints (if enabled) or to print accurate PC locations in debug logs
   // Invalid for calls from Jit64AsmCommon routines
   if (!(flags & SAFE_LOADSTORE_NO_UPDATE_PC))
@@ -592,6 +700,9 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
 
   MemoryExceptionCheck();
 
+  if (check_software_tlb)
+    SetJumpTarget(software_tlb_hit);
+
   if (fast_check_address)
   {
     if (m_far_code.Enabled())
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <functional>
 #include <unordered_map>
 
 #include "Common/BitSet.h"
@@ -52,6 +53,12 @@ public:
 
   Gen::FixupBranch CheckIfSafeAddress(const Gen::OpArg& reg_value, Gen::X64Reg reg_addr,
                                       BitSet32 registers_in_use);
+  // Looks up the page of reg_addr in PowerPCState::software_tlb and, on a hit, calls access with
+  // the host address to load from or store to. Falls through on a miss; the returned branch is
+  // taken on a hit.
+  Gen::FixupBranch CheckSoftwareTLB(Gen::X64Reg reg_addr, int access_size, bool write,
+                                    BitSet32 excluded, BitSet32 registers_in_use,
+                                    const std::function<void(const Gen::OpArg&)>& access);
   void UnsafeLoadRegToReg(Gen::X64Reg reg_addr, Gen::X64Reg reg_value, int accessSize,
                           s32 offset = 0, bool signExtend = false);
   void UnsafeLoadRegToRegNoSwap(Gen::X64Reg reg_addr, Gen::X64Reg reg_value, int accessSize,
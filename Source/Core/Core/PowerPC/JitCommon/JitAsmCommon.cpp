@@ -6,6 +6,7 @@
 
 alignas(16) const u8 pbswapShuffle1x4[16] = {3, 2, 1, 0, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
 alignas(16) const u8 pbswapShuffle2x4[16] = {3, 2, 1, 0, 7, 6, 5, 4, 8, 9, 10, 11, 12, 13, 14, 15};
+alignas(16) const u8 pbswapShuffle4x4[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
 
 alignas(16) const float m_quantizeTableS[128] = {
     (1ULL << 0),        (1ULL << 0),        (1ULL << 1),        (1ULL << 1),
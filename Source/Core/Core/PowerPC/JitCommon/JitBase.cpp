@@ -4,7 +4,10 @@
 
 #include "Core/PowerPC/JitCommon/JitBase.h"
 
+#include <vector>
+
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/CPU.h"
 #include "Core/PowerPC/PPCAnalyst.h"
@@ -42,9 +45,22 @@ bool JitBase::CanMergeNextInstructions(int count) const
   return true;
 }
 
+u32 JitBase::HashAnalyzedCode() const
+{
+  std::vector<u32> data;
+  data.reserve(code_block.m_num_instructions * 2);
+  for (u32 i = 0; i < code_block.m_num_instructions; i++)
+  {
+    data.push_back(m_code_buffer[i].address);
+    data.push_back(m_code_buffer[i].inst.hex);
+  }
+  return Common::HashAdler32(reinterpret_cast<const u8*>(data.data()), data.size() * sizeof(u32));
+}
+
 void JitBase::UpdateMemoryOptions()
 {
   bool any_watchpoints = PowerPC::memchecks.HasAny();
   jo.fastmem = SConfig::GetInstance().bFastmem && (MSR.DR || !any_watchpoints);
   jo.memcheck = SConfig::GetInstance().bMMU || any_watchpoints;
+  jo.softwareTLB = SConfig::GetInstance().bMMU;
 }
@@ -4,9 +4,12 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <map>
+#include <set>
 #include <unordered_set>
+#include <utility>
 
 #include "Common/CommonTypes.h"
 #include "Common/x64Emitter.h"
@@ -49,6 +52,7 @@ protected:
     bool accurateSinglePrecision;
     bool fastmem;
     bool memcheck;
+    bool softwareTLB;
     bool profile_blocks;
   };
   struct JitState
@@ -90,7 +94,14 @@ protected:
 
     std::unordered_set<u32> fifoWriteAddresses;
     std::unordered_set<u32> pairedQuantizeAddresses;
+    // The physical and effective start addresses of the blocks that were compiled for the
+    // current value of each GQR. The GQR can be written under a different address translation
+    // than the block was compiled under, so the blocks are invalidated by physical address.
+    std::array<std::set<std::pair<u32, u32>>, 8> constantGqrBlocks;
+    // Blocks that have already been recompiled once because one of those GQRs changed.
+    std::unordered_set<u32> gqrChangedAddresses;
     std::unordered_set<u32> noSpeculativeConstantsAddresses;
+    std::unordered_set<u32> hotBranchAddresses;
   };
 
   PPCAnalyst::CodeBlock code_block;
@@ -99,6 +110,9 @@ protected:
 
   bool CanMergeNextInstructions(int count) const;
 
+  // Hashes the addresses and instructions of the most recently analyzed block.
+  u32 HashAnalyzedCode() const;
+
   void UpdateMemoryOptions();
 
 public:
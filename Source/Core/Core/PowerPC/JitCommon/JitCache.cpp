@@ -18,7 +18,10 @@
 #include <utility>
 
 #include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
 #include "Common/JitRegister.h"
+#include "Common/Logging/Log.h"
+#include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
@@ -32,10 +35,106 @@
 
 using namespace Gen;
 
+namespace
+{
+constexpr u32 PERSISTENT_CACHE_MAGIC = 0x4B4C424A;  // JBLK
+constexpr u32 PERSISTENT_CACHE_VERSION = 1;
+constexpr size_t PERSISTENT_CACHE_HEADER_SIZE = sizeof(u32) + sizeof(u32);
+}  // namespace
+
 bool JitBlock::OverlapsPhysicalRange(u32 address, u32 length) const
 {
-  return physical_addresses.lower_bound(address) !=
-         physical_addresses.lower_bound(address + length);
+  const auto iter = std::lower_bound(physical_addresses.begin(), physical_addresses.end(), address);
+  return iter != physical_addresses.end() && u64{*iter} < u64{address} + length;
+}
+
+void JitBlockRangeIndex::Add(JitBlock& block)
+{
+  // physical_addresses is sorted, so each bucket only shows up in one run.
+  // Bucket numbers are never UINT32_MAX, as they only have 32 - BUCKET_SHIFT bits.
+  u32 previous_bucket = UINT32_MAX;
+  for (u32 addr : block.physical_addresses)
+  {
+    const u32 bucket = addr >> BUCKET_SHIFT;
+    if (bucket == previous_bucket)
+      continue;
+    m_buckets[bucket].push_back(&block);
+    previous_bucket = bucket;
+  }
+}
+
+void JitBlockRangeIndex::Remove(const JitBlock& block)
+{
+  u32 previous_bucket = UINT32_MAX;
+  for (u32 addr : block.physical_addresses)
+  {
+    const u32 bucket = addr >> BUCKET_SHIFT;
+    if (bucket == previous_bucket)
+      continue;
+    previous_bucket = bucket;
+
+    auto iter = m_buckets.find(bucket);
+    if (iter == m_buckets.end())
+      continue;
+
+    std::vector<JitBlock*>& blocks = iter->second;
+    auto block_iter = std::find(blocks.begin(), blocks.end(), &block);
+    if (block_iter != blocks.end())
+    {
+      *block_iter = blocks.back();
+      blocks.pop_back();
+    }
+    if (blocks.empty())
+      m_buckets.erase(iter);
+  }
+}
+
+void JitBlockRangeIndex::Clear()
+{
+  m_buckets.clear();
+}
+
+std::vector<JitBlock*> JitBlockRangeIndex::FindOverlapping(u32 address, u32 length) const
+{
+  std::vector<JitBlock*> result;
+  if (length == 0 || m_buckets.empty())
+    return result;
+
+  const auto add_overlapping = [&](const std::vector<JitBlock*>& blocks) {
+    for (JitBlock* block : blocks)
+    {
+      if (block->OverlapsPhysicalRange(address, length) &&
+          std::find(result.begin(), result.end(), block) == result.end())
+      {
+        result.push_back(block);
+      }
+    }
+  };
+
+  const u32 first_bucket = address >> BUCKET_SHIFT;
+  const u32 last_bucket = static_cast<u32>((u64{address} + length - 1) >> BUCKET_SHIFT);
+  if (u64{last_bucket} - first_bucket >= m_buckets.size())
+  {
+    // Large ranges (e.g. DMA) are cheaper to handle by looking at every occupied bucket.
+    for (const auto& bucket : m_buckets)
+    {
+      if (bucket.first >= first_bucket && bucket.first <= last_bucket)
+        add_overlapping(bucket.second);
+    }
+  }
+  else
+  {
+    for (u32 bucket = first_bucket;; bucket++)
+    {
+      const auto iter = m_buckets.find(bucket);
+      if (iter != m_buckets.end())
+        add_overlapping(iter->second);
+      if (bucket == last_bucket)
+        break;
+    }
+  }
+
+  return result;
 }
 
 JitBaseBlockCache::JitBaseBlockCache(JitBase& jit) : m_jit{jit}
@@ -48,11 +147,18 @@ void JitBaseBlockCache::Init()
 {
   JitRegister::Init(SConfig::GetInstance().m_perfDir);
 
+  // Blocks compiled while debugging or without a block cache are not representative of
+  // a normal run, so don't record or precompile anything in those cases.
+  m_persistent_cache_enabled = Config::Get(Config::MAIN_JIT_PERSISTENT_CACHE) &&
+                               !SConfig::GetInstance().bJITNoBlockCache &&
+                               !SConfig::GetInstance().bEnableDebugging;
+
   Clear();
 }
 
 void JitBaseBlockCache::Shutdown()
 {
+  ClosePersistentCache();
   JitRegister::Shutdown();
 }
 
@@ -65,13 +171,16 @@ void JitBaseBlockCache::Clear()
 #endif
   m_jit.js.fifoWriteAddresses.clear();
   m_jit.js.pairedQuantizeAddresses.clear();
+  for (auto& blocks : m_jit.js.constantGqrBlocks)
+    blocks.clear();
+  m_jit.js.gqrChangedAddresses.clear();
   for (auto& e : block_map)
   {
     DestroyBlock(e.second);
   }
   block_map.clear();
   links_to.clear();
-  block_range_map.clear();
+  block_range_index.Clear();
 
   valid_block.ClearAll();
 
@@ -114,14 +223,11 @@ void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
   fast_block_map[index] = &block;
   block.fast_block_map_index = index;
 
-  block.physical_addresses = physical_addresses;
+  block.physical_addresses.assign(physical_addresses.begin(), physical_addresses.end());
 
-  u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
   for (u32 addr : physical_addresses)
-  {
     valid_block.Set(addr / 32);
-    block_range_map[addr & range_mask].insert(&block);
-  }
+  block_range_index.Add(block);
 
   if (block_link)
   {
@@ -216,6 +322,7 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
       {
         m_jit.js.fifoWriteAddresses.erase(i);
         m_jit.js.pairedQuantizeAddresses.erase(i);
+        m_jit.js.gqrChangedAddresses.erase(i);
       }
     }
   }
@@ -223,56 +330,144 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
 
 void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
 {
-  // Iterate over all macro blocks which overlap the given range.
-  u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
-  auto start = block_range_map.lower_bound(address & range_mask);
-  auto end = block_range_map.lower_bound(address + length);
-  while (start != end)
+  for (JitBlock* block : block_range_index.FindOverlapping(address, length))
   {
-    // Iterate over all blocks in the macro block.
-    auto iter = start->second.begin();
-    while (iter != start->second.end())
+    block_range_index.Remove(*block);
+
+    // And remove the block.
+    DestroyBlock(*block);
+    auto block_map_iter = block_map.equal_range(block->physicalAddress);
+    while (block_map_iter.first != block_map_iter.second)
     {
-      JitBlock* block = *iter;
-      if (block->OverlapsPhysicalRange(address, length))
+      if (&block_map_iter.first->second == block)
       {
-        // If the block overlaps, also remove all other occupied slots in the other macro blocks.
-        // This will leak empty macro blocks, but they may be reused or cleared later on.
-        for (u32 addr : block->physical_addresses)
-          if ((addr & range_mask) != start->first)
-            block_range_map[addr & range_mask].erase(block);
-
-        // And remove the block.
-        DestroyBlock(*block);
-        auto block_map_iter = block_map.equal_range(block->physicalAddress);
-        while (block_map_iter.first != block_map_iter.second)
-        {
-          if (&block_map_iter.first->second == block)
-          {
-            block_map.erase(block_map_iter.first);
-            break;
-          }
-          block_map_iter.first++;
-        }
-        iter = start->second.erase(iter);
+        block_map.erase(block_map_iter.first);
+        break;
       }
-      else
+      block_map_iter.first++;
+    }
+  }
+}
+
+void JitBaseBlockCache::AddPersistentBlock(const JitBlock& block, u32 code_hash)
+{
+  if (!m_persistent_cache_enabled)
+    return;
+
+  if (m_persistent_cache_game_id != SConfig::GetInstance().GetGameID())
+    LoadPersistentCache();
+
+  if (!m_persistent_cache_file.IsOpen())
+    return;
+
+  const PersistentBlock record{block.effectiveAddress, block.physicalAddress, block.msrBits,
+                               code_hash};
+  if (!m_persistent_known_blocks
+           .emplace(record.effective_address, record.physical_address, record.msr_bits,
+                    record.code_hash)
+           .second)
+  {
+    return;
+  }
+
+  if (!m_persistent_cache_file.WriteBytes(&record, sizeof(record)))
+  {
+    WARN_LOG(DYNA_REC, "Failed to write to the persistent JIT cache, disabling it");
+    m_persistent_cache_file.Close();
+  }
+}
+
+std::vector<JitBaseBlockCache::PersistentBlock>
+JitBaseBlockCache::TakePersistentBlocks(u32 physical_address, u32 msr_bits)
+{
+  if (!m_persistent_cache_enabled)
+    return {};
+
+  if (m_persistent_cache_game_id != SConfig::GetInstance().GetGameID())
+    LoadPersistentCache();
+
+  auto iter = m_persistent_blocks.find(physical_address >> PERSISTENT_CACHE_PAGE_SHIFT);
+  if (iter == m_persistent_blocks.end())
+    return {};
+
+  // Blocks recorded with different translation bits stay pending until we run in that mode.
+  std::vector<PersistentBlock>& pending = iter->second;
+  const auto split = std::stable_partition(pending.begin(), pending.end(),
+                                           [&](const auto& b) { return b.msr_bits != msr_bits; });
+  std::vector<PersistentBlock> result(split, pending.end());
+  pending.erase(split, pending.end());
+  if (pending.empty())
+    m_persistent_blocks.erase(iter);
+
+  return result;
+}
+
+void JitBaseBlockCache::LoadPersistentCache()
+{
+  ClosePersistentCache();
+
+  m_persistent_cache_game_id = SConfig::GetInstance().GetGameID();
+  if (m_persistent_cache_game_id.empty())
+    return;
+
+  const std::string filename =
+      File::GetUserPath(D_CACHE_IDX) + m_persistent_cache_game_id + ".jitcache";
+  if (m_persistent_cache_file.Open(filename, "rb+"))
+  {
+    u32 magic;
+    u32 version;
+    bool file_valid = false;
+    if (m_persistent_cache_file.ReadBytes(&magic, sizeof(magic)) &&
+        m_persistent_cache_file.ReadBytes(&version, sizeof(version)) &&
+        magic == PERSISTENT_CACHE_MAGIC && version == PERSISTENT_CACHE_VERSION)
+    {
+      // A partially written record at the end (e.g. if Dolphin crashed) is dropped and
+      // overwritten by the next record we append.
+      const u64 file_size = m_persistent_cache_file.GetSize();
+      const size_t count =
+          static_cast<size_t>(file_size - PERSISTENT_CACHE_HEADER_SIZE) / sizeof(PersistentBlock);
+      const u64 valid_size = PERSISTENT_CACHE_HEADER_SIZE + count * sizeof(PersistentBlock);
+
+      std::vector<PersistentBlock> records(count);
+      file_valid = m_persistent_cache_file.ReadArray(records.data(), count) &&
+                   m_persistent_cache_file.Seek(valid_size, SEEK_SET);
+      if (file_valid)
       {
-        iter++;
+        for (const PersistentBlock& record : records)
+        {
+          m_persistent_known_blocks.emplace(record.effective_address, record.physical_address,
+                                            record.msr_bits, record.code_hash);
+          m_persistent_blocks[record.physical_address >> PERSISTENT_CACHE_PAGE_SHIFT].push_back(
+              record);
+        }
+        INFO_LOG(DYNA_REC, "Loaded %zu blocks from the persistent JIT cache", count);
       }
     }
 
-    // If the macro block is empty, drop it.
-    if (start->second.empty())
-      start = block_range_map.erase(start);
-    else
-      start++;
+    // If the file is invalid, close it. We re-open and truncate it below.
+    if (!file_valid)
+      m_persistent_cache_file.Close();
+  }
+
+  if (!m_persistent_cache_file.IsOpen() && m_persistent_cache_file.Open(filename, "wb"))
+  {
+    m_persistent_cache_file.WriteBytes(&PERSISTENT_CACHE_MAGIC, sizeof(PERSISTENT_CACHE_MAGIC));
+    m_persistent_cache_file.WriteBytes(&PERSISTENT_CACHE_VERSION,
+                                       sizeof(PERSISTENT_CACHE_VERSION));
   }
 }
 
+void JitBaseBlockCache::ClosePersistentCache()
+{
+  m_persistent_cache_file.Close();
+  m_persistent_cache_game_id.clear();
+  m_persistent_blocks.clear();
+  m_persistent_known_blocks.clear();
+}
+
 u32* JitBaseBlockCache::GetBlockBitSet() const
 {
-  return valid_block.m_valid_block.get();
+  return valid_block.GetData();
 }
 
 void JitBaseBlockCache::WriteDestroyBlock(const JitBlock& block)
@@ -11,9 +11,14 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/MemoryUtil.h"
 
 class JitBase;
 
@@ -33,6 +38,15 @@ struct JitBlock
   u8* checkedEntry;
   // The normal entry point for the block, returned by Dispatch().
   u8* normalEntry;
+  // An entry point for block linking which skips loading the guest registers listed in
+  // entryResidency, or nullptr if the block doesn't have one.
+  u8* residentEntry;
+
+  // Guest registers held in host registers across a block link, indexed by host register. Each
+  // entry is the guest register number plus one, or zero if the host register holds nothing.
+  using RegisterResidency = std::array<u8, 16>;
+  // The guest registers the block expects to be loaded when it is entered through residentEntry.
+  RegisterResidency entryResidency;
 
   // The effective address (PC) for the beginning of the block.
   u32 effectiveAddress;
@@ -58,11 +72,13 @@ struct JitBlock
     u32 exitAddress;
     bool linkStatus;  // is it already linked?
     bool call;
+    // The guest registers which are still loaded when the exit is taken.
+    RegisterResidency residency;
   };
   std::vector<LinkData> linkData;
 
-  // This set stores all physical addresses of all occupied instructions.
-  std::set<u32> physical_addresses;
+  // This sorted vector stores all physical addresses of all occupied instructions.
+  std::vector<u32> physical_addresses;
 
   // Block profiling data, structure is inlined in Jit.cpp
   struct ProfileData
@@ -81,8 +97,34 @@ struct JitBlock
 
 typedef void (*CompiledCode)();
 
+// Index of the blocks occupying each range of physical memory, used to find the blocks to
+// invalidate when code is modified. Blocks are grouped in buckets of BUCKET_SIZE bytes. Each
+// bucket is a short unsorted vector in a hash table, so invalidating a single cache line is a
+// hash lookup and a linear scan over a few pointers rather than a walk over tree nodes.
+class JitBlockRangeIndex final
+{
+public:
+  static constexpr u32 BUCKET_SHIFT = 8;
+  static constexpr u32 BUCKET_SIZE = 1 << BUCKET_SHIFT;
+
+  void Add(JitBlock& block);
+  void Remove(const JitBlock& block);
+  void Clear();
+
+  // Returns every block which has an instruction in the range [address, address + length).
+  std::vector<JitBlock*> FindOverlapping(u32 address, u32 length) const;
+
+private:
+  std::unordered_map<u32, std::vector<JitBlock*>> m_buckets;
+};
+
 // This is essentially just an std::bitset, but Visual Studia 2013's
 // implementation of std::bitset is slow.
+//
+// The storage comes straight from the OS as untouched pages, which are only backed by memory
+// once a bit in them is set. Most of the 32-bit address space has no RAM behind it, so most of
+// the bitset never becomes resident. ClearAll() only wipes the chunks which had a bit set since
+// the last clear instead of the whole 16 MiB.
 class ValidBlockBitSet final
 {
 public:
@@ -90,25 +132,49 @@ public:
   {
     // ValidBlockBitSet covers the whole 32-bit address-space in 32-byte
     // chunks.
-    // FIXME: Maybe we can get away with less? There isn't any actual
-    // RAM in most of this space.
     VALID_BLOCK_MASK_SIZE = (1ULL << 32) / 32,
     // The number of elements in the allocated array. Each u32 contains 32 bits.
-    VALID_BLOCK_ALLOC_ELEMENTS = VALID_BLOCK_MASK_SIZE / 32
+    VALID_BLOCK_ALLOC_ELEMENTS = VALID_BLOCK_MASK_SIZE / 32,
+    // The number of elements in a chunk tracked by ClearAll(). Each chunk is 64 KiB,
+    // and covers 16 MiB of address space.
+    DIRTY_CHUNK_ELEMENTS = 0x4000,
+    DIRTY_CHUNK_COUNT = VALID_BLOCK_ALLOC_ELEMENTS / DIRTY_CHUNK_ELEMENTS
   };
-  // Directly accessed by Jit64.
-  std::unique_ptr<u32[]> m_valid_block;
 
   ValidBlockBitSet()
+      : m_valid_block(static_cast<u32*>(Common::AllocateMemoryPages(ALLOC_SIZE_BYTES)))
   {
-    m_valid_block.reset(new u32[VALID_BLOCK_ALLOC_ELEMENTS]);
-    ClearAll();
   }
+  ~ValidBlockBitSet() { Common::FreeMemoryPages(m_valid_block, ALLOC_SIZE_BYTES); }
+
+  ValidBlockBitSet(const ValidBlockBitSet&) = delete;
+  ValidBlockBitSet& operator=(const ValidBlockBitSet&) = delete;
+
+  // Directly accessed by Jit64.
+  u32* GetData() const { return m_valid_block; }
 
-  void Set(u32 bit) { m_valid_block[bit / 32] |= 1u << (bit % 32); }
+  void Set(u32 bit)
+  {
+    m_dirty_chunks[bit / 32 / DIRTY_CHUNK_ELEMENTS] = true;
+    m_valid_block[bit / 32] |= 1u << (bit % 32);
+  }
   void Clear(u32 bit) { m_valid_block[bit / 32] &= ~(1u << (bit % 32)); }
-  void ClearAll() { memset(m_valid_block.get(), 0, sizeof(u32) * VALID_BLOCK_ALLOC_ELEMENTS); }
+  void ClearAll()
+  {
+    for (size_t i = 0; i < DIRTY_CHUNK_COUNT; i++)
+    {
+      if (m_dirty_chunks[i])
+        memset(m_valid_block + i * DIRTY_CHUNK_ELEMENTS, 0, sizeof(u32) * DIRTY_CHUNK_ELEMENTS);
+    }
+    m_dirty_chunks.reset();
+  }
   bool Test(u32 bit) { return (m_valid_block[bit / 32] & (1u << (bit % 32))) != 0; }
+
+private:
+  static constexpr size_t ALLOC_SIZE_BYTES = sizeof(u32) * VALID_BLOCK_ALLOC_ELEMENTS;
+
+  u32* m_valid_block;
+  std::bitset<DIRTY_CHUNK_COUNT> m_dirty_chunks;
 };
 
 class JitBaseBlockCache
@@ -121,6 +187,18 @@ public:
   static constexpr u32 FAST_BLOCK_MAP_ELEMENTS = 0x10000;
   static constexpr u32 FAST_BLOCK_MAP_MASK = FAST_BLOCK_MAP_ELEMENTS - 1;
 
+  // A block which was compiled during a previous run of the same game, as stored in the
+  // persistent block cache. Only the guest side of the block is stored: the host code embeds
+  // pointers which are not stable between runs, so the block is recompiled from the record.
+  // The code hash is compared against the current guest code before anything is compiled.
+  struct PersistentBlock
+  {
+    u32 effective_address;
+    u32 physical_address;
+    u32 msr_bits;
+    u32 code_hash;
+  };
+
   explicit JitBaseBlockCache(JitBase& jit);
   virtual ~JitBaseBlockCache();
 
@@ -152,6 +230,12 @@ public:
 
   u32* GetBlockBitSet() const;
 
+  // Persistent block cache
+  bool IsPersistentCacheEnabled() const { return m_persistent_cache_enabled; }
+  void AddPersistentBlock(const JitBlock& block, u32 code_hash);
+  // Returns (and forgets) the recorded blocks which start in the same page as physical_address.
+  std::vector<PersistentBlock> TakePersistentBlocks(u32 physical_address, u32 msr_bits);
+
 protected:
   JitBase& m_jit;
 
@@ -169,6 +253,9 @@ private:
   // Fast but risky block lookup based on fast_block_map.
   size_t FastLookupIndexForAddress(u32 address);
 
+  void LoadPersistentCache();
+  void ClosePersistentCache();
+
   // links_to hold all exit points of all valid blocks in a reverse way.
   // It is used to query all blocks which links to an address.
   std::multimap<u32, JitBlock*> links_to;  // destination_PC -> number
@@ -177,11 +264,9 @@ private:
   // This is used to query the block based on the current PC in a slow way.
   std::multimap<u32, JitBlock> block_map;  // start_addr -> block
 
-  // Range of overlapping code indexed by a masked physical address.
-  // This is used for invalidation of memory regions. The range is grouped
-  // in macro blocks of each 0x100 bytes.
-  static constexpr u32 BLOCK_RANGE_MAP_ELEMENTS = 0x100;
-  std::map<u32, std::set<JitBlock*>> block_range_map;
+  // Range of overlapping code indexed by physical address.
+  // This is used for invalidation of memory regions.
+  JitBlockRangeIndex block_range_index;
 
   // This bitsets shows which cachelines overlap with any blocks.
   // It is used to provide a fast way to query if no icache invalidation is needed.
@@ -190,4 +275,15 @@ private:
   // This array is indexed with the masked PC and likely holds the correct block id.
   // This is used as a fast cache of block_map used in the assembly dispatcher.
   std::array<JitBlock*, FAST_BLOCK_MAP_ELEMENTS> fast_block_map;  // start_addr & mask -> number
+
+  // Blocks recorded by previous runs which have not been compiled yet, indexed by physical page.
+  // Blocks are taken out of this map when a block in the same page is compiled, which is
+  // the first point at which the code they represent is known to be loaded.
+  static constexpr u32 PERSISTENT_CACHE_PAGE_SHIFT = 12;
+  std::map<u32, std::vector<PersistentBlock>> m_persistent_blocks;
+  // All blocks which have been written to the cache file, to avoid duplicate records.
+  std::set<std::tuple<u32, u32, u32, u32>> m_persistent_known_blocks;
+  File::IOFile m_persistent_cache_file;
+  std::string m_persistent_cache_game_id;
+  bool m_persistent_cache_enabled = false;
 };
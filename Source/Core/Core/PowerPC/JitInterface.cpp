@@ -5,6 +5,7 @@
 #include "Core/PowerPC/JitInterface.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <string>
@@ -19,8 +20,12 @@
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/SymbolDB.h"
 
+#include "Core/Config/MainSettings.h"
 #include "Core/Core.h"
 #include "Core/PowerPC/CPUCoreBase.h"
 #include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
@@ -41,6 +46,7 @@
 namespace JitInterface
 {
 static JitBase* g_jit = nullptr;
+static std::chrono::steady_clock::time_point s_last_profile_dump;
 void SetJit(JitBase* jit)
 {
   g_jit = jit;
@@ -76,6 +82,13 @@ CPUCoreBase* InitJitCore(PowerPC::CPUCore core)
     return nullptr;
   }
   g_jit->Init();
+
+  if (Config::Get(Config::MAIN_JIT_PROFILE_DUMP_INTERVAL) > 0)
+  {
+    SetProfilingState(ProfilingState::Enabled);
+    s_last_profile_dump = std::chrono::steady_clock::now();
+  }
+
   return g_jit;
 }
 
@@ -92,63 +105,128 @@ void SetProfilingState(ProfilingState state)
   g_jit->jo.profile_blocks = state == ProfilingState::Enabled;
 }
 
-void WriteProfileResults(const std::string& filename)
+// Reads the profile data of all blocks. The JIT must not be running while this is called.
+static void GatherProfileResults(Profiler::ProfileStats* prof_stats)
 {
-  Profiler::ProfileStats prof_stats;
-  GetProfileResults(&prof_stats);
+  prof_stats->cost_sum = 0;
+  prof_stats->timecost_sum = 0;
+  prof_stats->block_stats.clear();
 
+  QueryPerformanceFrequency((LARGE_INTEGER*)&prof_stats->countsPerSec);
+  g_jit->GetBlockCache()->RunOnBlocks([&prof_stats](const JitBlock& block) {
+    const auto& data = block.profile_data;
+    u64 cost = data.downcountCounter;
+    u64 timecost = data.ticCounter;
+    // Todo: tweak.
+    if (data.runCount >= 1)
+      prof_stats->block_stats.emplace_back(block.effectiveAddress, cost, timecost, data.runCount,
+                                           block.codeSize);
+    prof_stats->cost_sum += cost;
+    prof_stats->timecost_sum += timecost;
+  });
+
+  sort(prof_stats->block_stats.begin(), prof_stats->block_stats.end());
+}
+
+static void WriteProfileTable(const Profiler::ProfileStats& prof_stats, std::FILE* file)
+{
+  fprintf(file, "origAddr\tblkName\trunCount\tcost\ttimeCost\tpercent\ttimePercent\tOvAllinBlkTim"
+                "e(ms)\tblkCodeSize\n");
+  for (auto& stat : prof_stats.block_stats)
+  {
+    std::string name = g_symbolDB.GetDescription(stat.addr);
+    double percent = 100.0 * (double)stat.cost / (double)prof_stats.cost_sum;
+    double timePercent = 100.0 * (double)stat.tick_counter / (double)prof_stats.timecost_sum;
+    fprintf(file, "%08x\t%s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%.2f\t%.2f\t%.2f\t%i\n",
+            stat.addr, name.c_str(), stat.run_count, stat.cost, stat.tick_counter, percent,
+            timePercent, (double)stat.tick_counter * 1000.0 / (double)prof_stats.countsPerSec,
+            stat.block_size);
+  }
+}
+
+static void WriteProfileFoldedStacks(const Profiler::ProfileStats& prof_stats, std::FILE* file)
+{
+  for (auto& stat : prof_stats.block_stats)
+  {
+    if (stat.tick_counter == 0)
+      continue;
+
+    // Semicolons separate the frames, so they can't appear in (demangled C++) names.
+    const Common::Symbol* symbol = g_symbolDB.GetSymbolFromAddr(stat.addr);
+    std::string function =
+        symbol ? symbol->function_name : StringFromFormat("unknown_%08x", stat.addr);
+    std::replace(function.begin(), function.end(), ';', ':');
+
+    // One frame for the guest function, and one for the block within it.
+    fprintf(file, "%s;%08x %" PRIu64 "\n", function.c_str(), stat.addr, stat.tick_counter);
+  }
+}
+
+static void WriteProfileResults(const Profiler::ProfileStats& prof_stats,
+                                const std::string& filename, ProfileFormat format)
+{
   File::IOFile f(filename, "w");
   if (!f)
   {
     PanicAlert("Failed to open %s", filename.c_str());
     return;
   }
-  fprintf(f.GetHandle(), "origAddr\tblkName\trunCount\tcost\ttimeCost\tpercent\ttimePercent\tOvAlli"
-                         "nBlkTime(ms)\tblkCodeSize\n");
-  for (auto& stat : prof_stats.block_stats)
+
+  switch (format)
   {
-    std::string name = g_symbolDB.GetDescription(stat.addr);
-    double percent = 100.0 * (double)stat.cost / (double)prof_stats.cost_sum;
-    double timePercent = 100.0 * (double)stat.tick_counter / (double)prof_stats.timecost_sum;
-    fprintf(f.GetHandle(),
-            "%08x\t%s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%.2f\t%.2f\t%.2f\t%i\n", stat.addr,
-            name.c_str(), stat.run_count, stat.cost, stat.tick_counter, percent, timePercent,
-            (double)stat.tick_counter * 1000.0 / (double)prof_stats.countsPerSec, stat.block_size);
+  case ProfileFormat::Table:
+    WriteProfileTable(prof_stats, f.GetHandle());
+    break;
+  case ProfileFormat::FoldedStacks:
+    WriteProfileFoldedStacks(prof_stats, f.GetHandle());
+    break;
   }
 }
 
+void WriteProfileResults(const std::string& filename, ProfileFormat format)
+{
+  Profiler::ProfileStats prof_stats;
+  GetProfileResults(&prof_stats);
+  WriteProfileResults(prof_stats, filename, format);
+}
+
 void GetProfileResults(Profiler::ProfileStats* prof_stats)
 {
   // Can't really do this with no g_jit core available
   if (!g_jit)
     return;
 
-  prof_stats->cost_sum = 0;
-  prof_stats->timecost_sum = 0;
-  prof_stats->block_stats.clear();
-
   Core::State old_state = Core::GetState();
   if (old_state == Core::State::Running)
     Core::SetState(Core::State::Paused);
 
-  QueryPerformanceFrequency((LARGE_INTEGER*)&prof_stats->countsPerSec);
-  g_jit->GetBlockCache()->RunOnBlocks([&prof_stats](const JitBlock& block) {
-    const auto& data = block.profile_data;
-    u64 cost = data.downcountCounter;
-    u64 timecost = data.ticCounter;
-    // Todo: tweak.
-    if (data.runCount >= 1)
-      prof_stats->block_stats.emplace_back(block.effectiveAddress, cost, timecost, data.runCount,
-                                           block.codeSize);
-    prof_stats->cost_sum += cost;
-    prof_stats->timecost_sum += timecost;
-  });
+  GatherProfileResults(prof_stats);
 
-  sort(prof_stats->block_stats.begin(), prof_stats->block_stats.end());
   if (old_state == Core::State::Running)
     Core::SetState(Core::State::Running);
 }
 
+void UpdateProfileDump()
+{
+  if (!g_jit || !g_jit->jo.profile_blocks)
+    return;
+
+  const int interval = Config::Get(Config::MAIN_JIT_PROFILE_DUMP_INTERVAL);
+  const auto now = std::chrono::steady_clock::now();
+  if (interval <= 0 || now - s_last_profile_dump < std::chrono::seconds(interval))
+    return;
+  s_last_profile_dump = now;
+
+  // We're on the CPU thread between blocks, so there's no need to pause the emulation.
+  Profiler::ProfileStats prof_stats;
+  GatherProfileResults(&prof_stats);
+
+  const std::string path = File::GetUserPath(D_DUMP_IDX) + "Debug/";
+  File::CreateFullPath(path);
+  WriteProfileResults(prof_stats, path + "profiler.txt", ProfileFormat::Table);
+  WriteProfileResults(prof_stats, path + "profiler.folded", ProfileFormat::FoldedStacks);
+}
+
 int GetHostCode(u32* address, const u8** code, u32* code_size)
 {
   if (!g_jit)
@@ -244,6 +322,9 @@ void CompileExceptionCheck(ExceptionType type)
   case ExceptionType::SpeculativeConstants:
     exception_addresses = &g_jit->js.noSpeculativeConstantsAddresses;
     break;
+  case ExceptionType::HotBranch:
+    exception_addresses = &g_jit->js.hotBranchAddresses;
+    break;
   }
 
   if (PC != 0 && (exception_addresses->find(PC)) == (exception_addresses->end()))
@@ -263,6 +344,24 @@ void CompileExceptionCheck(ExceptionType type)
   }
 }
 
+void GQRUpdated(u32 gqr)
+{
+  if (!g_jit)
+    return;
+
+  auto& js = g_jit->js;
+  for (const auto& block : js.constantGqrBlocks[gqr])
+  {
+    const u32 physical_address = block.first;
+    const u32 effective_address = block.second;
+    // A block which keeps seeing different GQR values is better off without the speculation.
+    if (!js.gqrChangedAddresses.insert(effective_address).second)
+      js.pairedQuantizeAddresses.insert(effective_address);
+    g_jit->GetBlockCache()->ErasePhysicalRange(physical_address, 4);
+  }
+  js.constantGqrBlocks[gqr].clear();
+}
+
 void Shutdown()
 {
   if (g_jit)
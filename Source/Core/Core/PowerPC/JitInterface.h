@@ -29,7 +29,8 @@ enum class ExceptionType
 {
   FIFOWrite,
   PairedQuantize,
-  SpeculativeConstants
+  SpeculativeConstants,
+  HotBranch
 };
 
 void DoState(PointerWrap& p);
@@ -44,9 +45,21 @@ enum class ProfilingState
   Disabled
 };
 
+enum class ProfileFormat
+{
+  // Tab-separated table of blocks, sorted by cost.
+  Table,
+  // One "function;block count" line per block, weighted by host time. This is the folded stack
+  // format read by flamegraph.pl, speedscope, inferno and the like.
+  FoldedStacks
+};
+
 void SetProfilingState(ProfilingState state);
-void WriteProfileResults(const std::string& filename);
+void WriteProfileResults(const std::string& filename, ProfileFormat format = ProfileFormat::Table);
 void GetProfileResults(Profiler::ProfileStats* prof_stats);
+// Writes the profile to the Dump/Debug directory every MAIN_JIT_PROFILE_DUMP_INTERVAL seconds.
+// Must be called on the CPU thread.
+void UpdateProfileDump();
 int GetHostCode(u32* address, const u8** code, u32* code_size);
 
 // Memory Utilities
@@ -66,6 +79,9 @@ void InvalidateICache(u32 address, u32 size, bool forced);
 
 void CompileExceptionCheck(ExceptionType type);
 
+// Recompiles the blocks which were specialized for the previous value of the given GQR.
+void GQRUpdated(u32 gqr);
+
 /// used for the page fault unit test, don't use outside of tests!
 void SetJit(JitBase* jit);
 
@@ -989,6 +989,64 @@ enum class TLBLookupResult
   UpdateC
 };
 
+// Returns whether the given physical address is backed by memory mapped in physical_base (and
+// logical_base), as opposed to MMIO or unmapped addresses.
+static bool IsDirectlyAccessiblePhysicalAddress(u32 physical_address)
+{
+  if (Memory::m_pFakeVMEM && (physical_address & 0xFE000000) == 0x7E000000)
+    return true;
+  if (physical_address < Memory::REALRAM_SIZE)
+    return true;
+  if (Memory::m_pEXRAM && physical_address >> 28 == 0x1 &&
+      (physical_address & 0x0FFFFFFF) < Memory::EXRAM_SIZE)
+  {
+    return true;
+  }
+  return physical_address >> 28 == 0xE && physical_address < 0xE0000000 + Memory::L1_CACHE_SIZE;
+}
+
+static bool s_software_tlb_in_use = false;
+
+static void ClearSoftwareTLB()
+{
+  if (!s_software_tlb_in_use)
+    return;
+
+  ppcState.software_tlb.fill(0);
+  s_software_tlb_in_use = false;
+}
+
+static void InvalidateSoftwareTLBEntry(u32 tag)
+{
+  if (tag != TLBEntry::INVALID_TAG)
+    ppcState.software_tlb[tag] = 0;
+}
+
+// Mirrors a data TLB entry into the software TLB the JIT uses to access memory without calling
+// into this file. Writes are only allowed once the C bit of the page is set, since a TLB hit
+// which has to set it takes the slow path.
+static void UpdateSoftwareTLBEntry(const XCheckTLBFlag flag, u32 address, u32 physical_page,
+                                   bool changed)
+{
+  if (flag != XCheckTLBFlag::Read && flag != XCheckTLBFlag::Write)
+    return;
+
+  const u32 page = address & ~static_cast<u32>(HW_PAGE_SIZE - 1);
+  if (!IsDirectlyAccessiblePhysicalAddress(physical_page))
+    return;
+
+  // Accesses through the software TLB don't check memchecks, like fastmem.
+  if (PowerPC::memchecks.OverlapsMemcheck(page, HW_PAGE_SIZE))
+    return;
+
+  u64 entry = reinterpret_cast<u64>(&Memory::physical_base[physical_page]) - page;
+  if (changed)
+    entry |= SOFTWARE_TLB_WRITABLE;
+
+  ppcState.software_tlb[page >> HW_PAGE_INDEX_SHIFT] = entry;
+  s_software_tlb_in_use = true;
+}
+
 static TLBLookupResult LookupTLBPageAddress(const XCheckTLBFlag flag, const u32 vpa, u32* paddr)
 {
   const u32 tag = vpa >> HW_PAGE_INDEX_SHIFT;
@@ -1012,6 +1070,10 @@ static TLBLookupResult LookupTLBPageAddress(const XCheckTLBFlag flag, const u32
     if (!IsNoExceptionFlag(flag))
       tlbe.recent = 0;
 
+    UPTE2 PTE2;
+    PTE2.Hex = tlbe.pte[0];
+    UpdateSoftwareTLBEntry(flag, vpa, tlbe.paddr[0], PTE2.C);
+
     *paddr = tlbe.paddr[0] | (vpa & 0xfff);
 
     return TLBLookupResult::Found;
@@ -1034,6 +1096,10 @@ static TLBLookupResult LookupTLBPageAddress(const XCheckTLBFlag flag, const u32
     if (!IsNoExceptionFlag(flag))
       tlbe.recent = 1;
 
+    UPTE2 PTE2;
+    PTE2.Hex = tlbe.pte[1];
+    UpdateSoftwareTLBEntry(flag, vpa, tlbe.paddr[1], PTE2.C);
+
     *paddr = tlbe.paddr[1] | (vpa & 0xfff);
 
     return TLBLookupResult::Found;
@@ -1050,6 +1116,8 @@ static void UpdateTLBEntry(const XCheckTLBFlag flag, UPTE2 PTE2, const u32 addre
   TLBEntry& tlbe = ppcState.tlb[IsOpcodeFlag(flag)][tag & HW_PAGE_INDEX_MASK];
   const int index = tlbe.recent == 0 && tlbe.tag[0] != TLBEntry::INVALID_TAG;
   tlbe.recent = index;
+  if (!IsOpcodeFlag(flag))
+    InvalidateSoftwareTLBEntry(tlbe.tag[index]);
   tlbe.paddr[index] = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
   tlbe.pte[index] = PTE2.Hex;
   tlbe.tag[index] = tag;
@@ -1060,6 +1128,8 @@ void InvalidateTLBEntry(u32 address)
   const u32 entry_index = (address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK;
 
   TLBEntry& tlbe = ppcState.tlb[0][entry_index];
+  InvalidateSoftwareTLBEntry(tlbe.tag[0]);
+  InvalidateSoftwareTLBEntry(tlbe.tag[1]);
   tlbe.tag[0] = TLBEntry::INVALID_TAG;
   tlbe.tag[1] = TLBEntry::INVALID_TAG;
 
@@ -1153,6 +1223,8 @@ static TranslateAddressResult TranslatePageAddress(const u32 address, const XChe
         if (res != TLBLookupResult::UpdateC)
           UpdateTLBEntry(flag, PTE2, address);
 
+        UpdateSoftwareTLBEntry(flag, address, PTE2.RPN << HW_PAGE_INDEX_SHIFT, PTE2.C);
+
         return TranslateAddressResult{TranslateAddressResult::PAGE_TABLE_TRANSLATED,
                                       (PTE2.RPN << 12) | offset};
       }
@@ -1212,15 +1284,7 @@ static void UpdateBATs(BatTable& bat_table, u32 base_spr)
         // The bottom bit is whether the translation is valid; the second
         // bit from the bottom is whether we can use the fastmem arena.
         u32 valid_bit = BAT_MAPPED_BIT;
-        if (Memory::m_pFakeVMEM && (physical_address & 0xFE000000) == 0x7E000000)
-          valid_bit |= BAT_PHYSICAL_BIT;
-        else if (physical_address < Memory::REALRAM_SIZE)
-          valid_bit |= BAT_PHYSICAL_BIT;
-        else if (Memory::m_pEXRAM && physical_address >> 28 == 0x1 &&
-                 (physical_address & 0x0FFFFFFF) < Memory::EXRAM_SIZE)
-          valid_bit |= BAT_PHYSICAL_BIT;
-        else if (physical_address >> 28 == 0xE &&
-                 physical_address < 0xE0000000 + Memory::L1_CACHE_SIZE)
+        if (IsDirectlyAccessiblePhysicalAddress(physical_address))
           valid_bit |= BAT_PHYSICAL_BIT;
 
         // Fastmem doesn't support memchecks, so disable it for all overlapping virtual pages.
@@ -1253,6 +1317,10 @@ static void UpdateFakeMMUBat(BatTable& bat_table, u32 start_addr)
 
 void DBATUpdated()
 {
+  // BATs take priority over the page table, and this is also called whenever the TLB or the
+  // memchecks have been replaced wholesale, so drop everything the JIT might have cached.
+  ClearSoftwareTLB();
+
   dbat_table = {};
   UpdateBATs(dbat_table, SPR_DBAT0U);
   bool extended_bats = SConfig::GetInstance().bWii && HID4.SBE;
@@ -40,6 +40,9 @@ namespace PPCAnalyst
 // 0 does not perform block merging
 constexpr u32 BRANCH_FOLLOWING_THRESHOLD = 2;
 
+// Maximum number of hot conditional branches followed in a single block
+constexpr u32 HOT_BRANCH_FOLLOWING_THRESHOLD = 4;
+
 constexpr u32 INVALID_BRANCH_TARGET = 0xFFFFFFFF;
 
 static u32 EvaluateBranchTarget(UGeckoInstruction instr, u32 pc)
@@ -754,6 +757,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
   bool found_call = false;
   size_t caller = 0;
   u32 numFollows = 0;
+  u32 numHotFollows = 0;
   u32 num_inst = 0;
 
   const bool enable_follow = SConfig::GetInstance().bJITFollowBranch;
@@ -783,6 +787,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
     SetInstructionStats(block, &code[i], opinfo, static_cast<u32>(i));
 
     bool follow = false;
+    bool follow_hot = false;
 
     bool conditional_continue = false;
 
@@ -833,6 +838,16 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
           code[caller].skipLRStack = true;
         }
       }
+      else if (inst.OPCD == 16 && !inst.LK && block_size > 1 &&
+               HasOption(OPTION_HOT_BRANCH_FOLLOW) && m_hot_branches &&
+               numHotFollows < HOT_BRANCH_FOLLOWING_THRESHOLD &&
+               code[i].branchTo != block->m_address &&
+               m_hot_branches->find(code[i].address) != m_hot_branches->end())
+      {
+        // Conditional bcx which the JIT has seen being taken much more often than not.
+        // Continue the block at the branch target and leave it on the fall-through path instead.
+        follow_hot = true;
+      }
       else if (inst.OPCD == 31 && inst.SUBOP10 == 467)
       {
         // mtspr, skip CALL/RET merging as LR is overwritten.
@@ -877,7 +892,16 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
     code[i].branchIsIdleLoop =
         code[i].branchTo == block->m_address && IsBusyWaitLoop(block, code, i);
 
-    if (follow && numFollows < BRANCH_FOLLOWING_THRESHOLD)
+    if (follow_hot)
+    {
+      // Follow the hot conditional branch. The fall-through path becomes a side exit, so we can't
+      // guarantee to get the matching CALL/RET pair anymore.
+      numHotFollows++;
+      code[i].branchIsFollowed = true;
+      found_call = false;
+      address = code[i].branchTo;
+    }
+    else if (follow && numFollows < BRANCH_FOLLOWING_THRESHOLD)
     {
       // Follow the unconditional branch.
       numFollows++;
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <set>
+#include <unordered_set>
 #include <vector>
 
 #include "Common/BitSet.h"
@@ -35,6 +36,7 @@ struct CodeOp  // 16B
   bool isBranchTarget;
   bool branchUsesCtr;
   bool branchIsIdleLoop;
+  bool branchIsFollowed;  // conditional branch whose taken path continues the block
   bool wantsCR0;
   bool wantsCR1;
   bool wantsFPRF;
@@ -195,12 +197,21 @@ public:
 
     // Reorder cror instructions next to their associated fcmp.
     OPTION_CROR_MERGE = (1 << 6),
+
+    // Follow the taken path of conditional branches which have been reported as hot through
+    // SetHotBranches, forming a trace with a side exit for the fall-through path.
+    // Requires JIT support to be enabled.
+    OPTION_HOT_BRANCH_FOLLOW = (1 << 7),
   };
 
   // Option setting/getting
   void SetOption(AnalystOption option) { m_options |= option; }
   void ClearOption(AnalystOption option) { m_options &= ~(option); }
   bool HasOption(AnalystOption option) const { return !!(m_options & option); }
+  void SetHotBranches(const std::unordered_set<u32>* hot_branches)
+  {
+    m_hot_branches = hot_branches;
+  }
   u32 Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std::size_t block_size);
 
 private:
@@ -218,6 +229,7 @@ private:
 
   // Options
   u32 m_options = 0;
+  const std::unordered_set<u32>* m_hot_branches = nullptr;
 };
 
 void LogFunctionCall(u32 addr);
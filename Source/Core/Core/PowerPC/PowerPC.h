@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <iosfwd>
 #include <tuple>
@@ -48,6 +49,10 @@ constexpr size_t TLB_SIZE = 128;
 constexpr size_t NUM_TLBS = 2;
 constexpr size_t TLB_WAYS = 2;
 
+// One entry per 4 KiB effective page.
+constexpr size_t SOFTWARE_TLB_SIZE = 0x100000;
+constexpr u64 SOFTWARE_TLB_WRITABLE = 1;
+
 struct TLBEntry
 {
   static constexpr u32 INVALID_TAG = 0xffffffff;
@@ -157,6 +162,13 @@ struct PowerPCState
 
   InstructionCache iCache;
 
+  // Pages of the data TLB which are backed by RAM, indexed by effective page number, for use by
+  // the JIT. Each entry is the host address of the page minus its effective address, ORed with
+  // SOFTWARE_TLB_WRITABLE if the page can be written to directly, or 0 if the page has to go
+  // through the MMU code. Kept at the end of the struct so that it doesn't push other members
+  // out of the one-byte displacement range.
+  std::array<u64, SOFTWARE_TLB_SIZE> software_tlb;
+
   void UpdateCR1()
   {
     cr.SetField(1, (fpscr.FX << 3) | (fpscr.FEX << 2) | (fpscr.VX << 1) | fpscr.OX);
@@ -3,22 +3,28 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cinttypes>
 #include <cstddef>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
 #include "Common/CDUtils.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/Logging/Log.h"
 
 #include "DiscIO/Blob.h"
 #include "DiscIO/CISOBlob.h"
 #include "DiscIO/CompressedBlob.h"
+#include "DiscIO/DCZBlob.h"
 #include "DiscIO/DirectoryBlob.h"
 #include "DiscIO/DriveBlob.h"
 #include "DiscIO/FileBlob.h"
+#include "DiscIO/SharedChunkCache.h"
 #include "DiscIO/TGCBlob.h"
 #include "DiscIO/WbfsBlob.h"
 
@@ -45,6 +51,15 @@ SectorReader::~SectorReader()
 {
 }
 
+void SectorReader::EnableSharedCache(const Common::SHA1::Digest& image_hash)
+{
+  m_shared_cache = SharedChunkCache::GetGlobal(m_chunk_blocks * m_block_size);
+
+  std::memcpy(&m_image_id, image_hash.data(), sizeof(m_image_id));
+  // Readers with different chunk sizes must not share entries
+  m_image_id ^= m_chunk_blocks * m_block_size;
+}
+
 const SectorReader::Cache* SectorReader::FindCacheLine(u64 block_num)
 {
   auto itr = std::find_if(m_cache.begin(), m_cache.end(),
@@ -76,16 +91,34 @@ SectorReader::Cache* SectorReader::GetEmptyCacheLine()
 const SectorReader::Cache* SectorReader::GetCacheLine(u64 block_num)
 {
   if (auto entry = FindCacheLine(block_num))
+  {
+    m_stats.hits++;
     return entry;
+  }
 
   // Cache miss. Fault in the missing entry.
   Cache* cache = GetEmptyCacheLine();
   // We only read aligned chunks, this avoids duplicate overlapping entries.
   u64 chunk_idx = block_num / m_chunk_blocks;
-  u32 blocks_read = ReadChunk(cache->data.data(), chunk_idx);
-  if (!blocks_read)
-    return nullptr;
-  cache->Fill(chunk_idx * m_chunk_blocks, blocks_read);
+  if (TakePrefetchedChunk(chunk_idx, cache))
+  {
+    m_stats.prefetch_hits++;
+  }
+  else
+  {
+    m_stats.misses++;
+    u32 blocks_read;
+    {
+      std::lock_guard<std::mutex> lk(m_read_mutex);
+      blocks_read = ReadChunk(cache->data.data(), chunk_idx);
+    }
+    if (!blocks_read)
+      return nullptr;
+    cache->Fill(chunk_idx * m_chunk_blocks, blocks_read);
+  }
+
+  if (m_prefetching_enabled)
+    UpdatePrefetching(chunk_idx);
 
   // Secondary check for out-of-bounds read.
   // If we got less than m_chunk_blocks, we may still have missed.
@@ -147,11 +180,25 @@ u32 SectorReader::ReadChunk(u8* buffer, u64 chunk_num)
   if (end_block)
     cnt_blocks = static_cast<u32>(std::min<u64>(m_chunk_blocks, end_block - block_num));
 
+  const u32 chunk_size = m_chunk_blocks * m_block_size;
+  if (m_shared_cache && end_block)
+  {
+    // Another instance may already have decompressed this chunk
+    if (m_shared_cache->Lookup(m_image_id, chunk_num, buffer, chunk_size) ==
+        cnt_blocks * m_block_size)
+    {
+      std::fill(buffer + cnt_blocks * m_block_size, buffer + chunk_size, 0u);
+      return cnt_blocks;
+    }
+  }
+
   if (ReadMultipleAlignedBlocks(block_num, cnt_blocks, buffer))
   {
+    if (m_shared_cache && end_block)
+      m_shared_cache->Store(m_image_id, chunk_num, buffer, cnt_blocks * m_block_size);
     if (cnt_blocks < m_chunk_blocks)
     {
-      std::fill(buffer + cnt_blocks * m_block_size, buffer + m_chunk_blocks * m_block_size, 0u);
+      std::fill(buffer + cnt_blocks * m_block_size, buffer + chunk_size, 0u);
     }
     return cnt_blocks;
   }
@@ -174,6 +221,154 @@ u32 SectorReader::ReadChunk(u8* buffer, u64 chunk_num)
   return 0;
 }
 
+void SectorReader::EnablePrefetching()
+{
+  m_prefetching_enabled = true;
+}
+
+void SectorReader::StopPrefetching()
+{
+  m_prefetching_enabled = false;
+  // Finishes the chunks that are already queued
+  m_prefetch_thread.reset();
+
+  for (PrefetchSlot& slot : m_prefetch_slots)
+  {
+    if (slot.state == PrefetchSlot::State::Ready)
+      m_stats.prefetches_wasted++;
+    slot.state = PrefetchSlot::State::Free;
+  }
+
+  if (m_stats.hits != 0 || m_stats.misses != 0 || m_stats.prefetches != 0)
+  {
+    INFO_LOG(DISCIO,
+             "Sector cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " of %" PRIu64
+             " prefetched chunks used, %" PRIu64 " wasted",
+             m_stats.hits, m_stats.misses, m_stats.prefetch_hits, m_stats.prefetches,
+             m_stats.prefetches_wasted);
+  }
+}
+
+bool SectorReader::IsChunkCached(u64 chunk_idx) const
+{
+  return std::any_of(m_cache.begin(), m_cache.end(), [&](const Cache& line) {
+    return line.num_blocks != 0 && line.block_idx == chunk_idx * m_chunk_blocks;
+  });
+}
+
+bool SectorReader::TakePrefetchedChunk(u64 chunk_idx, Cache* cache)
+{
+  if (!m_prefetch_thread)
+    return false;
+
+  std::unique_lock<std::mutex> lk(m_prefetch_mutex);
+  auto slot = std::find_if(
+      m_prefetch_slots.begin(), m_prefetch_slots.end(), [&](const PrefetchSlot& s) {
+        return s.state != PrefetchSlot::State::Free && s.chunk_idx == chunk_idx;
+      });
+  if (slot == m_prefetch_slots.end())
+    return false;
+
+  m_prefetch_cv.wait(lk, [&] { return slot->state == PrefetchSlot::State::Ready; });
+  slot->state = PrefetchSlot::State::Free;
+  if (!slot->num_blocks)
+    return false;
+
+  // Both buffers have the size of a chunk, so they can simply trade places.
+  std::swap(cache->data, slot->data);
+  cache->Fill(chunk_idx * m_chunk_blocks, slot->num_blocks);
+  return true;
+}
+
+void SectorReader::UpdatePrefetching(u64 chunk_idx)
+{
+  if (chunk_idx == m_last_missed_chunk + 1)
+  {
+    m_sequential_count++;
+  }
+  else if (chunk_idx != m_last_missed_chunk)
+  {
+    m_sequential_count = 0;
+    m_prefetch_depth = 0;
+  }
+  m_last_missed_chunk = chunk_idx;
+
+  if (m_sequential_count < SEQUENTIAL_THRESHOLD)
+    return;
+  m_prefetch_depth = std::min(m_prefetch_depth + 1, MAX_PREFETCH_CHUNKS);
+
+  const u64 chunk_size = static_cast<u64>(m_chunk_blocks) * m_block_size;
+  const u64 end_chunk = (GetDataSize() + chunk_size - 1) / chunk_size;
+
+  std::lock_guard<std::mutex> lk(m_prefetch_mutex);
+  bool wasted = false;
+  for (u64 next = chunk_idx + 1; next <= chunk_idx + m_prefetch_depth && next < end_chunk; ++next)
+  {
+    if (IsChunkCached(next))
+      continue;
+
+    PrefetchSlot* free_slot = nullptr;
+    bool already_queued = false;
+    for (PrefetchSlot& slot : m_prefetch_slots)
+    {
+      if (slot.state != PrefetchSlot::State::Free && slot.chunk_idx == next)
+      {
+        already_queued = true;
+        break;
+      }
+
+      // Chunks that the reads have moved past without using them can be thrown away
+      const bool stale =
+          slot.state == PrefetchSlot::State::Ready &&
+          (slot.chunk_idx <= chunk_idx || slot.chunk_idx > chunk_idx + MAX_PREFETCH_CHUNKS);
+      if (!free_slot && (slot.state == PrefetchSlot::State::Free || stale))
+        free_slot = &slot;
+    }
+    if (already_queued)
+      continue;
+    if (!free_slot)
+      break;
+
+    if (free_slot->state == PrefetchSlot::State::Ready)
+    {
+      m_stats.prefetches_wasted++;
+      wasted = true;
+    }
+
+    free_slot->state = PrefetchSlot::State::Queued;
+    free_slot->chunk_idx = next;
+    free_slot->data.resize(chunk_size);
+    m_stats.prefetches++;
+
+    if (!m_prefetch_thread)
+    {
+      m_prefetch_thread = std::make_unique<Common::WorkQueueThread<PrefetchSlot*>>(
+          [this](PrefetchSlot* slot) { PrefetchChunk(slot); });
+    }
+    m_prefetch_thread->EmplaceItem(free_slot);
+  }
+
+  if (wasted)
+    m_prefetch_depth = std::max(m_prefetch_depth / 2, 1U);
+}
+
+void SectorReader::PrefetchChunk(PrefetchSlot* slot)
+{
+  // Nothing else touches a slot while it's queued, so it can be read from without locking
+  u32 blocks_read;
+  {
+    std::lock_guard<std::mutex> lk(m_read_mutex);
+    blocks_read = ReadChunk(slot->data.data(), slot->chunk_idx);
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_prefetch_mutex);
+    slot->num_blocks = blocks_read;
+    slot->state = PrefetchSlot::State::Ready;
+  }
+  m_prefetch_cv.notify_all();
+}
+
 std::unique_ptr<BlobReader> CreateBlobReader(const std::string& filename)
 {
   if (Common::IsCDROMDevice(filename))
@@ -198,6 +393,8 @@ std::unique_ptr<BlobReader> CreateBlobReader(const std::string& filename)
     return CISOFileReader::Create(std::move(file));
   case GCZ_MAGIC:
     return CompressedBlobReader::Create(std::move(file), filename);
+  case DCZ_MAGIC:
+    return DCZFileReader::Create(std::move(file), filename);
   case TGC_MAGIC:
     return TGCFileReader::Create(std::move(file));
   case WBFS_MAGIC:
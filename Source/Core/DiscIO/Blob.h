@@ -15,16 +15,22 @@
 // automatically do the right thing.
 
 #include <array>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/Swap.h"
+#include "Common/WorkQueueThread.h"
 
 namespace DiscIO
 {
+class SharedChunkCache;
+
 // Increment CACHE_REVISION (GameFileCache.cpp) if the enum below is modified
 enum class BlobType
 {
@@ -34,7 +40,8 @@ enum class BlobType
   GCZ,
   CISO,
   WBFS,
-  TGC
+  TGC,
+  DCZ
 };
 
 class BlobReader
@@ -57,6 +64,10 @@ public:
     return Common::FromBigEndian(temp);
   }
 
+  // Returns a pointer to the data at the given offset if all of it is memory-mapped, and nullptr
+  // otherwise. The pointer stays valid until the reader is destroyed. Thread-safe.
+  virtual const u8* GetMappedData(u64 offset, u64 size) const { return nullptr; }
+
   virtual bool SupportsReadWiiDecrypted() const { return false; }
   virtual bool ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_offset)
   {
@@ -78,6 +89,24 @@ public:
   bool Read(u64 offset, u64 size, u8* out_ptr) override;
 
 protected:
+  // Only meant for tuning the cache. They are logged when prefetching stops.
+  struct CacheStats
+  {
+    // Reads that were served by the cache
+    u64 hits = 0;
+    // Chunks that had to be read when they were needed
+    u64 misses = 0;
+    // Chunks that were needed after having been read ahead (possibly still being read)
+    u64 prefetch_hits = 0;
+    // Chunks that were read ahead
+    u64 prefetches = 0;
+    // Chunks that were read ahead but thrown away without being used
+    u64 prefetches_wasted = 0;
+  };
+
+  // Like Read, this must not be called from other threads.
+  const CacheStats& GetCacheStats() const { return m_stats; }
+
   void SetSectorSize(int blocksize);
   int GetSectorSize() const { return m_block_size; }
   // Set the chunk size -> the number of blocks to read at a time.
@@ -95,6 +124,20 @@ protected:
   // overridden in derived classes where possible.
   virtual bool ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr);
 
+  // Lets chunks be read ahead on a worker thread once sequential reads are detected, so that
+  // e.g. decompression can happen before the data is needed. GetBlock and
+  // ReadMultipleAlignedBlocks are then called from the worker thread too. A derived class that
+  // enables this must call StopPrefetching in its destructor, and must hold the lock returned
+  // by LockReads while doing anything else that touches the state those functions use.
+  void EnablePrefetching();
+  void StopPrefetching();
+  std::unique_lock<std::mutex> LockReads() { return std::unique_lock<std::mutex>(m_read_mutex); }
+
+  // Lets chunks be shared with other instances of Dolphin through the global SharedChunkCache,
+  // if there is one. image_hash must identify the contents of the image, e.g. by hashing its
+  // headers. Must be called after the sector and chunk sizes have been set.
+  void EnableSharedCache(const Common::SHA1::Digest& image_hash);
+
 private:
   struct Cache
   {
@@ -149,10 +192,59 @@ private:
   // evenly divisible into chunks). Returns zero if it fails.
   u32 ReadChunk(u8* buffer, u64 chunk_num);
 
+  // A chunk that was (or is being) read ahead. Only the worker thread may touch data while the
+  // state is Queued.
+  struct PrefetchSlot
+  {
+    enum class State
+    {
+      Free,
+      Queued,
+      Ready,
+    };
+
+    std::vector<u8> data;
+    u64 chunk_idx = 0;
+    u32 num_blocks = 0;
+    State state = State::Free;
+  };
+
+  // Moves a prefetched chunk into the given cache line, waiting for it to be read if needed.
+  // Returns false if the chunk wasn't prefetched or couldn't be read.
+  bool TakePrefetchedChunk(u64 chunk_idx, Cache* cache);
+  // Called on every cache miss to detect sequential reads and queue the chunks after chunk_idx.
+  void UpdatePrefetching(u64 chunk_idx);
+  void PrefetchChunk(PrefetchSlot* slot);
+  bool IsChunkCached(u64 chunk_idx) const;
+
   static constexpr int CACHE_LINES = 32;
+  // How many chunks can be read ahead at most
+  static constexpr u32 MAX_PREFETCH_CHUNKS = 8;
+  // How many consecutive chunks have to be read before reading ahead starts
+  static constexpr u32 SEQUENTIAL_THRESHOLD = 2;
+
   u32 m_block_size = 0;    // Bytes in a sector/block
   u32 m_chunk_blocks = 1;  // Number of sectors/blocks in a chunk
   std::array<Cache, CACHE_LINES> m_cache;
+  CacheStats m_stats;
+
+  bool m_prefetching_enabled = false;
+  u64 m_last_missed_chunk = 0;
+  u32 m_sequential_count = 0;
+  // Grows while prefetched chunks get used and shrinks when they get wasted
+  u32 m_prefetch_depth = 0;
+
+  // Held while calling GetBlock or ReadMultipleAlignedBlocks
+  std::mutex m_read_mutex;
+  // Guards the state of the prefetch slots
+  std::mutex m_prefetch_mutex;
+  std::condition_variable m_prefetch_cv;
+  std::array<PrefetchSlot, MAX_PREFETCH_CHUNKS> m_prefetch_slots;
+  // Only started once there's something to prefetch
+  std::unique_ptr<Common::WorkQueueThread<PrefetchSlot*>> m_prefetch_thread;
+
+  std::shared_ptr<SharedChunkCache> m_shared_cache;
+  u64 m_image_id = 0;
 };
 
 // Factory function - examines the path to choose the right type of BlobReader, and returns one.
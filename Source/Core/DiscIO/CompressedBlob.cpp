@@ -18,6 +18,7 @@
 #include <zlib.h>
 
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
@@ -26,7 +27,10 @@
 #include "Common/StringUtil.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
+#include "DiscIO/DCZBlob.h"
 #include "DiscIO/DiscScrubber.h"
+#include "DiscIO/SharedChunkCache.h"
+#include "DiscIO/StreamPipeline.h"
 #include "DiscIO/Volume.h"
 
 namespace DiscIO
@@ -57,6 +61,19 @@ CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string&
   // I still add some safety margin.
   const u32 zlib_buffer_size = m_header.block_size + 64;
   m_zlib_buffer.resize(zlib_buffer_size);
+
+  EnablePrefetching();
+
+  if (SharedChunkCache::IsGlobalEnabled())
+  {
+    // The block pointers and the hashes of the blocks identify the contents of the image
+    auto context = Common::SHA1::CreateContext();
+    context->Update(reinterpret_cast<const u8*>(&m_header), sizeof(m_header));
+    context->Update(reinterpret_cast<const u8*>(m_block_pointers.data()),
+                    m_block_pointers.size() * sizeof(u64));
+    context->Update(reinterpret_cast<const u8*>(m_hashes.data()), m_hashes.size() * sizeof(u32));
+    EnableSharedCache(context->Finish());
+  }
 }
 
 std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile file,
@@ -71,6 +88,7 @@ std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile
 
 CompressedBlobReader::~CompressedBlobReader()
 {
+  StopPrefetching();
 }
 
 // IMPORTANT: Calling this function invalidates all earlier pointers gotten from this function.
@@ -153,6 +171,59 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
   return true;
 }
 
+namespace
+{
+class GCZBlockCompressor final : public ChunkTransform
+{
+public:
+  explicit GCZBlockCompressor(int block_size) : m_block_size(block_size) {}
+  ~GCZBlockCompressor() override { deflateEnd(&m_z); }
+
+  static std::unique_ptr<ChunkTransform> Create(int block_size)
+  {
+    auto compressor = std::make_unique<GCZBlockCompressor>(block_size);
+    if (deflateInit(&compressor->m_z, 9) != Z_OK)
+      return nullptr;
+    return compressor;
+  }
+
+  bool Transform(PipelineChunk* chunk) override
+  {
+    if (deflateReset(&m_z) != Z_OK)
+      return false;
+
+    chunk->out_buf.resize(m_block_size);
+    m_z.next_in = chunk->in_buf.data();
+    m_z.avail_in = m_block_size;
+    m_z.next_out = chunk->out_buf.data();
+    m_z.avail_out = m_block_size;
+
+    int status = deflate(&m_z, Z_FINISH);
+    int comp_size = m_block_size - m_z.avail_out;
+
+    if ((status != Z_STREAM_END) || (m_z.avail_out < 10))
+    {
+      // let's store uncompressed
+      chunk->write_size = m_block_size;
+      chunk->stored = true;
+    }
+    else
+    {
+      // let's store compressed
+      chunk->write_size = comp_size;
+      chunk->stored = false;
+    }
+
+    chunk->hash = Common::HashAdler32(chunk->GetOutput(), chunk->write_size);
+    return true;
+  }
+
+private:
+  const int m_block_size;
+  z_stream m_z = {};
+};
+}  // namespace
+
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
                         u32 sub_type, int block_size, CompressCB callback, void* arg)
 {
@@ -196,10 +267,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     scrubbing = true;
   }
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
-    return false;
-
   callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
   CompressedBlobHeader header;
@@ -213,8 +280,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   std::vector<u64> offsets(header.num_blocks);
   std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
 
   // seek past the header (we will write it at the end)
   outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -225,33 +290,13 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   // Now we are ready to write compressed data!
   u64 position = 0;
-  int num_compressed = 0;
-  int num_stored = 0;
   int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
-  bool success = true;
-
-  for (u32 i = 0; i < header.num_blocks; i++)
-  {
-    if (i % progress_monitor == 0)
-    {
-      const u64 inpos = infile.Tell();
-      int ratio = 0;
-      if (inpos != 0)
-        ratio = (int)(100 * position / inpos);
-
-      std::string temp =
-          StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
-                           header.num_blocks, ratio);
-      bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
-      if (was_cancelled)
-      {
-        success = false;
-        break;
-      }
-    }
-
-    offsets[i] = position;
 
+  StreamPipeline pipeline;
+  pipeline.thread_name = "GCZ Compression";
+  pipeline.read = [&](PipelineChunk* chunk) {
+    std::vector<u8>& in_buf = chunk->in_buf;
+    in_buf.resize(block_size);
     size_t read_bytes;
     if (scrubbing)
       read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
@@ -259,56 +304,49 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
       infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
     if (read_bytes < header.block_size)
       std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
-
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
-
-    if (retval != Z_OK)
-    {
-      ERROR_LOG(DISCIO, "Deflate failed");
-      success = false;
-      break;
-    }
-
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
-
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
-    {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-      // let's store uncompressed
-      write_buf = in_buf.data();
+    return true;
+  };
+  pipeline.transform = [block_size] { return GCZBlockCompressor::Create(block_size); };
+  pipeline.progress = [&](u64 i, u64 num_blocks) {
+    if (i % progress_monitor != 0)
+      return true;
+
+    const u64 inpos = i * block_size;
+    int ratio = 0;
+    if (inpos != 0)
+      ratio = (int)(100 * position / inpos);
+
+    std::string temp = StringFromFormat(
+        GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), (int)i, (int)num_blocks,
+        ratio);
+    return callback(temp, (float)i / (float)num_blocks, arg);
+  };
+  pipeline.write = [&](const PipelineChunk& chunk) {
+    const u64 i = chunk.index;
+    offsets[i] = position;
+    if (chunk.stored)
       offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
-    }
-    else
-    {
-      // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
-    }
 
-    if (!outfile.WriteBytes(write_buf, write_size))
-    {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
-      break;
-    }
+    if (!outfile.WriteBytes(chunk.GetOutput(), chunk.write_size))
+      return false;
 
-    position += write_size;
+    position += chunk.write_size;
+    hashes[i] = chunk.hash;
+    return true;
+  };
 
-    hashes[i] = Common::HashAdler32(write_buf, write_size);
+  const StreamPipeline::Result result = pipeline.Run(header.num_blocks);
+  if (result == StreamPipeline::Result::TransformFailed)
+  {
+    ERROR_LOG(DISCIO, "Deflate failed");
   }
+  else if (result == StreamPipeline::Result::WriteFailed)
+  {
+    PanicAlertT("Failed to write the output file \"%s\".\n"
+                "Check that you have enough space available on the target drive.",
+                outfile_path.c_str());
+  }
+  const bool success = result == StreamPipeline::Result::Success;
 
   header.compressed_data_size = position;
 
@@ -327,9 +365,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     outfile.WriteArray(hashes.data(), header.num_blocks);
   }
 
-  // Cleanup
-  deflateEnd(&z);
-
   if (success)
   {
     callback(GetStringT("Done compressing disc image."), 1.0f, arg);
@@ -340,21 +375,25 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 bool DecompressBlobToFile(const std::string& infile_path, const std::string& outfile_path,
                           CompressCB callback, void* arg)
 {
-  std::unique_ptr<CompressedBlobReader> reader;
+  const std::unique_ptr<BlobReader> reader = CreateBlobReader(infile_path);
+  if (!reader)
   {
-    File::IOFile infile(infile_path, "rb");
-    if (!IsGCZBlob(infile))
-    {
-      PanicAlertT("File not compressed");
-      return false;
-    }
-
-    reader = CompressedBlobReader::Create(std::move(infile), infile_path);
+    PanicAlertT("Failed to open the input file \"%s\".", infile_path.c_str());
+    return false;
   }
 
-  if (!reader)
+  u64 block_size;
+  if (reader->GetBlobType() == BlobType::GCZ)
   {
-    PanicAlertT("Failed to open the input file \"%s\".", infile_path.c_str());
+    block_size = static_cast<CompressedBlobReader*>(reader.get())->GetHeader().block_size;
+  }
+  else if (reader->GetBlobType() == BlobType::DCZ)
+  {
+    block_size = static_cast<DCZFileReader*>(reader.get())->GetHeader().chunk_size;
+  }
+  else
+  {
+    PanicAlertT("File not compressed");
     return false;
   }
 
@@ -368,37 +407,41 @@ bool DecompressBlobToFile(const std::string& infile_path, const std::string& out
     return false;
   }
 
-  const CompressedBlobHeader& header = reader->GetHeader();
-  static const size_t BUFFER_BLOCKS = 32;
-  size_t buffer_size = header.block_size * BUFFER_BLOCKS;
-  size_t last_buffer_size = header.block_size * (header.num_blocks % BUFFER_BLOCKS);
-  std::vector<u8> buffer(buffer_size);
-  u32 num_buffers = (header.num_blocks + BUFFER_BLOCKS - 1) / BUFFER_BLOCKS;
-  int progress_monitor = std::max<int>(1, num_buffers / 100);
-  bool success = true;
-
-  for (u64 i = 0; i < num_buffers; i++)
+  // Whole blocks, so that each one is only decompressed once
+  static const u64 BUFFER_SIZE = 0x80000;
+  const u64 buffer_size = block_size * std::max<u64>(BUFFER_SIZE / block_size, 1);
+  const u64 total_size = reader->GetDataSize();
+  const u64 num_buffers = (total_size + buffer_size - 1) / buffer_size;
+  const u64 progress_monitor = std::max<u64>(1, num_buffers / 100);
+
+  // Decompressing happens on the reader thread and writing on this one
+  StreamPipeline pipeline;
+  pipeline.thread_name = "Decompression";
+  pipeline.read = [&](PipelineChunk* chunk) {
+    const u64 offset = chunk->index * buffer_size;
+    chunk->in_buf.resize(std::min(buffer_size, total_size - offset));
+    return reader->Read(offset, chunk->in_buf.size(), chunk->in_buf.data());
+  };
+  pipeline.progress = [&](u64 i, u64 num_chunks) {
+    return i % progress_monitor != 0 ||
+           callback(GetStringT("Unpacking"), (float)i / (float)num_chunks, arg);
+  };
+  pipeline.write = [&](const PipelineChunk& chunk) {
+    return outfile.WriteBytes(chunk.GetOutput(), chunk.write_size);
+  };
+
+  const StreamPipeline::Result result = pipeline.Run(num_buffers);
+  if (result == StreamPipeline::Result::ReadFailed)
   {
-    if (i % progress_monitor == 0)
-    {
-      bool was_cancelled = !callback(GetStringT("Unpacking"), (float)i / (float)num_buffers, arg);
-      if (was_cancelled)
-      {
-        success = false;
-        break;
-      }
-    }
-    const size_t sz = i == num_buffers - 1 ? last_buffer_size : buffer_size;
-    reader->Read(i * buffer_size, sz, buffer.data());
-    if (!outfile.WriteBytes(buffer.data(), sz))
-    {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
-      break;
-    }
+    PanicAlertT("Failed to read from the input file \"%s\".", infile_path.c_str());
+  }
+  else if (result == StreamPipeline::Result::WriteFailed)
+  {
+    PanicAlertT("Failed to write the output file \"%s\".\n"
+                "Check that you have enough space available on the target drive.",
+                outfile_path.c_str());
   }
+  const bool success = result == StreamPipeline::Result::Success;
 
   if (!success)
   {
@@ -406,10 +449,6 @@ bool DecompressBlobToFile(const std::string& infile_path, const std::string& out
     outfile.Close();
     File::Delete(outfile_path);
   }
-  else
-  {
-    outfile.Resize(header.data_size);
-  }
 
   return success;
 }
@@ -0,0 +1,786 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/DCZBlob.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <lzo/lzo1x.h>
+#include <zlib.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/DiscScrubber.h"
+#include "DiscIO/Enums.h"
+#include "DiscIO/SharedChunkCache.h"
+#include "DiscIO/StreamPipeline.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeWii.h"
+
+namespace DiscIO
+{
+static bool IsValidChunkSize(u32 chunk_size)
+{
+  return chunk_size >= DCZ_MIN_CHUNK_SIZE && chunk_size <= DCZ_MAX_CHUNK_SIZE &&
+         chunk_size % DCZ_MIN_CHUNK_SIZE == 0;
+}
+
+// Compressed chunks which don't save at least this much are stored as-is instead,
+// since reading them back is faster.
+static u32 GetMaxCompressedSize(u32 chunk_size)
+{
+  return chunk_size - chunk_size / 32;
+}
+
+static bool IsEncrypted(DCZChunkType type)
+{
+  return type == DCZChunkType::StoredEncrypted || type == DCZChunkType::CompressedEncrypted;
+}
+
+static u64 GetNumBlocks(const DCZWiiPartition& partition)
+{
+  return partition.data_size / VolumeWii::BLOCK_TOTAL_SIZE;
+}
+
+static u64 GetNumBlocksInGroup(const DCZWiiPartition& partition, u64 group)
+{
+  return std::min<u64>(VolumeWii::BLOCKS_PER_GROUP,
+                       GetNumBlocks(partition) - group * VolumeWii::BLOCKS_PER_GROUP);
+}
+
+DCZFileReader::DCZFileReader(File::IOFile file, const std::string& filename)
+    : m_file(std::move(file)), m_file_name(filename)
+{
+}
+
+std::unique_ptr<DCZFileReader> DCZFileReader::Create(File::IOFile file,
+                                                     const std::string& filename)
+{
+  std::unique_ptr<DCZFileReader> reader(new DCZFileReader(std::move(file), filename));
+  if (!reader->Initialize())
+    return nullptr;
+  return reader;
+}
+
+DCZFileReader::~DCZFileReader()
+{
+  StopPrefetching();
+  if (m_z_initialized)
+    inflateEnd(&m_z);
+}
+
+bool DCZFileReader::Initialize()
+{
+  m_file_size = m_file.GetSize();
+  m_file.Seek(0, SEEK_SET);
+  if (!m_file.ReadArray(&m_header, 1) || m_header.magic != DCZ_MAGIC)
+    return false;
+
+  if (m_header.version != DCZ_VERSION)
+  {
+    ERROR_LOG(DISCIO, "Unsupported DCZ version %u", m_header.version);
+    return false;
+  }
+
+  if (!IsValidChunkSize(m_header.chunk_size))
+  {
+    ERROR_LOG(DISCIO, "Invalid DCZ header");
+    return false;
+  }
+  m_num_raw_chunks = (m_header.data_size + m_header.chunk_size - 1) / m_header.chunk_size;
+  if (m_header.num_chunks < m_num_raw_chunks)
+  {
+    ERROR_LOG(DISCIO, "Invalid DCZ header");
+    return false;
+  }
+
+  switch (m_header.codec)
+  {
+  case DCZCodec::None:
+    break;
+  case DCZCodec::Zlib:
+    if (inflateInit(&m_z) != Z_OK)
+      return false;
+    m_z_initialized = true;
+    break;
+  case DCZCodec::LZO:
+    if (lzo_init() != LZO_E_OK)
+      return false;
+    break;
+  default:
+    ERROR_LOG(DISCIO, "Unknown DCZ codec %u", static_cast<u32>(m_header.codec));
+    return false;
+  }
+
+  m_partitions.resize(m_header.num_wii_partitions);
+  if (!m_file.ReadArray(m_partitions.data(), m_partitions.size()))
+    return false;
+  for (const DCZWiiPartition& partition : m_partitions)
+  {
+    const u64 num_groups =
+        (GetNumBlocks(partition) + VolumeWii::BLOCKS_PER_GROUP - 1) / VolumeWii::BLOCKS_PER_GROUP;
+    if (partition.data_size % VolumeWii::BLOCK_TOTAL_SIZE != 0 ||
+        partition.data_offset > m_header.data_size ||
+        partition.data_size > m_header.data_size - partition.data_offset ||
+        partition.first_chunk < m_num_raw_chunks || partition.num_chunks != num_groups ||
+        partition.num_chunks > m_header.num_chunks - partition.first_chunk)
+    {
+      ERROR_LOG(DISCIO, "Invalid DCZ partition at 0x%" PRIx64, partition.partition_offset);
+      return false;
+    }
+  }
+
+  m_chunks.resize(m_header.num_chunks);
+  if (!m_file.ReadArray(m_chunks.data(), m_chunks.size()))
+    return false;
+  for (u64 i = 0; i < m_chunks.size(); ++i)
+  {
+    // The sizes are used to size the read buffers, so they must be checked before any reads
+    const DCZChunk& chunk = m_chunks[i];
+    // The chunks after the raw ones each hold a group of a Wii partition
+    const u32 raw_size = i < m_num_raw_chunks ? m_header.chunk_size :
+                                                static_cast<u32>(VolumeWii::GROUP_TOTAL_SIZE);
+    bool valid;
+    switch (chunk.type)
+    {
+    case DCZChunkType::Zero:
+      valid = true;
+      break;
+    case DCZChunkType::Stored:
+    case DCZChunkType::StoredEncrypted:
+      valid = chunk.size <= raw_size;
+      break;
+    case DCZChunkType::Compressed:
+    case DCZChunkType::CompressedEncrypted:
+      valid = chunk.size <= GetMaxCompressedSize(raw_size);
+      break;
+    default:
+      valid = false;
+      break;
+    }
+    if (!valid || (chunk.type != DCZChunkType::Zero &&
+                   (chunk.offset > m_file_size || chunk.size > m_file_size - chunk.offset)))
+    {
+      ERROR_LOG(DISCIO, "Invalid DCZ chunk %" PRIu64, i);
+      return false;
+    }
+  }
+
+  SetSectorSize(m_header.chunk_size);
+  EnablePrefetching();
+
+  if (SharedChunkCache::IsGlobalEnabled())
+  {
+    // DCZ has no hashes of the chunks, but the compressed sizes are just as unlikely to match
+    // for different images
+    auto context = Common::SHA1::CreateContext();
+    context->Update(reinterpret_cast<const u8*>(&m_header), sizeof(m_header));
+    context->Update(reinterpret_cast<const u8*>(m_partitions.data()),
+                    m_partitions.size() * sizeof(DCZWiiPartition));
+    context->Update(reinterpret_cast<const u8*>(m_chunks.data()),
+                    m_chunks.size() * sizeof(DCZChunk));
+    EnableSharedCache(context->Finish());
+  }
+  return true;
+}
+
+bool DCZFileReader::GetBlock(u64 block_num, u8* out_ptr)
+{
+  if (block_num >= m_num_raw_chunks || !ReadChunk(block_num, out_ptr, m_header.chunk_size))
+    return false;
+
+  // The raw chunks don't contain the partition data, so fill it in by encrypting the groups.
+  const u64 chunk_start = block_num * m_header.chunk_size;
+  const u64 chunk_end = chunk_start + m_header.chunk_size;
+  for (const DCZWiiPartition& partition : m_partitions)
+  {
+    const u64 start = std::max(chunk_start, partition.data_offset);
+    const u64 end = std::min(chunk_end, partition.data_offset + partition.data_size);
+    for (u64 offset = start; offset < end;)
+    {
+      const u64 offset_in_data = offset - partition.data_offset;
+      const Group* group =
+          GetEncryptedGroup(partition, offset_in_data / VolumeWii::GROUP_TOTAL_SIZE);
+      if (!group)
+        return false;
+
+      const u64 offset_in_group = offset_in_data % VolumeWii::GROUP_TOTAL_SIZE;
+      const u64 size = std::min(end - offset, group->data.size() - offset_in_group);
+      std::copy_n(group->data.begin() + offset_in_group, size, out_ptr + (offset - chunk_start));
+      offset += size;
+    }
+  }
+
+  return true;
+}
+
+bool DCZFileReader::ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_offset)
+{
+  auto it = std::find_if(m_partitions.begin(), m_partitions.end(),
+                         [partition_offset](const DCZWiiPartition& partition) {
+                           return partition.partition_offset == partition_offset;
+                         });
+  if (it == m_partitions.end())
+    return false;
+
+  const u64 data_size = GetNumBlocks(*it) * VolumeWii::BLOCK_DATA_SIZE;
+  if (offset > data_size || size > data_size - offset)
+    return false;
+
+  // The group caches and the file are shared with GetBlock, which may be running on the
+  // prefetch thread
+  const auto lock = LockReads();
+
+  while (size > 0)
+  {
+    const Group* group = GetDecryptedGroup(*it, offset / VolumeWii::GROUP_DATA_SIZE);
+    if (!group)
+      return false;
+
+    const u64 offset_in_group = offset % VolumeWii::GROUP_DATA_SIZE;
+    const u64 copy_size = std::min(size, group->data.size() - offset_in_group);
+    std::copy_n(group->data.begin() + offset_in_group, copy_size, out_ptr);
+
+    offset += copy_size;
+    out_ptr += copy_size;
+    size -= copy_size;
+  }
+
+  return true;
+}
+
+const DCZFileReader::Group* DCZFileReader::GetDecryptedGroup(const DCZWiiPartition& partition,
+                                                             u64 group)
+{
+  auto it = std::find_if(m_decrypted_groups.begin(), m_decrypted_groups.end(),
+                         [&partition, group](const Group& cached) {
+                           return cached.partition == &partition && cached.index == group;
+                         });
+  if (it != m_decrypted_groups.end())
+  {
+    std::rotate(m_decrypted_groups.begin(), it, it + 1);
+    return &m_decrypted_groups.front();
+  }
+
+  // Evict the least recently used group.
+  std::rotate(m_decrypted_groups.begin(), m_decrypted_groups.end() - 1, m_decrypted_groups.end());
+  Group& result = m_decrypted_groups.front();
+  result.partition = nullptr;
+
+  const u64 num_blocks = GetNumBlocksInGroup(partition, group);
+  const u64 chunk_num = partition.first_chunk + group;
+  result.data.resize(num_blocks * VolumeWii::BLOCK_DATA_SIZE);
+  if (IsEncrypted(m_chunks[chunk_num].type))
+  {
+    const Group* encrypted = GetEncryptedGroup(partition, group);
+    if (!encrypted)
+      return nullptr;
+    VolumeWii::DecryptGroup(encrypted->data.data(), num_blocks, partition.title_key,
+                            result.data.data());
+  }
+  else if (!ReadChunk(chunk_num, result.data.data(), result.data.size()))
+  {
+    return nullptr;
+  }
+
+  result.partition = &partition;
+  result.index = group;
+  return &result;
+}
+
+const DCZFileReader::Group* DCZFileReader::GetEncryptedGroup(const DCZWiiPartition& partition,
+                                                             u64 group)
+{
+  if (m_encrypted_group.partition == &partition && m_encrypted_group.index == group)
+    return &m_encrypted_group;
+  m_encrypted_group.partition = nullptr;
+
+  const u64 num_blocks = GetNumBlocksInGroup(partition, group);
+  const u64 chunk_num = partition.first_chunk + group;
+  m_encrypted_group.data.resize(num_blocks * VolumeWii::BLOCK_TOTAL_SIZE);
+  if (IsEncrypted(m_chunks[chunk_num].type))
+  {
+    if (!ReadChunk(chunk_num, m_encrypted_group.data.data(), m_encrypted_group.data.size()))
+      return nullptr;
+  }
+  else
+  {
+    const Group* decrypted = GetDecryptedGroup(partition, group);
+    if (!decrypted)
+      return nullptr;
+    VolumeWii::EncryptGroup(decrypted->data.data(), num_blocks, partition.title_key,
+                            m_encrypted_group.data.data());
+  }
+
+  m_encrypted_group.partition = &partition;
+  m_encrypted_group.index = group;
+  return &m_encrypted_group;
+}
+
+bool DCZFileReader::ReadChunk(u64 chunk_num, u8* out_ptr, size_t size)
+{
+  const DCZChunk& chunk = m_chunks[chunk_num];
+  switch (chunk.type)
+  {
+  case DCZChunkType::Zero:
+    std::fill(out_ptr, out_ptr + size, 0);
+    return true;
+
+  case DCZChunkType::Stored:
+  case DCZChunkType::StoredEncrypted:
+    if (chunk.size != size)
+      break;
+    if (!m_file.Seek(chunk.offset, SEEK_SET) || !m_file.ReadBytes(out_ptr, chunk.size))
+    {
+      PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
+                  m_file_name.c_str());
+      m_file.Clear();
+      return false;
+    }
+    return true;
+
+  case DCZChunkType::Compressed:
+  case DCZChunkType::CompressedEncrypted:
+    m_compressed_buffer.resize(chunk.size);
+    if (!m_file.Seek(chunk.offset, SEEK_SET) ||
+        !m_file.ReadBytes(m_compressed_buffer.data(), chunk.size))
+    {
+      PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
+                  m_file_name.c_str());
+      m_file.Clear();
+      return false;
+    }
+    if (Decompress(chunk, out_ptr, size))
+      return true;
+    break;
+  }
+
+  PanicAlertT("The disc image \"%s\" is corrupt.\n"
+              "Chunk %" PRIu64 " could not be read.",
+              m_file_name.c_str(), chunk_num);
+  return false;
+}
+
+bool DCZFileReader::Decompress(const DCZChunk& chunk, u8* out_ptr, size_t size)
+{
+  switch (m_header.codec)
+  {
+  case DCZCodec::Zlib:
+  {
+    if (inflateReset(&m_z) != Z_OK)
+      return false;
+    m_z.next_in = m_compressed_buffer.data();
+    m_z.avail_in = chunk.size;
+    m_z.next_out = out_ptr;
+    m_z.avail_out = static_cast<uInt>(size);
+    return inflate(&m_z, Z_FINISH) == Z_STREAM_END && m_z.avail_out == 0;
+  }
+
+  case DCZCodec::LZO:
+  {
+    lzo_uint out_size = size;
+    return lzo1x_decompress_safe(m_compressed_buffer.data(), chunk.size, out_ptr, &out_size,
+                                 nullptr) == LZO_E_OK &&
+           out_size == size;
+  }
+
+  default:
+    return false;
+  }
+}
+
+namespace
+{
+class DCZBlockCompressor final : public ChunkTransform
+{
+public:
+  DCZBlockCompressor(DCZCodec codec, const std::vector<DCZWiiPartition>& partitions)
+      : m_codec(codec), m_partitions(partitions)
+  {
+  }
+
+  ~DCZBlockCompressor() override
+  {
+    if (m_codec == DCZCodec::Zlib)
+      deflateEnd(&m_z);
+  }
+
+  static std::unique_ptr<ChunkTransform> Create(DCZCodec codec, int compression_level,
+                                                 const std::vector<DCZWiiPartition>& partitions)
+  {
+    auto compressor = std::make_unique<DCZBlockCompressor>(codec, partitions);
+    switch (codec)
+    {
+    case DCZCodec::Zlib:
+      if (deflateInit(&compressor->m_z, compression_level) != Z_OK)
+        return nullptr;
+      break;
+    case DCZCodec::LZO:
+      if (lzo_init() != LZO_E_OK)
+        return nullptr;
+      compressor->m_lzo_work_memory.resize(
+          (LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t));
+      break;
+    default:
+      break;
+    }
+    return compressor;
+  }
+
+  bool Transform(PipelineChunk* chunk) override
+  {
+    DCZChunkType stored_type = DCZChunkType::Stored;
+    DCZChunkType compressed_type = DCZChunkType::Compressed;
+    if (const DCZWiiPartition* partition = FindPartition(chunk->index))
+    {
+      // Only store the group decrypted if encrypting it again gives back exactly the same data.
+      const size_t num_blocks = chunk->in_buf.size() / VolumeWii::BLOCK_TOTAL_SIZE;
+      m_decrypted.resize(num_blocks * VolumeWii::BLOCK_DATA_SIZE);
+      m_encrypted.resize(chunk->in_buf.size());
+      VolumeWii::DecryptGroup(chunk->in_buf.data(), num_blocks, partition->title_key,
+                              m_decrypted.data());
+      VolumeWii::EncryptGroup(m_decrypted.data(), num_blocks, partition->title_key,
+                              m_encrypted.data());
+      if (m_encrypted == chunk->in_buf)
+      {
+        chunk->in_buf.swap(m_decrypted);
+      }
+      else
+      {
+        stored_type = DCZChunkType::StoredEncrypted;
+        compressed_type = DCZChunkType::CompressedEncrypted;
+      }
+    }
+
+    const u8* in = chunk->in_buf.data();
+    const size_t in_size = chunk->in_buf.size();
+    if (stored_type == DCZChunkType::Stored &&
+        std::all_of(in, in + in_size, [](u8 x) { return x == 0; }))
+    {
+      chunk->type = static_cast<u32>(DCZChunkType::Zero);
+      chunk->write_size = 0;
+      chunk->stored = false;
+      return true;
+    }
+
+    size_t compressed_size;
+    switch (m_codec)
+    {
+    case DCZCodec::Zlib:
+    {
+      if (deflateReset(&m_z) != Z_OK)
+        return false;
+      chunk->out_buf.resize(in_size);
+      m_z.next_in = chunk->in_buf.data();
+      m_z.avail_in = static_cast<uInt>(in_size);
+      m_z.next_out = chunk->out_buf.data();
+      m_z.avail_out = static_cast<uInt>(in_size);
+      const int status = deflate(&m_z, Z_FINISH);
+      compressed_size = status == Z_STREAM_END ? in_size - m_z.avail_out : in_size;
+      break;
+    }
+
+    case DCZCodec::LZO:
+    {
+      // The worst case expansion documented by LZO.
+      chunk->out_buf.resize(in_size + in_size / 16 + 64 + 3);
+      lzo_uint out_size;
+      if (lzo1x_1_compress(chunk->in_buf.data(), in_size, chunk->out_buf.data(), &out_size,
+                           m_lzo_work_memory.data()) != LZO_E_OK)
+      {
+        return false;
+      }
+      compressed_size = out_size;
+      break;
+    }
+
+    default:
+      compressed_size = in_size;
+      break;
+    }
+
+    if (compressed_size > GetMaxCompressedSize(static_cast<u32>(in_size)))
+    {
+      chunk->type = static_cast<u32>(stored_type);
+      chunk->write_size = in_size;
+      chunk->stored = true;
+    }
+    else
+    {
+      chunk->type = static_cast<u32>(compressed_type);
+      chunk->write_size = compressed_size;
+      chunk->stored = false;
+    }
+    return true;
+  }
+
+private:
+  const DCZWiiPartition* FindPartition(u64 chunk_num) const
+  {
+    for (const DCZWiiPartition& partition : m_partitions)
+    {
+      if (chunk_num >= partition.first_chunk &&
+          chunk_num < partition.first_chunk + partition.num_chunks)
+      {
+        return &partition;
+      }
+    }
+    return nullptr;
+  }
+
+  const DCZCodec m_codec;
+  const std::vector<DCZWiiPartition>& m_partitions;
+  z_stream m_z = {};
+  std::vector<lzo_align_t> m_lzo_work_memory;
+  std::vector<u8> m_decrypted;
+  std::vector<u8> m_encrypted;
+};
+
+// Either all encrypted partitions can be stored decrypted or none of them, since
+// SupportsReadWiiDecrypted applies to the whole disc.
+std::vector<DCZWiiPartition> FindWiiPartitions(const Volume& volume, u64 data_size,
+                                               u32 first_chunk)
+{
+  if (volume.GetVolumeType() != Platform::WiiDisc || !volume.IsEncryptedAndHashed())
+    return {};
+
+  std::vector<DCZWiiPartition> result;
+  for (const Partition& partition : volume.GetPartitions())
+  {
+    const IOS::ES::TicketReader& ticket = volume.GetTicket(partition);
+    const std::optional<u64> data_offset =
+        volume.ReadSwappedAndShifted(partition.offset + 0x2b8, PARTITION_NONE);
+    const std::optional<u64> size =
+        volume.ReadSwappedAndShifted(partition.offset + 0x2bc, PARTITION_NONE);
+    if (!ticket.IsValid() || !data_offset || !size)
+      return {};
+
+    DCZWiiPartition entry = {};
+    entry.partition_offset = partition.offset;
+    entry.data_offset = partition.offset + *data_offset;
+    // Only whole blocks can be decrypted. Anything after them stays in the raw chunks.
+    entry.data_size = *size / VolumeWii::BLOCK_TOTAL_SIZE * VolumeWii::BLOCK_TOTAL_SIZE;
+    if (entry.data_offset > data_size || entry.data_size > data_size - entry.data_offset)
+      return {};
+    entry.title_key = ticket.GetTitleKey();
+    entry.first_chunk = first_chunk;
+    entry.num_chunks = static_cast<u32>((GetNumBlocks(entry) + VolumeWii::BLOCKS_PER_GROUP - 1) /
+                                        VolumeWii::BLOCKS_PER_GROUP);
+    first_chunk += entry.num_chunks;
+    result.push_back(entry);
+  }
+  return result;
+}
+}  // namespace
+
+bool CompressFileToDCZ(const std::string& infile_path, const std::string& outfile_path,
+                       DCZCodec codec, int compression_level, u32 chunk_size, bool scrub,
+                       CompressCB callback, void* arg)
+{
+  if (!IsValidChunkSize(chunk_size))
+  {
+    ERROR_LOG(DISCIO, "Invalid DCZ chunk size 0x%x", chunk_size);
+    return false;
+  }
+
+  std::unique_ptr<BlobReader> reader = CreateBlobReader(infile_path);
+  if (!reader)
+  {
+    PanicAlertT("Failed to open the input file \"%s\".", infile_path.c_str());
+    return false;
+  }
+
+  DCZHeader header = {};
+  header.magic = DCZ_MAGIC;
+  header.version = DCZ_VERSION;
+  header.data_size = reader->GetDataSize();
+  header.chunk_size = chunk_size;
+  header.codec = codec;
+  header.compression_level = compression_level;
+
+  const u32 num_raw_chunks = static_cast<u32>((header.data_size + chunk_size - 1) / chunk_size);
+  std::unique_ptr<Volume> volume = CreateVolumeFromFilename(infile_path);
+  const std::vector<DCZWiiPartition> partitions =
+      volume ? FindWiiPartitions(*volume, header.data_size, num_raw_chunks) :
+               std::vector<DCZWiiPartition>();
+  header.num_wii_partitions = static_cast<u32>(partitions.size());
+  header.num_chunks = partitions.empty() ?
+                          num_raw_chunks :
+                          partitions.back().first_chunk + partitions.back().num_chunks;
+
+  DiscScrubber disc_scrubber;
+  u64 scrub_end = 0;
+  if (scrub)
+  {
+    if (!volume || !disc_scrubber.SetupScrub(volume.get(), DCZ_MIN_CHUNK_SIZE))
+    {
+      PanicAlertT("\"%s\" failed to be scrubbed. Probably the image is corrupt.",
+                  infile_path.c_str());
+      return false;
+    }
+    // DiscScrubber only knows about whole clusters.
+    scrub_end = volume->GetSize() / DCZ_MIN_CHUNK_SIZE * DCZ_MIN_CHUNK_SIZE;
+  }
+  const auto scrub_range = [&](u64 offset, u8* buffer, u64 size) {
+    if (!scrub)
+      return;
+    for (u64 cluster = 0; cluster < size; cluster += DCZ_MIN_CHUNK_SIZE)
+    {
+      if (offset + cluster + DCZ_MIN_CHUNK_SIZE <= scrub_end &&
+          disc_scrubber.CanBlockBeScrubbed(offset + cluster))
+      {
+        std::fill_n(buffer + cluster, DCZ_MIN_CHUNK_SIZE, 0);
+      }
+    }
+  };
+
+  File::IOFile outfile(outfile_path, "wb");
+  if (!outfile)
+  {
+    PanicAlertT("Failed to open the output file \"%s\".\n"
+                "Check that you have permissions to write the target folder and that the media can "
+                "be written.",
+                outfile_path.c_str());
+    return false;
+  }
+
+  callback(GetStringT("Files opened, ready to compress."), 0, arg);
+
+  // Reads the input of a chunk into in_buf. Returns the number of bytes of the input file the
+  // chunk covers, or 0 on failure.
+  const auto read_chunk = [&](u32 chunk_num, std::vector<u8>& in_buf) -> u64 {
+    if (chunk_num < num_raw_chunks)
+    {
+      const u64 offset = static_cast<u64>(chunk_num) * chunk_size;
+      const u64 size = std::min<u64>(chunk_size, header.data_size - offset);
+      in_buf.resize(chunk_size);
+      if (!reader->Read(offset, size, in_buf.data()))
+        return 0;
+      std::fill(in_buf.begin() + size, in_buf.end(), 0);
+
+      // The partition data is stored in the partition chunks instead.
+      for (const DCZWiiPartition& partition : partitions)
+      {
+        const u64 start = std::max(offset, partition.data_offset);
+        const u64 end = std::min(offset + chunk_size, partition.data_offset + partition.data_size);
+        if (start < end)
+          std::fill(in_buf.begin() + (start - offset), in_buf.begin() + (end - offset), 0);
+      }
+
+      scrub_range(offset, in_buf.data(), chunk_size);
+      return size;
+    }
+
+    const DCZWiiPartition& partition = *std::find_if(
+        partitions.begin(), partitions.end(), [chunk_num](const DCZWiiPartition& p) {
+          return chunk_num >= p.first_chunk && chunk_num < p.first_chunk + p.num_chunks;
+        });
+    const u64 group = chunk_num - partition.first_chunk;
+    const u64 offset = partition.data_offset + group * VolumeWii::GROUP_TOTAL_SIZE;
+    const u64 size = GetNumBlocksInGroup(partition, group) * VolumeWii::BLOCK_TOTAL_SIZE;
+    in_buf.resize(size);
+    if (!reader->Read(offset, size, in_buf.data()))
+      return 0;
+
+    scrub_range(offset, in_buf.data(), size);
+    return size;
+  };
+
+  std::vector<DCZChunk> chunks(header.num_chunks);
+  std::vector<u64> input_sizes(header.num_chunks);
+
+  // The headers and tables are written at the end
+  u64 position = sizeof(DCZHeader) + sizeof(DCZWiiPartition) * partitions.size() +
+                 sizeof(DCZChunk) * header.num_chunks;
+  outfile.Seek(position, SEEK_SET);
+
+  u64 input_position = 0;
+  int progress_monitor = std::max<int>(1, header.num_chunks / 1000);
+
+  StreamPipeline pipeline;
+  pipeline.thread_name = "DCZ Compression";
+  pipeline.read = [&](PipelineChunk* chunk) {
+    input_sizes[chunk->index] = read_chunk(static_cast<u32>(chunk->index), chunk->in_buf);
+    return input_sizes[chunk->index] != 0;
+  };
+  pipeline.transform = [codec, compression_level, &partitions] {
+    return DCZBlockCompressor::Create(codec, compression_level, partitions);
+  };
+  pipeline.progress = [&](u64 i, u64 num_chunks) {
+    if (i % progress_monitor != 0)
+      return true;
+
+    int ratio = 0;
+    if (input_position != 0)
+      ratio = (int)(100 * position / input_position);
+
+    std::string temp = StringFromFormat(
+        GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), (int)i, (int)num_chunks,
+        ratio);
+    return callback(temp, (float)i / (float)num_chunks, arg);
+  };
+  pipeline.write = [&](const PipelineChunk& chunk) {
+    const u64 i = chunk.index;
+    chunks[i].type = static_cast<DCZChunkType>(chunk.type);
+    chunks[i].size = static_cast<u32>(chunk.write_size);
+    chunks[i].offset = chunk.write_size ? position : 0;
+
+    if (chunk.write_size && !outfile.WriteBytes(chunk.GetOutput(), chunk.write_size))
+      return false;
+
+    position += chunk.write_size;
+    input_position += input_sizes[i];
+    return true;
+  };
+
+  const StreamPipeline::Result result = pipeline.Run(header.num_chunks);
+  switch (result)
+  {
+  case StreamPipeline::Result::ReadFailed:
+    PanicAlertT("Failed to read from the input file \"%s\".", infile_path.c_str());
+    break;
+  case StreamPipeline::Result::TransformFailed:
+    ERROR_LOG(DISCIO, "Compressing a chunk failed");
+    break;
+  case StreamPipeline::Result::WriteFailed:
+    PanicAlertT("Failed to write the output file \"%s\".\n"
+                "Check that you have enough space available on the target drive.",
+                outfile_path.c_str());
+    break;
+  default:
+    break;
+  }
+  const bool success = result == StreamPipeline::Result::Success;
+
+  if (!success)
+  {
+    // Remove the incomplete output file.
+    outfile.Close();
+    File::Delete(outfile_path);
+    return false;
+  }
+
+  outfile.Seek(0, SEEK_SET);
+  outfile.WriteArray(&header, 1);
+  outfile.WriteArray(partitions.data(), partitions.size());
+  outfile.WriteArray(chunks.data(), chunks.size());
+
+  callback(GetStringT("Done compressing disc image."), 1.0f, arg);
+  return true;
+}
+
+}  // namespace DiscIO
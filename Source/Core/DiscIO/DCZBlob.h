@@ -0,0 +1,152 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// DCZ is a chunked compressed disc image format. Compared to GCZ it uses much larger chunks,
+// lets the codec be chosen per image and doesn't store chunks of zeroes (which includes data
+// removed by DiscScrubber) at all.
+//
+// The data of encrypted Wii partitions is stored decrypted and without the hash blocks, one chunk
+// per group of 64 blocks. Reads through ReadWiiDecrypted don't need any decryption or hashing,
+// and the hashes and encryption are only recomputed when the raw disc is read (e.g. when
+// converting back to an ISO). Groups that can't be reproduced bit for bit that way (e.g. because
+// of scrubbing) are kept encrypted.
+
+// File format
+// * DCZHeader
+// * DCZWiiPartition[num_wii_partitions]
+// * DCZChunk[num_chunks]: first the chunks of the raw disc, in which the data areas of the
+//   partitions read as zeroes, then the groups of each partition
+// * [Data]
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "DiscIO/Blob.h"
+
+namespace DiscIO
+{
+static constexpr u32 DCZ_MAGIC = 0x015A4344;  // "DCZ\x01" (byteswapped to little endian)
+static constexpr u32 DCZ_VERSION = 2;
+
+static constexpr u32 DCZ_MIN_CHUNK_SIZE = 0x8000;
+// Bounded by the memory used by the SectorReader cache, which holds 32 chunks.
+static constexpr u32 DCZ_MAX_CHUNK_SIZE = 0x100000;
+static constexpr u32 DCZ_DEFAULT_CHUNK_SIZE = 0x20000;
+
+enum class DCZCodec : u32
+{
+  None = 0,
+  // Smallest files.
+  Zlib = 1,
+  // Decompresses several times faster than zlib, at the cost of a worse ratio.
+  LZO = 2,
+};
+
+enum class DCZChunkType : u32
+{
+  // Not stored in the file. Reads as zeroes.
+  Zero = 0,
+  Stored = 1,
+  Compressed = 2,
+  // Only used for Wii partition groups which are kept encrypted, including the hashes.
+  StoredEncrypted = 3,
+  CompressedEncrypted = 4,
+};
+
+struct DCZHeader  // 40 bytes
+{
+  u32 magic;
+  u32 version;
+  u64 data_size;
+  u32 chunk_size;
+  u32 num_chunks;
+  DCZCodec codec;
+  u32 compression_level;
+  u32 num_wii_partitions;
+  u32 unused;
+};
+static_assert(sizeof(DCZHeader) == 40, "Wrong size for DCZHeader");
+
+struct DCZWiiPartition  // 48 bytes
+{
+  // The partition offset, as in Partition::offset.
+  u64 partition_offset;
+  // The raw offset and size of the encrypted data area.
+  u64 data_offset;
+  u64 data_size;
+  std::array<u8, 16> title_key;
+  u32 first_chunk;
+  u32 num_chunks;
+};
+static_assert(sizeof(DCZWiiPartition) == 48, "Wrong size for DCZWiiPartition");
+
+struct DCZChunk  // 16 bytes
+{
+  u64 offset;
+  u32 size;
+  DCZChunkType type;
+};
+static_assert(sizeof(DCZChunk) == 16, "Wrong size for DCZChunk");
+
+class DCZFileReader : public SectorReader
+{
+public:
+  static std::unique_ptr<DCZFileReader> Create(File::IOFile file, const std::string& filename);
+  ~DCZFileReader();
+
+  const DCZHeader& GetHeader() const { return m_header; }
+  BlobType GetBlobType() const override { return BlobType::DCZ; }
+  u64 GetRawSize() const override { return m_file_size; }
+  u64 GetDataSize() const override { return m_header.data_size; }
+  bool IsDataSizeAccurate() const override { return true; }
+  bool GetBlock(u64 block_num, u8* out_ptr) override;
+
+  bool SupportsReadWiiDecrypted() const override { return !m_partitions.empty(); }
+  bool ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_offset) override;
+
+private:
+  struct Group
+  {
+    const DCZWiiPartition* partition = nullptr;
+    u64 index = 0;
+    std::vector<u8> data;
+  };
+
+  DCZFileReader(File::IOFile file, const std::string& filename);
+  bool Initialize();
+  bool ReadChunk(u64 chunk_num, u8* out_ptr, size_t size);
+  bool Decompress(const DCZChunk& chunk, u8* out_ptr, size_t size);
+  const Group* GetDecryptedGroup(const DCZWiiPartition& partition, u64 group);
+  const Group* GetEncryptedGroup(const DCZWiiPartition& partition, u64 group);
+
+  DCZHeader m_header;
+  std::vector<DCZWiiPartition> m_partitions;
+  std::vector<DCZChunk> m_chunks;
+  u64 m_num_raw_chunks = 0;
+  // Decrypted groups, the most recently used one first.
+  std::array<Group, 2> m_decrypted_groups;
+  Group m_encrypted_group;
+  File::IOFile m_file;
+  u64 m_file_size;
+  std::vector<u8> m_compressed_buffer;
+  z_stream m_z = {};
+  bool m_z_initialized = false;
+  std::string m_file_name;
+};
+
+// Converts any image CreateBlobReader can open. If scrub is set, the data DiscScrubber finds
+// to be unused is dropped from the image. The partitions of encrypted Wii discs are stored
+// decrypted as long as that is lossless.
+bool CompressFileToDCZ(const std::string& infile_path, const std::string& outfile_path,
+                       DCZCodec codec, int compression_level, u32 chunk_size, bool scrub,
+                       CompressCB callback, void* arg);
+
+}  // namespace DiscIO
@@ -8,6 +8,7 @@
 #include <cinttypes>
 #include <locale>
 #include <optional>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
@@ -15,10 +16,15 @@
 #include "Common/StringUtil.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/Filesystem.h"
+#include "DiscIO/StreamPipeline.h"
 #include "DiscIO/Volume.h"
 
 namespace DiscIO
 {
+// Big enough that reading and writing don't get slowed down by the per-chunk overhead, and
+// a multiple of the size of a Wii group, so that reads from partitions start at a group.
+static constexpr u64 EXPORT_CHUNK_SIZE = 0x400000;
+
 std::string NameForPartitionType(u32 partition_type, bool include_prefix)
 {
   switch (partition_type)
@@ -87,24 +93,28 @@ bool ExportData(const Volume& volume, const Partition& partition, u64 offset, u6
   if (!f)
     return false;
 
-  while (size)
-  {
-    // Limit read size to 128 MB
-    const size_t read_size = static_cast<size_t>(std::min<u64>(size, 0x08000000));
-
-    std::vector<u8> buffer(read_size);
-
-    if (!volume.Read(offset, read_size, buffer.data(), partition))
-      return false;
-
-    if (!f.WriteBytes(buffer.data(), read_size))
-      return false;
-
-    size -= read_size;
-    offset += read_size;
-  }
-
-  return true;
+  // The chunks are aligned, so only the first and last ones can be smaller
+  const u64 first_chunk_size = std::min(size, EXPORT_CHUNK_SIZE - offset % EXPORT_CHUNK_SIZE);
+  const u64 num_chunks = size == 0 ? 0 :
+                                     1 + (size - first_chunk_size + EXPORT_CHUNK_SIZE - 1) /
+                                             EXPORT_CHUNK_SIZE;
+
+  // Reading (and decrypting) the next chunk happens while the previous one is being written
+  StreamPipeline pipeline;
+  pipeline.thread_name = "Export";
+  pipeline.read = [&](PipelineChunk* chunk) {
+    const u64 chunk_offset =
+        chunk->index == 0 ? 0 : first_chunk_size + (chunk->index - 1) * EXPORT_CHUNK_SIZE;
+    const u64 chunk_size = chunk->index == 0 ? first_chunk_size :
+                                               std::min(EXPORT_CHUNK_SIZE, size - chunk_offset);
+    chunk->in_buf.resize(chunk_size);
+    return volume.Read(offset + chunk_offset, chunk_size, chunk->in_buf.data(), partition);
+  };
+  pipeline.write = [&](const PipelineChunk& chunk) {
+    return f.WriteBytes(chunk.GetOutput(), chunk.write_size);
+  };
+
+  return pipeline.Run(num_chunks) == StreamPipeline::Result::Success;
 }
 
 bool ExportFile(const Volume& volume, const Partition& partition, const FileInfo* file_info,
@@ -41,6 +41,8 @@ DriveReader::DriveReader(const std::string& drive)
   // transferring bytes from the media.
   SetChunkSize(32);  // 32*2048 = 64KiB
   SetSectorSize(2048);
+  // Reading ahead hides the drive's latency when a game streams data
+  EnablePrefetching();
 #ifdef _WIN32
   auto const path = UTF8ToTStr(std::string("\\\\.\\") + drive);
   m_disc_handle = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
@@ -101,6 +103,7 @@ DriveReader::DriveReader(const std::string& drive)
 
 DriveReader::~DriveReader()
 {
+  StopPrefetching();
 #ifdef _WIN32
 #ifdef _LOCKDRIVE  // Do we want to lock the drive?
   // Unlock the disc in the CD-ROM drive.
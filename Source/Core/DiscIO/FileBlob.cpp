@@ -2,17 +2,37 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
 
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "Common/Logging/Log.h"
 #include "DiscIO/FileBlob.h"
 
 namespace DiscIO
 {
+static std::atomic<bool> s_mapping_enabled{false};
+
 PlainFileReader::PlainFileReader(File::IOFile file) : m_file(std::move(file))
 {
   m_size = m_file.GetSize();
+  MapFile();
+}
+
+PlainFileReader::~PlainFileReader()
+{
+  UnmapFile();
 }
 
 std::unique_ptr<PlainFileReader> PlainFileReader::Create(File::IOFile file)
@@ -23,8 +43,74 @@ std::unique_ptr<PlainFileReader> PlainFileReader::Create(File::IOFile file)
   return nullptr;
 }
 
+void PlainFileReader::SetMappingEnabled(bool enabled)
+{
+  s_mapping_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void PlainFileReader::MapFile()
+{
+  if (!s_mapping_enabled.load(std::memory_order_relaxed))
+    return;
+
+  if (m_size <= 0 || static_cast<u64>(m_size) > std::numeric_limits<size_t>::max())
+    return;
+
+#ifdef _WIN32
+  const HANDLE file_handle =
+      reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_file.GetHandle())));
+  const HANDLE mapping = CreateFileMapping(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping)
+  {
+    WARN_LOG(DISCIO, "Failed to map file into memory (error %lu), falling back to reads",
+             GetLastError());
+    return;
+  }
+
+  // The view keeps the mapping alive, so the handle isn't needed after this.
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!data)
+  {
+    WARN_LOG(DISCIO, "Failed to map file into memory (error %lu), falling back to reads",
+             GetLastError());
+    return;
+  }
+#else
+  void* data = mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_SHARED,
+                    fileno(m_file.GetHandle()), 0);
+  if (data == MAP_FAILED)
+  {
+    WARN_LOG(DISCIO, "Failed to map file into memory (%s), falling back to reads",
+             std::strerror(errno));
+    return;
+  }
+#endif
+
+  m_mapped_data = static_cast<const u8*>(data);
+}
+
+void PlainFileReader::UnmapFile()
+{
+  if (!m_mapped_data)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_mapped_data);
+#else
+  munmap(const_cast<u8*>(m_mapped_data), static_cast<size_t>(m_size));
+#endif
+  m_mapped_data = nullptr;
+}
+
 bool PlainFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
 {
+  if (const u8* data = GetMappedData(offset, nbytes))
+  {
+    std::memcpy(out_ptr, data, nbytes);
+    return true;
+  }
+
   if (m_file.Seek(offset, SEEK_SET) && m_file.ReadBytes(out_ptr, nbytes))
   {
     return true;
@@ -36,4 +122,15 @@ bool PlainFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
   }
 }
 
+const u8* PlainFileReader::GetMappedData(u64 offset, u64 size) const
+{
+  if (!m_mapped_data || offset > static_cast<u64>(m_size) ||
+      size > static_cast<u64>(m_size) - offset)
+  {
+    return nullptr;
+  }
+
+  return m_mapped_data + offset;
+}
+
 }  // namespace
@@ -18,18 +18,32 @@ class PlainFileReader : public BlobReader
 {
 public:
   static std::unique_ptr<PlainFileReader> Create(File::IOFile file);
+  ~PlainFileReader();
 
   BlobType GetBlobType() const override { return BlobType::PLAIN; }
   u64 GetRawSize() const override { return m_size; }
   u64 GetDataSize() const override { return m_size; }
   bool IsDataSizeAccurate() const override { return true; }
   bool Read(u64 offset, u64 nbytes, u8* out_ptr) override;
+  const u8* GetMappedData(u64 offset, u64 size) const override;
+
+  // Whether readers created from now on map their file. Off by default: if a mapped file is
+  // truncated or its drive or network share goes away, accessing the mapping crashes
+  // (SIGBUS, EXCEPTION_IN_PAGE_ERROR) instead of making the read fail.
+  static void SetMappingEnabled(bool enabled);
 
 private:
   PlainFileReader(File::IOFile file);
 
+  // Maps the whole file into memory so that reads don't need a syscall, if mapping is enabled.
+  // If this fails (for instance because the file is on a filesystem that doesn't support it),
+  // reads go through m_file instead.
+  void MapFile();
+  void UnmapFile();
+
   File::IOFile m_file;
   s64 m_size;
+  const u8* m_mapped_data = nullptr;
 };
 
 }  // namespace
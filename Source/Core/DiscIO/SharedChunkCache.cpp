@@ -0,0 +1,436 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/SharedChunkCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Common/Align.h"
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+
+namespace DiscIO
+{
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+              "The atomics in shared memory must be lock-free to work across processes");
+
+constexpr u32 CACHE_MAGIC = 0x4443434B;  // "KCCD"
+constexpr u32 CACHE_VERSION = 2;
+// Slots per set
+constexpr u32 CACHE_WAYS = 4;
+constexpr size_t SLOTS_OFFSET = 64;
+constexpr size_t DATA_ALIGNMENT = 0x1000;
+
+struct SharedChunkCache::Header
+{
+  // Written last by the process that creates the cache
+  std::atomic<u32> magic;
+  u32 version;
+  u32 slot_size;
+  u32 num_slots;
+  // Incremented for every store, for finding the oldest slot in a set
+  std::atomic<u64> stamp;
+  // The number of processes that have the cache open. Once it drops to 0 the cache is being
+  // deleted and can't be opened anymore.
+  std::atomic<u32> attached;
+};
+
+struct SharedChunkCache::Slot
+{
+  // Odd while the slot is being written
+  std::atomic<u32> sequence;
+  std::atomic<u32> size;
+  std::atomic<u64> image_id;
+  std::atomic<u64> chunk_idx;
+  std::atomic<u64> stamp;
+};
+
+static std::mutex s_global_mutex;
+static std::string s_global_name;
+static u64 s_global_size = 0;
+// By slot size
+static std::map<u32, std::shared_ptr<SharedChunkCache>> s_global_caches;
+
+static void UnmapMemory(void* memory, size_t memory_size)
+{
+#ifdef _WIN32
+  UnmapViewOfFile(memory);
+#else
+  munmap(memory, memory_size);
+#endif
+}
+
+SharedChunkCache::SharedChunkCache(void* memory, size_t memory_size, std::string system_name)
+    : m_memory(memory), m_memory_size(memory_size), m_system_name(std::move(system_name)),
+      m_header(static_cast<Header*>(memory)),
+      m_slots(reinterpret_cast<Slot*>(static_cast<u8*>(memory) + SLOTS_OFFSET)),
+      m_num_slots(m_header->num_slots), m_slot_size(m_header->slot_size)
+{
+}
+
+SharedChunkCache::~SharedChunkCache()
+{
+  const Stats stats = GetStats();
+  INFO_LOG(DISCIO, "Shared chunk cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " stores",
+           stats.hits, stats.misses, stats.stores);
+
+  if (m_header->attached.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    // Nobody can open the cache anymore, so the name can go. Windows deletes the mapping
+    // itself once the last view is gone.
+#if !defined(_WIN32) && !defined(ANDROID)
+    shm_unlink(m_system_name.c_str());
+#endif
+  }
+
+  UnmapMemory(m_memory, m_memory_size);
+}
+
+u32 SharedChunkCache::GetSlotSize(u32 chunk_size)
+{
+  // Keeps the slots page aligned, so that unused slots don't commit any memory
+  return Common::AlignUp(std::max<u32>(chunk_size, 1), static_cast<u32>(DATA_ALIGNMENT));
+}
+
+std::string SharedChunkCache::GetSystemName(const std::string& name, u32 slot_size)
+{
+  // Short enough for the 31 characters that macOS allows
+  const std::string suffix = "." + std::to_string(slot_size >> 10);
+#ifdef _WIN32
+  return "Local\\" + name + suffix;
+#else
+  return "/" + name + suffix + "." + std::to_string(getuid());
+#endif
+}
+
+size_t SharedChunkCache::GetDataOffset(u32 num_slots)
+{
+  static_assert(sizeof(Header) <= SLOTS_OFFSET, "Header is too big");
+  return Common::AlignUp(SLOTS_OFFSET + num_slots * sizeof(Slot), DATA_ALIGNMENT);
+}
+
+size_t SharedChunkCache::GetMemorySize(u32 num_slots, u32 slot_size)
+{
+  return GetDataOffset(num_slots) + size_t(num_slots) * slot_size;
+}
+
+std::shared_ptr<SharedChunkCache> SharedChunkCache::Open(const std::string& name, u64 size,
+                                                         u32 chunk_size)
+{
+  const u32 slot_size = GetSlotSize(chunk_size);
+  const u64 max_slots = (std::numeric_limits<size_t>::max() / 2) / slot_size;
+  const u32 num_slots = static_cast<u32>(
+      std::max<u64>(std::min<u64>(size / slot_size, std::min<u64>(max_slots, 0x80000000)) /
+                        CACHE_WAYS * CACHE_WAYS,
+                    CACHE_WAYS));
+  const std::string system_name = GetSystemName(name, slot_size);
+
+  // If the last process that had the cache open is deleting it, its name sticks around for a
+  // moment. Keep trying until it's gone and a new cache can be created.
+  for (int attempt = 0; attempt < 1000; ++attempt)
+  {
+    bool created;
+    void* memory;
+    size_t memory_size;
+
+#ifdef _WIN32
+    const u64 requested_size = GetMemorySize(num_slots, slot_size);
+    const HANDLE mapping = CreateFileMapping(
+        INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(requested_size >> 32),
+        static_cast<DWORD>(requested_size), UTF8ToTStr(system_name).c_str());
+    if (!mapping)
+    {
+      WARN_LOG(DISCIO, "Failed to create shared chunk cache (error %lu)", GetLastError());
+      return nullptr;
+    }
+    created = GetLastError() != ERROR_ALREADY_EXISTS;
+
+    // The view keeps the mapping alive, so the handle isn't needed after this.
+    memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!memory)
+    {
+      WARN_LOG(DISCIO, "Failed to map shared chunk cache (error %lu)", GetLastError());
+      return nullptr;
+    }
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(memory, &info, sizeof(info));
+    memory_size = info.RegionSize;
+#elif defined(ANDROID)
+    // Android has no named shared memory
+    return nullptr;
+#else
+    int fd = shm_open(system_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    created = fd != -1;
+    if (!created && errno == EEXIST)
+      fd = shm_open(system_name.c_str(), O_RDWR, 0600);
+    if (fd == -1)
+    {
+      // The name was removed between the two calls
+      if (errno == ENOENT)
+        continue;
+      WARN_LOG(DISCIO, "Failed to open shared chunk cache: %s", strerror(errno));
+      return nullptr;
+    }
+
+    if (created)
+    {
+      memory_size = GetMemorySize(num_slots, slot_size);
+      if (ftruncate(fd, static_cast<off_t>(memory_size)) != 0)
+      {
+        WARN_LOG(DISCIO, "Failed to allocate shared chunk cache: %s", strerror(errno));
+        close(fd);
+        shm_unlink(system_name.c_str());
+        return nullptr;
+      }
+    }
+    else
+    {
+      // The process that created it may not have set the size yet
+      struct stat st = {};
+      for (int i = 0; i < 1000 && fstat(fd, &st) == 0 && st.st_size == 0; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      memory_size = static_cast<size_t>(st.st_size);
+      if (memory_size < SLOTS_OFFSET)
+      {
+        WARN_LOG(DISCIO, "The shared chunk cache was never initialized");
+        close(fd);
+        return nullptr;
+      }
+    }
+
+    memory = mmap(nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+      WARN_LOG(DISCIO, "Failed to map shared chunk cache: %s", strerror(errno));
+      return nullptr;
+    }
+#endif
+
+    Header* header = static_cast<Header*>(memory);
+    if (created)
+    {
+      // The memory starts out zeroed, which is also what the slots need
+      new (header) Header();
+      header->version = CACHE_VERSION;
+      header->slot_size = slot_size;
+      header->num_slots = num_slots;
+      header->stamp.store(0, std::memory_order_relaxed);
+      header->attached.store(1, std::memory_order_relaxed);
+      header->magic.store(CACHE_MAGIC, std::memory_order_release);
+    }
+    else
+    {
+      for (int i = 0; i < 1000 && header->magic.load(std::memory_order_acquire) != CACHE_MAGIC;
+           ++i)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+
+    if (header->magic.load(std::memory_order_acquire) != CACHE_MAGIC ||
+        header->version != CACHE_VERSION || header->slot_size != slot_size ||
+        header->num_slots % CACHE_WAYS != 0 || header->num_slots == 0 ||
+        GetMemorySize(header->num_slots, slot_size) > memory_size)
+    {
+      WARN_LOG(DISCIO, "The shared chunk cache was created by an incompatible version of Dolphin");
+      UnmapMemory(memory, memory_size);
+      return nullptr;
+    }
+
+    if (!created)
+    {
+      u32 attached = header->attached.load(std::memory_order_relaxed);
+      while (attached != 0 && !header->attached.compare_exchange_weak(attached, attached + 1,
+                                                                       std::memory_order_acq_rel))
+      {
+      }
+      if (attached == 0)
+      {
+        UnmapMemory(memory, memory_size);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+    }
+
+    std::shared_ptr<SharedChunkCache> cache(
+        new SharedChunkCache(memory, memory_size, system_name));
+    NOTICE_LOG(DISCIO, "%s shared chunk cache \"%s\" (%" PRIu64 " MiB of %u KiB chunks)",
+               created ? "Created" : "Opened", name.c_str(), cache->GetSize() >> 20,
+               slot_size >> 10);
+    return cache;
+  }
+
+  WARN_LOG(DISCIO, "Timed out waiting for the old shared chunk cache to be deleted");
+  return nullptr;
+}
+
+void SharedChunkCache::Remove(const std::string& name, u32 chunk_size)
+{
+#if !defined(_WIN32) && !defined(ANDROID)
+  shm_unlink(GetSystemName(name, GetSlotSize(chunk_size)).c_str());
+#endif
+}
+
+void SharedChunkCache::SetGlobal(const std::string& name, u64 size)
+{
+  std::lock_guard<std::mutex> lk(s_global_mutex);
+  // Readers that already have one of the old caches keep using it until they're closed
+  s_global_caches.clear();
+  s_global_name = name;
+  s_global_size = size;
+}
+
+bool SharedChunkCache::IsGlobalEnabled()
+{
+  std::lock_guard<std::mutex> lk(s_global_mutex);
+  return s_global_size != 0;
+}
+
+std::shared_ptr<SharedChunkCache> SharedChunkCache::GetGlobal(u32 chunk_size)
+{
+  std::lock_guard<std::mutex> lk(s_global_mutex);
+  if (s_global_size == 0)
+    return nullptr;
+
+  // A cache that failed to open is remembered too, so that it isn't retried for every reader
+  const u32 slot_size = GetSlotSize(chunk_size);
+  auto it = s_global_caches.find(slot_size);
+  if (it == s_global_caches.end())
+    it = s_global_caches.emplace(slot_size, Open(s_global_name, s_global_size, slot_size)).first;
+  return it->second;
+}
+
+u32 SharedChunkCache::GetSet(u64 image_id, u64 chunk_idx) const
+{
+  // splitmix64 finalizer, so that consecutive chunks spread over all sets
+  u64 hash = image_id ^ (chunk_idx * 0x9E3779B97F4A7C15ULL);
+  hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+  hash ^= hash >> 31;
+  return static_cast<u32>(hash % (m_num_slots / CACHE_WAYS)) * CACHE_WAYS;
+}
+
+u8* SharedChunkCache::GetSlotData(u32 slot) const
+{
+  return static_cast<u8*>(m_memory) + GetDataOffset(m_num_slots) + size_t(slot) * m_slot_size;
+}
+
+u32 SharedChunkCache::Lookup(u64 image_id, u64 chunk_idx, u8* out_ptr, u32 max_size)
+{
+  const u32 first_slot = GetSet(image_id, chunk_idx);
+  for (u32 i = first_slot; i < first_slot + CACHE_WAYS; ++i)
+  {
+    Slot& slot = m_slots[i];
+    const u32 sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+      continue;
+    if (slot.image_id.load(std::memory_order_relaxed) != image_id ||
+        slot.chunk_idx.load(std::memory_order_relaxed) != chunk_idx)
+    {
+      continue;
+    }
+    const u32 size = slot.size.load(std::memory_order_relaxed);
+    if (size == 0 || size > max_size)
+      continue;
+
+    std::memcpy(out_ptr, GetSlotData(i), size);
+
+    // If a writer has touched the slot in the meantime, the copy may be torn
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+      continue;
+
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return size;
+  }
+
+  m_misses.fetch_add(1, std::memory_order_relaxed);
+  return 0;
+}
+
+void SharedChunkCache::Store(u64 image_id, u64 chunk_idx, const u8* data, u32 size)
+{
+  if (size == 0 || size > m_slot_size)
+    return;
+
+  // Replace the slot in the set that was written longest ago (empty slots have stamp 0)
+  const u32 first_slot = GetSet(image_id, chunk_idx);
+  u32 victim = first_slot;
+  u64 oldest_stamp = std::numeric_limits<u64>::max();
+  for (u32 i = first_slot; i < first_slot + CACHE_WAYS; ++i)
+  {
+    const Slot& slot = m_slots[i];
+    if (slot.image_id.load(std::memory_order_relaxed) == image_id &&
+        slot.chunk_idx.load(std::memory_order_relaxed) == chunk_idx &&
+        slot.size.load(std::memory_order_relaxed) != 0)
+    {
+      // Another instance got here first
+      return;
+    }
+
+    const u64 stamp = slot.stamp.load(std::memory_order_relaxed);
+    if (stamp < oldest_stamp)
+    {
+      oldest_stamp = stamp;
+      victim = i;
+    }
+  }
+
+  Slot& slot = m_slots[victim];
+  u32 sequence = slot.sequence.load(std::memory_order_relaxed);
+  if ((sequence & 1) || !slot.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                                               std::memory_order_acquire))
+  {
+    // Someone else is writing the slot. Their chunk is as good as ours.
+    return;
+  }
+  // Readers must see the odd sequence before any of the new contents
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.image_id.store(image_id, std::memory_order_relaxed);
+  slot.chunk_idx.store(chunk_idx, std::memory_order_relaxed);
+  slot.size.store(size, std::memory_order_relaxed);
+  std::memcpy(GetSlotData(victim), data, size);
+  slot.stamp.store(m_header->stamp.fetch_add(1, std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+  m_stores.fetch_add(1, std::memory_order_relaxed);
+}
+
+SharedChunkCache::Stats SharedChunkCache::GetStats() const
+{
+  Stats stats;
+  stats.hits = m_hits.load(std::memory_order_relaxed);
+  stats.misses = m_misses.load(std::memory_order_relaxed);
+  stats.stores = m_stores.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace DiscIO
@@ -0,0 +1,96 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+namespace DiscIO
+{
+// A cache of decompressed chunks in memory that is shared between processes, so that several
+// instances of Dolphin running the same game only have to decompress each chunk once.
+// Entries are keyed by an ID of the image (see SectorReader::EnableSharedCache) and the index
+// of the chunk. All functions are thread-safe.
+//
+// The cache is a set-associative table of slots that are all as big as the chunks it holds, so
+// images with different chunk sizes use separate caches. Each slot is guarded by a sequence
+// counter that is odd while the slot is being written, so a reader that races with a writer
+// simply gets a miss. Only the memory of slots that have been written is actually committed.
+//
+// The cache counts the processes that have it open and is deleted when the last one closes it.
+// A process that crashes never closes it, so the cache can outlive all of them; Remove deletes
+// it in that case.
+class SharedChunkCache
+{
+public:
+  struct Stats
+  {
+    u64 hits = 0;
+    u64 misses = 0;
+    u64 stores = 0;
+  };
+
+  ~SharedChunkCache();
+
+  // Opens the cache with the given name for chunks of up to chunk_size bytes, creating it with
+  // room for about size bytes of chunks if no other process has it open. If another process has
+  // created it with a different size, that size is used. Returns nullptr if shared memory can't
+  // be used.
+  static std::shared_ptr<SharedChunkCache> Open(const std::string& name, u64 size,
+                                                u32 chunk_size);
+  // Deletes the name, so that the next call to Open creates a new cache. Processes that have
+  // the old one open can keep using it. Does nothing on Windows, where the cache always goes
+  // away when the last process closes it.
+  static void Remove(const std::string& name, u32 chunk_size);
+
+  // Sets the name and size of the caches that newly created readers use, which are opened the
+  // first time a reader with a given chunk size asks for one. A size of 0 disables sharing.
+  static void SetGlobal(const std::string& name, u64 size);
+  static bool IsGlobalEnabled();
+  // Returns nullptr if sharing is disabled or the cache can't be opened.
+  static std::shared_ptr<SharedChunkCache> GetGlobal(u32 chunk_size);
+
+  // Copies the chunk to out_ptr and returns its size, or returns 0 if the chunk isn't cached
+  // or is bigger than max_size.
+  u32 Lookup(u64 image_id, u64 chunk_idx, u8* out_ptr, u32 max_size);
+  void Store(u64 image_id, u64 chunk_idx, const u8* data, u32 size);
+
+  u32 GetSlotSize() const { return m_slot_size; }
+  u64 GetSize() const { return m_num_slots * u64(m_slot_size); }
+  Stats GetStats() const;
+
+private:
+  struct Header;
+  struct Slot;
+
+  SharedChunkCache(void* memory, size_t memory_size, std::string system_name);
+
+  static u32 GetSlotSize(u32 chunk_size);
+  static std::string GetSystemName(const std::string& name, u32 slot_size);
+  static size_t GetDataOffset(u32 num_slots);
+  static size_t GetMemorySize(u32 num_slots, u32 slot_size);
+
+  // Returns the first slot of the set that the chunk belongs in.
+  u32 GetSet(u64 image_id, u64 chunk_idx) const;
+  u8* GetSlotData(u32 slot) const;
+
+  void* m_memory;
+  size_t m_memory_size;
+  std::string m_system_name;
+  Header* m_header;
+  Slot* m_slots;
+  u32 m_num_slots;
+  u32 m_slot_size;
+
+  std::atomic<u64> m_hits{0};
+  std::atomic<u64> m_misses{0};
+  std::atomic<u64> m_stores{0};
+};
+
+}  // namespace DiscIO
@@ -0,0 +1,215 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/StreamPipeline.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/Thread.h"
+
+namespace DiscIO
+{
+namespace
+{
+struct Slot
+{
+  PipelineChunk chunk;
+  bool done = false;
+  bool ok = false;
+};
+
+class PipelineState
+{
+public:
+  PipelineState(const StreamPipeline& pipeline, u64 num_chunks, size_t num_slots)
+      : m_pipeline(pipeline), m_num_chunks(num_chunks), m_slots(num_slots)
+  {
+  }
+
+  StreamPipeline::Result Run(size_t num_workers)
+  {
+    std::vector<std::thread> threads;
+    threads.emplace_back(&PipelineState::ReaderThread, this);
+    for (size_t i = 0; i < num_workers; i++)
+      threads.emplace_back(&PipelineState::WorkerThread, this);
+
+    const StreamPipeline::Result result = WriteChunks();
+
+    Stop(result);
+    for (std::thread& thread : threads)
+      thread.join();
+
+    return result;
+  }
+
+private:
+  Slot& GetSlot(u64 chunk) { return m_slots[chunk % m_slots.size()]; }
+
+  // Returns the result of the first stage that failed.
+  StreamPipeline::Result Stop(StreamPipeline::Result result)
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      if (!m_stopped)
+      {
+        m_stopped = true;
+        m_result = result;
+      }
+      result = m_result;
+    }
+    m_cv.notify_all();
+    return result;
+  }
+
+  void ReaderThread()
+  {
+    Common::SetCurrentThreadName((std::string(m_pipeline.thread_name) + " Reader").c_str());
+
+    for (u64 i = 0; i < m_num_chunks; i++)
+    {
+      Slot& slot = GetSlot(i);
+      {
+        // The slot can be reused once the writer is done with the chunk that was in it.
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_cv.wait(lk, [&] { return m_stopped || i < m_num_written + m_slots.size(); });
+        if (m_stopped)
+          return;
+      }
+
+      slot.chunk.index = i;
+      slot.chunk.write_size = 0;
+      slot.chunk.stored = false;
+      slot.chunk.type = 0;
+      slot.chunk.hash = 0;
+      if (!m_pipeline.read(&slot.chunk))
+      {
+        Stop(StreamPipeline::Result::ReadFailed);
+        return;
+      }
+
+      {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (m_pipeline.transform)
+        {
+          m_work.push(&slot);
+        }
+        else
+        {
+          slot.chunk.write_size = slot.chunk.in_buf.size();
+          slot.chunk.stored = true;
+          slot.ok = true;
+          slot.done = true;
+        }
+      }
+      m_cv.notify_all();
+    }
+  }
+
+  void WorkerThread()
+  {
+    Common::SetCurrentThreadName(m_pipeline.thread_name);
+
+    std::unique_ptr<ChunkTransform> transform = m_pipeline.transform();
+
+    while (true)
+    {
+      Slot* slot;
+      {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_cv.wait(lk, [this] { return m_stopped || !m_work.empty(); });
+        if (m_stopped)
+          return;
+        slot = m_work.front();
+        m_work.pop();
+      }
+
+      const bool ok = transform && transform->Transform(&slot->chunk);
+
+      {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        slot->ok = ok;
+        slot->done = true;
+      }
+      m_cv.notify_all();
+    }
+  }
+
+  StreamPipeline::Result WriteChunks()
+  {
+    for (u64 i = 0; i < m_num_chunks; i++)
+    {
+      if (m_pipeline.progress && !m_pipeline.progress(i, m_num_chunks))
+        return Stop(StreamPipeline::Result::Cancelled);
+
+      Slot& slot = GetSlot(i);
+      {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_cv.wait(lk, [&] { return m_stopped || slot.done; });
+        if (m_stopped)
+          return m_result;
+      }
+
+      if (!slot.ok)
+        return Stop(StreamPipeline::Result::TransformFailed);
+      if (!m_pipeline.write(slot.chunk))
+        return Stop(StreamPipeline::Result::WriteFailed);
+
+      {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        slot.done = false;
+        m_num_written = i + 1;
+      }
+      m_cv.notify_all();
+    }
+
+    return StreamPipeline::Result::Success;
+  }
+
+  const StreamPipeline& m_pipeline;
+  const u64 m_num_chunks;
+  std::vector<Slot> m_slots;
+
+  // One condition variable for everything, since every change wakes up at most a few threads
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::queue<Slot*> m_work;
+  u64 m_num_written = 0;
+  bool m_stopped = false;
+  StreamPipeline::Result m_result = StreamPipeline::Result::Success;
+};
+}  // namespace
+
+StreamPipeline::Result StreamPipeline::Run(u64 num_chunks) const
+{
+  if (!transform && num_chunks <= 1)
+  {
+    // Not worth starting a thread for, e.g. when extracting small files
+    if (num_chunks == 0)
+      return Result::Success;
+    if (progress && !progress(0, num_chunks))
+      return Result::Cancelled;
+    PipelineChunk chunk;
+    if (!read(&chunk))
+      return Result::ReadFailed;
+    chunk.write_size = chunk.in_buf.size();
+    chunk.stored = true;
+    return write(chunk) ? Result::Success : Result::WriteFailed;
+  }
+
+  // Without a transform, two slots are enough for reading one chunk while writing the other.
+  // With one, there are enough slots that the workers can keep going while the writer catches up.
+  const size_t num_workers = transform ? std::max(1u, std::thread::hardware_concurrency()) : 0;
+  const size_t num_slots = transform ? num_workers * 4 : 2;
+
+  PipelineState state(*this, num_chunks, num_slots);
+  return state.Run(num_workers);
+}
+
+}  // namespace DiscIO
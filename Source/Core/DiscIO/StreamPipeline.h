@@ -0,0 +1,82 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace DiscIO
+{
+// One chunk of data on its way through a StreamPipeline.
+struct PipelineChunk
+{
+  // The number of the chunk, counting from 0.
+  u64 index = 0;
+  // Filled in by the reader. The size may differ between chunks.
+  std::vector<u8> in_buf;
+  std::vector<u8> out_buf;
+
+  // Filled in by the ChunkTransform. If stored is set, in_buf is written instead of out_buf.
+  // Without a transform, all of in_buf is written.
+  size_t write_size = 0;
+  bool stored = false;
+  // Format specific, e.g. the chunk type.
+  u32 type = 0;
+  u32 hash = 0;
+
+  const u8* GetOutput() const { return stored ? in_buf.data() : out_buf.data(); }
+};
+
+// The state used by one worker thread to transform chunks, e.g. a z_stream for compression.
+class ChunkTransform
+{
+public:
+  virtual ~ChunkTransform() = default;
+  virtual bool Transform(PipelineChunk* chunk) = 0;
+};
+
+// Streams chunks from a reader through an optional transform to a writer. The three stages
+// overlap: the reader runs on a thread of its own and stays a few chunks ahead, the transform
+// runs on a pool of worker threads, and the writer runs on the calling thread. The writer gets
+// the chunks in order, so the output is identical to processing the chunks one after another.
+//
+// Any stage can stop the pipeline by returning false, and so can the progress callback, which
+// is how the caller cancels it.
+struct StreamPipeline
+{
+  enum class Result
+  {
+    Success,
+    ReadFailed,
+    TransformFailed,
+    WriteFailed,
+    Cancelled,
+  };
+
+  // Fills in in_buf (and anything else the later stages need) for chunk->index. Called on the
+  // reader thread, in order.
+  using ReadFunction = std::function<bool(PipelineChunk* chunk)>;
+  // Called once on each worker thread. May return nullptr if the transform can't be set up,
+  // in which case every chunk that thread picks up fails.
+  using TransformFactory = std::function<std::unique_ptr<ChunkTransform>()>;
+  // Called on the calling thread, in order.
+  using WriteFunction = std::function<bool(const PipelineChunk& chunk)>;
+  // Called on the calling thread before waiting for each chunk. Returning false cancels.
+  using ProgressFunction = std::function<bool(u64 chunks_done, u64 num_chunks)>;
+
+  ReadFunction read;
+  TransformFactory transform;  // Optional
+  WriteFunction write;
+  ProgressFunction progress;  // Optional
+  const char* thread_name = "Stream Pipeline";
+
+  Result Run(u64 num_chunks) const;
+};
+
+}  // namespace DiscIO
@@ -57,6 +57,12 @@ public:
     const std::optional<u32> temp = ReadSwapped<u32>(offset, partition);
     return temp ? static_cast<u64>(*temp) << GetOffsetShift() : std::optional<u64>();
   }
+  // Returns the data that Read would have copied if it can be accessed in place,
+  // or nullptr if it has to be decrypted or decompressed. Thread-safe.
+  virtual const u8* GetMappedData(u64 offset, u64 length, const Partition& partition) const
+  {
+    return nullptr;
+  }
 
   virtual bool IsEncryptedAndHashed() const { return false; }
   virtual std::vector<Partition> GetPartitions() const { return {}; }
@@ -101,6 +107,17 @@ public:
   virtual Platform GetVolumeType() const = 0;
   virtual bool SupportsIntegrityCheck() const { return false; }
   virtual bool CheckH3TableIntegrity(const Partition& partition) const { return false; }
+  // Loads what the CheckBlockIntegrity overload below that takes the block's data needs for the
+  // partition. Must be called on one thread before that overload is used from several.
+  virtual void PrepareBlockIntegrityChecks(const Partition& partition) const {}
+  // encrypted_data is the whole block as stored on the disc. Unlike the overload below, this
+  // doesn't read from the disc, so it can be called from multiple threads at once as long as
+  // PrepareBlockIntegrityChecks has been called for the partition.
+  virtual bool CheckBlockIntegrity(u64 block_index, const u8* encrypted_data,
+                                   const Partition& partition) const
+  {
+    return false;
+  }
   virtual bool CheckBlockIntegrity(u64 block_index, const Partition& partition) const
   {
     return false;
@@ -5,10 +5,14 @@
 #include "DiscIO/VolumeVerifier.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cinttypes>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <unordered_set>
 
 #include <mbedtls/aes.h>
@@ -19,6 +23,7 @@
 #include "Common/Align.h"
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
@@ -45,6 +50,8 @@ constexpr u64 DL_DVD_SIZE = 8511160320;    // Wii retail
 constexpr u64 DL_DVD_R_SIZE = 8543666176;  // Wii RVT-R
 
 constexpr u64 BLOCK_SIZE = 0x20000;
+// How many buffers Process can read before waiting for the worker threads to catch up
+constexpr size_t MAX_BUFFERS_IN_FLIGHT = 32;
 
 VolumeVerifier::VolumeVerifier(const Volume& volume, Hashes<bool> hashes_to_calculate)
     : m_volume(volume), m_hashes_to_calculate(hashes_to_calculate),
@@ -73,6 +80,8 @@ void VolumeVerifier::Start()
   CheckMisc();
 
   SetUpHashing();
+
+  m_start_time = std::chrono::steady_clock::now();
 }
 
 void VolumeVerifier::CheckPartitions()
@@ -645,18 +654,41 @@ void VolumeVerifier::SetUpHashing()
             [](const BlockToVerify& b1, const BlockToVerify& b2) { return b1.offset < b2.offset; });
 
   if (m_hashes_to_calculate.crc32)
+  {
     m_crc32_context = crc32(0, nullptr, 0);
+    m_crc32_thread.Reset([this](Buffer data) {
+      // It would be nice to use crc32_z here instead of crc32, but it isn't available on Android
+      m_crc32_context =
+          crc32(m_crc32_context, data->data(), static_cast<unsigned int>(data->size()));
+    });
+  }
 
   if (m_hashes_to_calculate.md5)
   {
     mbedtls_md5_init(&m_md5_context);
     mbedtls_md5_starts(&m_md5_context);
+    m_md5_thread.Reset(
+        [this](Buffer data) { mbedtls_md5_update(&m_md5_context, data->data(), data->size()); });
   }
 
   if (m_hashes_to_calculate.sha1)
   {
-    mbedtls_sha1_init(&m_sha1_context);
-    mbedtls_sha1_starts(&m_sha1_context);
+    m_sha1_context = Common::SHA1::CreateContext();
+    m_sha1_thread.Reset(
+        [this](Buffer data) { m_sha1_context->Update(data->data(), data->size()); });
+  }
+
+  if (!m_blocks.empty())
+  {
+    for (const Partition& partition : m_volume.GetPartitions())
+      m_volume.PrepareBlockIntegrityChecks(partition);
+
+    const unsigned int num_threads = std::max(1U, std::thread::hardware_concurrency());
+    for (unsigned int i = 0; i < num_threads; ++i)
+    {
+      m_block_threads.emplace_back(std::make_unique<Common::WorkQueueThread<BlockJob>>(
+          [this](BlockJob job) { CheckBlock(job); }));
+    }
   }
 }
 
@@ -685,7 +717,16 @@ void VolumeVerifier::Process()
   }
   else if (m_block_index < m_blocks.size() && m_blocks[m_block_index].offset == m_progress)
   {
-    bytes_to_read = VolumeWii::BLOCK_TOTAL_SIZE;
+    // Read several contiguous blocks at once so that there's work for more than one thread
+    size_t end_index = m_block_index + 1;
+    while (end_index < m_blocks.size() &&
+           (end_index - m_block_index) * VolumeWii::BLOCK_TOTAL_SIZE < BLOCK_SIZE &&
+           m_blocks[end_index].offset ==
+               m_blocks[end_index - 1].offset + VolumeWii::BLOCK_TOTAL_SIZE)
+    {
+      ++end_index;
+    }
+    bytes_to_read = (end_index - m_block_index) * VolumeWii::BLOCK_TOTAL_SIZE;
   }
   else if (m_block_index < m_blocks.size() && m_blocks[m_block_index].offset > m_progress)
   {
@@ -693,28 +734,30 @@ void VolumeVerifier::Process()
   }
   bytes_to_read = std::min(bytes_to_read, m_max_progress - m_progress);
 
-  if (m_calculating_any_hash)
+  const u64 read_offset = m_progress;
+  const bool has_blocks = m_block_index < m_blocks.size() &&
+                          m_blocks[m_block_index].offset < read_offset + bytes_to_read;
+
+  Buffer data;
+  if (m_calculating_any_hash || has_blocks)
   {
-    std::vector<u8> data(bytes_to_read);
-    if (!m_volume.Read(m_progress, bytes_to_read, data.data(), PARTITION_NONE))
-    {
-      m_calculating_any_hash = false;
-    }
+    std::shared_ptr<std::vector<u8>> buffer = AllocateBuffer(bytes_to_read);
+    if (m_volume.Read(read_offset, bytes_to_read, buffer->data(), PARTITION_NONE))
+      data = std::move(buffer);
     else
-    {
-      if (m_hashes_to_calculate.crc32)
-      {
-        // It would be nice to use crc32_z here instead of crc32, but it isn't available on Android
-        m_crc32_context =
-            crc32(m_crc32_context, data.data(), static_cast<unsigned int>(bytes_to_read));
-      }
+      m_calculating_any_hash = false;
+  }
 
-      if (m_hashes_to_calculate.md5)
-        mbedtls_md5_update(&m_md5_context, data.data(), bytes_to_read);
+  if (m_calculating_any_hash)
+  {
+    if (m_hashes_to_calculate.crc32)
+      m_crc32_thread.EmplaceItem(data);
 
-      if (m_hashes_to_calculate.sha1)
-        mbedtls_sha1_update(&m_sha1_context, data.data(), bytes_to_read);
-    }
+    if (m_hashes_to_calculate.md5)
+      m_md5_thread.EmplaceItem(data);
+
+    if (m_hashes_to_calculate.sha1)
+      m_sha1_thread.EmplaceItem(data);
   }
 
   m_progress += bytes_to_read;
@@ -732,25 +775,72 @@ void VolumeVerifier::Process()
 
   while (m_block_index < m_blocks.size() && m_blocks[m_block_index].offset < m_progress)
   {
-    if (!m_volume.CheckBlockIntegrity(m_blocks[m_block_index].block_index,
-                                      m_blocks[m_block_index].partition))
+    const BlockToVerify& block = m_blocks[m_block_index];
+    if (data && block.offset + VolumeWii::BLOCK_TOTAL_SIZE <= m_progress)
     {
-      const u64 offset = m_blocks[m_block_index].offset;
-      if (m_scrubber.CanBlockBeScrubbed(offset))
-      {
-        WARN_LOG(DISCIO, "Integrity check failed for unused block at 0x%" PRIx64, offset);
-        m_unused_block_errors[m_blocks[m_block_index].partition]++;
-      }
-      else
-      {
-        WARN_LOG(DISCIO, "Integrity check failed for block at 0x%" PRIx64, offset);
-        m_block_errors[m_blocks[m_block_index].partition]++;
-      }
+      m_block_threads[m_next_block_thread]->EmplaceItem(
+          BlockJob{data, static_cast<size_t>(block.offset - read_offset), block});
+      m_next_block_thread = (m_next_block_thread + 1) % m_block_threads.size();
+    }
+    else if (!m_volume.CheckBlockIntegrity(block.block_index, block.partition))
+    {
+      // The block wasn't read in full (which means something is wrong with the disc anyway),
+      // so it's checked here instead of on a worker thread
+      AddBlockError(block);
     }
     m_block_index++;
   }
 }
 
+std::shared_ptr<std::vector<u8>> VolumeVerifier::AllocateBuffer(size_t size)
+{
+  {
+    std::unique_lock<std::mutex> lk(m_buffers_mutex);
+    m_buffers_cv.wait(lk, [this] { return m_buffers_in_flight < MAX_BUFFERS_IN_FLIGHT; });
+    ++m_buffers_in_flight;
+  }
+
+  return std::shared_ptr<std::vector<u8>>(new std::vector<u8>(size), [this](std::vector<u8>* p) {
+    delete p;
+    {
+      std::lock_guard<std::mutex> lk(m_buffers_mutex);
+      --m_buffers_in_flight;
+    }
+    m_buffers_cv.notify_all();
+  });
+}
+
+void VolumeVerifier::WaitForWorkerThreads()
+{
+  // Every worker thread holds on to its buffer until it's done with it
+  std::unique_lock<std::mutex> lk(m_buffers_mutex);
+  m_buffers_cv.wait(lk, [this] { return m_buffers_in_flight == 0; });
+}
+
+void VolumeVerifier::CheckBlock(const BlockJob& job)
+{
+  if (!m_volume.CheckBlockIntegrity(job.block.block_index, job.data->data() + job.offset_in_data,
+                                    job.block.partition))
+  {
+    AddBlockError(job.block);
+  }
+}
+
+void VolumeVerifier::AddBlockError(const BlockToVerify& block)
+{
+  std::lock_guard<std::mutex> lk(m_block_errors_mutex);
+  if (m_scrubber.CanBlockBeScrubbed(block.offset))
+  {
+    WARN_LOG(DISCIO, "Integrity check failed for unused block at 0x%" PRIx64, block.offset);
+    m_unused_block_errors[block.partition]++;
+  }
+  else
+  {
+    WARN_LOG(DISCIO, "Integrity check failed for block at 0x%" PRIx64, block.offset);
+    m_block_errors[block.partition]++;
+  }
+}
+
 bool VolumeVerifier::CheckContentIntegrity(const IOS::ES::Content& content)
 {
   const u64 padded_size = Common::AlignUp(content.size, 0x40);
@@ -791,6 +881,13 @@ void VolumeVerifier::Finish()
     return;
   m_done = true;
 
+  WaitForWorkerThreads();
+
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start_time).count();
+  NOTICE_LOG(DISCIO, "Verified %" PRIu64 " bytes in %.1f s (%.1f MB/s)", m_progress, seconds,
+             seconds > 0 ? m_progress / seconds / 1000000 : 0.0);
+
   if (m_calculating_any_hash)
   {
     if (m_hashes_to_calculate.crc32)
@@ -809,8 +906,8 @@ void VolumeVerifier::Finish()
 
     if (m_hashes_to_calculate.sha1)
     {
-      m_result.hashes.sha1 = std::vector<u8>(20);
-      mbedtls_sha1_finish(&m_sha1_context, m_result.hashes.sha1.data());
+      const Common::SHA1::Digest sha1 = m_sha1_context->Finish();
+      m_result.hashes.sha1 = std::vector<u8>(sha1.begin(), sha1.end());
     }
   }
 
@@ -4,15 +4,20 @@
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include <mbedtls/md5.h>
-#include <mbedtls/sha1.h>
 
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
+#include "Common/WorkQueueThread.h"
 #include "DiscIO/DiscScrubber.h"
 #include "DiscIO/Volume.h"
 
@@ -27,6 +32,9 @@
 //
 // Start, Process and Finish may take some time to run.
 //
+// Process only reads the disc. The hashes are calculated on worker threads (one per hash, since
+// they have to be calculated in order) and the Wii block checks are spread over a thread pool.
+//
 // GetResult() can be called before the processing is finished, but the result will be incomplete.
 
 namespace IOS::ES
@@ -87,6 +95,16 @@ private:
     u64 block_index;
   };
 
+  // Data read by Process, shared by the worker threads that need it.
+  using Buffer = std::shared_ptr<const std::vector<u8>>;
+
+  struct BlockJob
+  {
+    Buffer data;
+    size_t offset_in_data;
+    BlockToVerify block;
+  };
+
   void CheckPartitions();
   bool CheckPartition(const Partition& partition);  // Returns false if partition should be ignored
   std::string GetPartitionName(std::optional<u32> type) const;
@@ -102,6 +120,10 @@ private:
   void CheckMisc();
   void SetUpHashing();
   bool CheckContentIntegrity(const IOS::ES::Content& content);
+  std::shared_ptr<std::vector<u8>> AllocateBuffer(size_t size);
+  void WaitForWorkerThreads();
+  void CheckBlock(const BlockJob& job);
+  void AddBlockError(const BlockToVerify& block);
 
   void AddProblem(Severity severity, const std::string& text);
 
@@ -115,13 +137,14 @@ private:
   bool m_calculating_any_hash;
   unsigned long m_crc32_context;
   mbedtls_md5_context m_md5_context;
-  mbedtls_sha1_context m_sha1_context;
+  std::unique_ptr<Common::SHA1::Context> m_sha1_context;
 
   DiscScrubber m_scrubber;
   std::vector<u64> m_content_offsets;
   u16 m_content_index = 0;
   std::vector<BlockToVerify> m_blocks;
   size_t m_block_index = 0;  // Index in m_blocks, not index in a specific partition
+  std::mutex m_block_errors_mutex;
   std::map<Partition, size_t> m_block_errors;
   std::map<Partition, size_t> m_unused_block_errors;
 
@@ -129,6 +152,19 @@ private:
   bool m_done;
   u64 m_progress;
   u64 m_max_progress;
+  std::chrono::steady_clock::time_point m_start_time;
+
+  // Limits how far Process can read ahead of the worker threads.
+  std::mutex m_buffers_mutex;
+  std::condition_variable m_buffers_cv;
+  size_t m_buffers_in_flight = 0;
+
+  // These are declared last so that they are shut down before anything they use is destroyed.
+  Common::WorkQueueThread<Buffer> m_crc32_thread;
+  Common::WorkQueueThread<Buffer> m_md5_thread;
+  Common::WorkQueueThread<Buffer> m_sha1_thread;
+  std::vector<std::unique_ptr<Common::WorkQueueThread<BlockJob>>> m_block_threads;
+  size_t m_next_block_thread = 0;
 };
 
 }  // namespace DiscIO
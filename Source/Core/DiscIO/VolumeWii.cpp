@@ -19,6 +19,7 @@
 
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
@@ -222,6 +223,16 @@ bool VolumeWii::Read(u64 offset, u64 length, u8* buffer, const Partition& partit
   return true;
 }
 
+const u8* VolumeWii::GetMappedData(u64 offset, u64 length, const Partition& partition) const
+{
+  // Partitions of unencrypted discs could also be mapped, but looking up their data offset
+  // isn't thread-safe. Those discs are rare enough that it doesn't matter.
+  if (partition != PARTITION_NONE)
+    return nullptr;
+
+  return m_reader->GetMappedData(offset, length);
+}
+
 bool VolumeWii::IsEncryptedAndHashed() const
 {
   return m_encrypted;
@@ -447,7 +458,102 @@ bool VolumeWii::CheckH3TableIntegrity(const Partition& partition) const
   return h3_table_sha1 == contents[0].sha1;
 }
 
-bool VolumeWii::CheckBlockIntegrity(u64 block_index, const Partition& partition) const
+void VolumeWii::PrepareBlockIntegrityChecks(const Partition& partition) const
+{
+  auto it = m_partitions.find(partition);
+  if (it == m_partitions.end())
+    return;
+
+  // The first access to a Common::Lazy isn't thread-safe, so compute the values now. Read
+  // doesn't load the key for readers which support ReadWiiDecrypted.
+  static_cast<void>(*it->second.key);
+  static_cast<void>(*it->second.h3_table);
+}
+
+void VolumeWii::DecryptGroup(const u8* in, size_t num_blocks, const std::array<u8, 16>& key,
+                             u8* out)
+{
+  mbedtls_aes_context aes_context;
+  mbedtls_aes_init(&aes_context);
+  mbedtls_aes_setkey_dec(&aes_context, key.data(), 128);
+
+  for (size_t i = 0; i < num_blocks; ++i)
+  {
+    const u8* block = in + i * BLOCK_TOTAL_SIZE;
+    u8 iv[16];
+    std::copy_n(block + 0x3D0, sizeof(iv), iv);
+    mbedtls_aes_crypt_cbc(&aes_context, MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE, iv,
+                          block + BLOCK_HEADER_SIZE, out + i * BLOCK_DATA_SIZE);
+  }
+
+  mbedtls_aes_free(&aes_context);
+}
+
+void VolumeWii::EncryptGroup(const u8* in, size_t num_blocks, const std::array<u8, 16>& key,
+                             u8* out)
+{
+  constexpr size_t SHA1_SIZE = 20;
+
+  // See CheckBlockIntegrity for the layout of the hashes. Padding is left as zeroes.
+  std::vector<std::array<u8, BLOCK_HEADER_SIZE>> headers(num_blocks);
+  for (auto& header : headers)
+    header.fill(0);
+
+  for (size_t i = 0; i < num_blocks; ++i)
+  {
+    for (u32 hash_index = 0; hash_index < 31; ++hash_index)
+    {
+      const Common::SHA1::Digest h0_hash =
+          Common::SHA1::CalculateDigest(in + i * BLOCK_DATA_SIZE + hash_index * 0x400, 0x400);
+      std::copy(h0_hash.begin(), h0_hash.end(), headers[i].data() + hash_index * SHA1_SIZE);
+    }
+  }
+
+  for (size_t i = 0; i < num_blocks; ++i)
+  {
+    const Common::SHA1::Digest h1_hash =
+        Common::SHA1::CalculateDigest(headers[i].data(), SHA1_SIZE * 31);
+
+    const size_t subgroup_start = i / 8 * 8;
+    const size_t subgroup_end = std::min<size_t>(subgroup_start + 8, num_blocks);
+    for (size_t j = subgroup_start; j < subgroup_end; ++j)
+      std::copy(h1_hash.begin(), h1_hash.end(), headers[j].data() + 0x280 + (i % 8) * SHA1_SIZE);
+  }
+
+  for (size_t subgroup_start = 0; subgroup_start < num_blocks; subgroup_start += 8)
+  {
+    const Common::SHA1::Digest h2_hash =
+        Common::SHA1::CalculateDigest(headers[subgroup_start].data() + 0x280, SHA1_SIZE * 8);
+
+    for (size_t j = 0; j < num_blocks; ++j)
+    {
+      std::copy(h2_hash.begin(), h2_hash.end(),
+                headers[j].data() + 0x340 + subgroup_start / 8 * SHA1_SIZE);
+    }
+  }
+
+  mbedtls_aes_context aes_context;
+  mbedtls_aes_init(&aes_context);
+  mbedtls_aes_setkey_enc(&aes_context, key.data(), 128);
+
+  for (size_t i = 0; i < num_blocks; ++i)
+  {
+    u8* block = out + i * BLOCK_TOTAL_SIZE;
+
+    u8 iv[16] = {0};
+    mbedtls_aes_crypt_cbc(&aes_context, MBEDTLS_AES_ENCRYPT, BLOCK_HEADER_SIZE, iv,
+                          headers[i].data(), block);
+
+    std::copy_n(block + 0x3D0, sizeof(iv), iv);
+    mbedtls_aes_crypt_cbc(&aes_context, MBEDTLS_AES_ENCRYPT, BLOCK_DATA_SIZE, iv,
+                          in + i * BLOCK_DATA_SIZE, block + BLOCK_HEADER_SIZE);
+  }
+
+  mbedtls_aes_free(&aes_context);
+}
+
+bool VolumeWii::CheckBlockIntegrity(u64 block_index, const u8* encrypted_data,
+                                    const Partition& partition) const
 {
   auto it = m_partitions.find(partition);
   if (it == m_partitions.end())
@@ -462,46 +568,65 @@ bool VolumeWii::CheckBlockIntegrity(u64 block_index, const Partition& partition)
   if (!aes_context)
     return false;
 
-  const u64 cluster_offset =
-      partition.offset + *partition_details.data_offset + block_index * BLOCK_TOTAL_SIZE;
-
-  // Read and decrypt the cluster metadata
-  u8 cluster_metadata_crypted[BLOCK_HEADER_SIZE];
+  // Decrypt the cluster metadata
   u8 cluster_metadata[BLOCK_HEADER_SIZE];
   u8 iv[16] = {0};
-  if (!m_reader->Read(cluster_offset, BLOCK_HEADER_SIZE, cluster_metadata_crypted))
-    return false;
-  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, BLOCK_HEADER_SIZE, iv,
-                        cluster_metadata_crypted, cluster_metadata);
+  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, BLOCK_HEADER_SIZE, iv, encrypted_data,
+                        cluster_metadata);
 
+  // Decrypt the cluster data. The IV is stored in the encrypted metadata
   u8 cluster_data[BLOCK_DATA_SIZE];
-  if (!Read(block_index * BLOCK_DATA_SIZE, BLOCK_DATA_SIZE, cluster_data, partition))
-    return false;
+  std::copy_n(encrypted_data + 0x3D0, sizeof(iv), iv);
+  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE, iv,
+                        encrypted_data + BLOCK_HEADER_SIZE, cluster_data);
 
   for (u32 hash_index = 0; hash_index < 31; ++hash_index)
   {
-    u8 h0_hash[SHA1_SIZE];
-    mbedtls_sha1(cluster_data + hash_index * 0x400, 0x400, h0_hash);
-    if (memcmp(h0_hash, cluster_metadata + hash_index * SHA1_SIZE, SHA1_SIZE))
+    const Common::SHA1::Digest h0_hash =
+        Common::SHA1::CalculateDigest(cluster_data + hash_index * 0x400, 0x400);
+    if (memcmp(h0_hash.data(), cluster_metadata + hash_index * SHA1_SIZE, SHA1_SIZE))
       return false;
   }
 
-  u8 h1_hash[SHA1_SIZE];
-  mbedtls_sha1(cluster_metadata, SHA1_SIZE * 31, h1_hash);
-  if (memcmp(h1_hash, cluster_metadata + 0x280 + (block_index % 8) * SHA1_SIZE, SHA1_SIZE))
+  const Common::SHA1::Digest h1_hash =
+      Common::SHA1::CalculateDigest(cluster_metadata, SHA1_SIZE * 31);
+  if (memcmp(h1_hash.data(), cluster_metadata + 0x280 + (block_index % 8) * SHA1_SIZE, SHA1_SIZE))
     return false;
 
-  u8 h2_hash[SHA1_SIZE];
-  mbedtls_sha1(cluster_metadata + 0x280, SHA1_SIZE * 8, h2_hash);
-  if (memcmp(h2_hash, cluster_metadata + 0x340 + (block_index / 8 % 8) * SHA1_SIZE, SHA1_SIZE))
+  const Common::SHA1::Digest h2_hash =
+      Common::SHA1::CalculateDigest(cluster_metadata + 0x280, SHA1_SIZE * 8);
+  if (memcmp(h2_hash.data(), cluster_metadata + 0x340 + (block_index / 8 % 8) * SHA1_SIZE,
+             SHA1_SIZE))
+  {
     return false;
+  }
 
-  u8 h3_hash[SHA1_SIZE];
-  mbedtls_sha1(cluster_metadata + 0x340, SHA1_SIZE * 8, h3_hash);
-  if (memcmp(h3_hash, partition_details.h3_table->data() + block_index / 64 * SHA1_SIZE, SHA1_SIZE))
+  const Common::SHA1::Digest h3_hash =
+      Common::SHA1::CalculateDigest(cluster_metadata + 0x340, SHA1_SIZE * 8);
+  if (memcmp(h3_hash.data(), partition_details.h3_table->data() + block_index / 64 * SHA1_SIZE,
+             SHA1_SIZE))
+  {
     return false;
+  }
 
   return true;
 }
 
+bool VolumeWii::CheckBlockIntegrity(u64 block_index, const Partition& partition) const
+{
+  auto it = m_partitions.find(partition);
+  if (it == m_partitions.end())
+    return false;
+  const PartitionDetails& partition_details = it->second;
+
+  const u64 cluster_offset =
+      partition.offset + *partition_details.data_offset + block_index * BLOCK_TOTAL_SIZE;
+
+  std::vector<u8> cluster(BLOCK_TOTAL_SIZE);
+  if (!m_reader->Read(cluster_offset, cluster.size(), cluster.data()))
+    return false;
+
+  return CheckBlockIntegrity(block_index, cluster.data(), partition);
+}
+
 }  // namespace DiscIO
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <map>
 #include <mbedtls/aes.h>
 #include <memory>
@@ -33,6 +35,7 @@ public:
   VolumeWii(std::unique_ptr<BlobReader> reader);
   ~VolumeWii();
   bool Read(u64 offset, u64 length, u8* buffer, const Partition& partition) const override;
+  const u8* GetMappedData(u64 offset, u64 length, const Partition& partition) const override;
   bool IsEncryptedAndHashed() const override;
   std::vector<Partition> GetPartitions() const override;
   Partition GetGamePartition() const override;
@@ -58,6 +61,9 @@ public:
   Platform GetVolumeType() const override;
   bool SupportsIntegrityCheck() const override { return m_encrypted; }
   bool CheckH3TableIntegrity(const Partition& partition) const override;
+  void PrepareBlockIntegrityChecks(const Partition& partition) const override;
+  bool CheckBlockIntegrity(u64 block_index, const u8* encrypted_data,
+                           const Partition& partition) const override;
   bool CheckBlockIntegrity(u64 block_index, const Partition& partition) const override;
 
   Region GetRegion() const override;
@@ -73,6 +79,20 @@ public:
   static constexpr unsigned int BLOCK_DATA_SIZE = 0x7C00;
   static constexpr unsigned int BLOCK_TOTAL_SIZE = BLOCK_HEADER_SIZE + BLOCK_DATA_SIZE;
 
+  // A group is the set of blocks that share an H2 table.
+  static constexpr unsigned int BLOCKS_PER_GROUP = 64;
+  static constexpr u64 GROUP_TOTAL_SIZE = BLOCK_TOTAL_SIZE * BLOCKS_PER_GROUP;
+  static constexpr u64 GROUP_DATA_SIZE = BLOCK_DATA_SIZE * BLOCKS_PER_GROUP;
+
+  // Decrypts up to BLOCKS_PER_GROUP consecutive blocks, dropping their hashes.
+  // out receives num_blocks * BLOCK_DATA_SIZE bytes.
+  static void DecryptGroup(const u8* in, size_t num_blocks, const std::array<u8, 16>& key,
+                           u8* out);
+  // The inverse of DecryptGroup: computes the H0, H1 and H2 hashes and encrypts the blocks.
+  // out receives num_blocks * BLOCK_TOTAL_SIZE bytes.
+  static void EncryptGroup(const u8* in, size_t num_blocks, const std::array<u8, 16>& key,
+                           u8* out);
+
 protected:
   u32 GetOffsetShift() const override { return 2; }
 
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include <QByteArray>
+#include <QElapsedTimer>
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QLabel>
@@ -106,12 +107,24 @@ void VerifyWidget::Verify()
   progress->setWindowModality(Qt::WindowModal);
 
   verifier.Start();
+
+  QElapsedTimer timer;
+  timer.start();
+  qint64 last_speed_update = 0;
   while (verifier.GetBytesProcessed() != verifier.GetTotalBytes())
   {
     progress->setValue(verifier.GetBytesProcessed() / DIVISOR);
     if (progress->wasCanceled())
       return;
 
+    const qint64 elapsed_ms = timer.elapsed();
+    if (elapsed_ms - last_speed_update >= 500)
+    {
+      const double mb_per_second = verifier.GetBytesProcessed() / 1000.0 / elapsed_ms;
+      progress->setLabelText(tr("Verifying (%1 MB/s)").arg(mb_per_second, 0, 'f', 1));
+      last_speed_update = elapsed_ms;
+    }
+
     verifier.Process();
   }
   verifier.Finish();
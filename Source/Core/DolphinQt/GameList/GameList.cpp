@@ -36,6 +36,7 @@
 #include "Core/WiiUtils.h"
 
 #include "DiscIO/Blob.h"
+#include "DiscIO/DCZBlob.h"
 #include "DiscIO/Enums.h"
 
 #include "DolphinQt/Config/PropertiesDialog.h"
@@ -253,6 +254,7 @@ void GameList::ShowContextMenu(const QPoint&)
   {
     bool wii_saves = true;
     bool compress = false;
+    bool convert_to_dcz = false;
     bool decompress = false;
 
     for (const auto& game : GetSelectedGames())
@@ -262,10 +264,12 @@ void GameList::ShowContextMenu(const QPoint&)
       if (platform == DiscIO::Platform::GameCubeDisc || platform == DiscIO::Platform::WiiDisc)
       {
         const auto blob_type = game->GetBlobType();
-        if (blob_type == DiscIO::BlobType::GCZ)
+        if (blob_type == DiscIO::BlobType::GCZ || blob_type == DiscIO::BlobType::DCZ)
           decompress = true;
-        else if (blob_type == DiscIO::BlobType::PLAIN)
+        if (blob_type == DiscIO::BlobType::PLAIN)
           compress = true;
+        if (blob_type == DiscIO::BlobType::PLAIN || blob_type == DiscIO::BlobType::GCZ)
+          convert_to_dcz = true;
       }
 
       if (platform != DiscIO::Platform::WiiWAD && platform != DiscIO::Platform::WiiDisc)
@@ -273,10 +277,21 @@ void GameList::ShowContextMenu(const QPoint&)
     }
 
     if (compress)
-      menu->addAction(tr("Compress Selected ISOs..."), this, [this] { CompressISO(false); });
+    {
+      menu->addAction(tr("Compress Selected ISOs..."), this,
+                      [this] { CompressISO(DiscIO::BlobType::GCZ); });
+    }
+    if (convert_to_dcz)
+    {
+      menu->addAction(tr("Convert Selected ISOs to DCZ..."), this,
+                      [this] { CompressISO(DiscIO::BlobType::DCZ); });
+    }
     if (decompress)
-      menu->addAction(tr("Decompress Selected ISOs..."), this, [this] { CompressISO(true); });
-    if (compress || decompress)
+    {
+      menu->addAction(tr("Decompress Selected ISOs..."), this,
+                      [this] { CompressISO(DiscIO::BlobType::PLAIN); });
+    }
+    if (compress || convert_to_dcz || decompress)
       menu->addSeparator();
 
     if (wii_saves)
@@ -305,10 +320,21 @@ void GameList::ShowContextMenu(const QPoint&)
       menu->addAction(tr("Set as &Default ISO"), this, &GameList::SetDefaultISO);
       const auto blob_type = game->GetBlobType();
 
-      if (blob_type == DiscIO::BlobType::GCZ)
-        menu->addAction(tr("Decompress ISO..."), this, [this] { CompressISO(true); });
-      else if (blob_type == DiscIO::BlobType::PLAIN)
-        menu->addAction(tr("Compress ISO..."), this, [this] { CompressISO(false); });
+      if (blob_type == DiscIO::BlobType::GCZ || blob_type == DiscIO::BlobType::DCZ)
+      {
+        menu->addAction(tr("Decompress ISO..."), this,
+                        [this] { CompressISO(DiscIO::BlobType::PLAIN); });
+      }
+      if (blob_type == DiscIO::BlobType::PLAIN)
+      {
+        menu->addAction(tr("Compress ISO..."), this,
+                        [this] { CompressISO(DiscIO::BlobType::GCZ); });
+      }
+      if (blob_type == DiscIO::BlobType::PLAIN || blob_type == DiscIO::BlobType::GCZ)
+      {
+        menu->addAction(tr("Convert ISO to DCZ..."), this,
+                        [this] { CompressISO(DiscIO::BlobType::DCZ); });
+      }
 
       QAction* change_disc = menu->addAction(tr("Change &Disc"), this, &GameList::ChangeDisc);
 
@@ -469,7 +495,7 @@ void GameList::OpenWiki()
   QDesktopServices::openUrl(QUrl(url));
 }
 
-void GameList::CompressISO(bool decompress)
+void GameList::CompressISO(DiscIO::BlobType format)
 {
   auto files = GetSelectedGames();
   const auto game = GetSelectedGame();
@@ -477,21 +503,36 @@ void GameList::CompressISO(bool decompress)
   if (files.empty() || !game)
     return;
 
+  const bool decompress = format == DiscIO::BlobType::PLAIN;
+  const bool dcz = format == DiscIO::BlobType::DCZ;
+  const QString extension = decompress ? QStringLiteral(".gcm") :
+                                         dcz ? QStringLiteral(".dcz") : QStringLiteral(".gcz");
+
   bool wii_warning_given = false;
   for (QMutableListIterator<std::shared_ptr<const UICommon::GameFile>> it(files); it.hasNext();)
   {
     auto file = it.next();
+    const DiscIO::BlobType blob_type = file->GetBlobType();
+
+    bool convertible;
+    if (decompress)
+      convertible = blob_type == DiscIO::BlobType::GCZ || blob_type == DiscIO::BlobType::DCZ;
+    else if (dcz)
+      convertible = blob_type == DiscIO::BlobType::PLAIN || blob_type == DiscIO::BlobType::GCZ;
+    else
+      convertible = blob_type == DiscIO::BlobType::PLAIN;
 
     if ((file->GetPlatform() != DiscIO::Platform::GameCubeDisc &&
          file->GetPlatform() != DiscIO::Platform::WiiDisc) ||
-        (decompress && file->GetBlobType() != DiscIO::BlobType::GCZ) ||
-        (!decompress && file->GetBlobType() != DiscIO::BlobType::PLAIN))
+        !convertible)
     {
       it.remove();
       continue;
     }
 
-    if (!wii_warning_given && !decompress && file->GetPlatform() == DiscIO::Platform::WiiDisc)
+    // DCZ keeps Wii partitions bit for bit, only GCZ scrubs them
+    if (!wii_warning_given && format == DiscIO::BlobType::GCZ &&
+        file->GetPlatform() == DiscIO::Platform::WiiDisc)
     {
       ModalMessageBox wii_warning(this);
       wii_warning.setIcon(QMessageBox::Warning);
@@ -533,9 +574,10 @@ void GameList::CompressISO(bool decompress)
             .dir()
             .absoluteFilePath(
                 QFileInfo(QString::fromStdString(files[0]->GetFilePath())).completeBaseName())
-            .append(decompress ? QStringLiteral(".gcm") : QStringLiteral(".gcz")),
+            .append(extension),
         decompress ? tr("Uncompressed GC/Wii images (*.iso *.gcm)") :
-                     tr("Compressed GC/Wii images (*.gcz)"));
+                     dcz ? tr("DCZ GC/Wii images (*.dcz)") :
+                           tr("Compressed GC/Wii images (*.gcz)"));
 
     if (dst_path.isEmpty())
       return;
@@ -549,7 +591,7 @@ void GameList::CompressISO(bool decompress)
       dst_path =
           QDir(dst_dir)
               .absoluteFilePath(QFileInfo(QString::fromStdString(original_path)).completeBaseName())
-              .append(decompress ? QStringLiteral(".gcm") : QStringLiteral(".gcz"));
+              .append(extension);
       QFileInfo dst_info = QFileInfo(dst_path);
       if (dst_info.exists())
       {
@@ -588,9 +630,20 @@ void GameList::CompressISO(bool decompress)
       if (files.size() > 1)
         progress_dialog.setLabelText(tr("Compressing...") + QStringLiteral("\n") +
                                      QFileInfo(QString::fromStdString(original_path)).fileName());
-      good = DiscIO::CompressFileToBlob(original_path, dst_path.toStdString(),
-                                        file->GetPlatform() == DiscIO::Platform::WiiDisc ? 1 : 0,
-                                        16384, &CompressCB, &progress_dialog);
+      if (dcz)
+      {
+        good = DiscIO::CompressFileToDCZ(original_path, dst_path.toStdString(),
+                                         DiscIO::DCZCodec::Zlib, Z_BEST_COMPRESSION,
+                                         DiscIO::DCZ_DEFAULT_CHUNK_SIZE, false, &CompressCB,
+                                         &progress_dialog);
+      }
+      else
+      {
+        good = DiscIO::CompressFileToBlob(
+            original_path, dst_path.toStdString(),
+            file->GetPlatform() == DiscIO::Platform::WiiDisc ? 1 : 0, 16384, &CompressCB,
+            &progress_dialog);
+      }
     }
 
     if (!good)
@@ -14,6 +14,11 @@ class QListView;
 class QSortFilterProxyModel;
 class QTableView;
 
+namespace DiscIO
+{
+enum class BlobType;
+}
+
 namespace UICommon
 {
 class GameFile;
@@ -64,7 +69,8 @@ private:
   void InstallWAD();
   void UninstallWAD();
   void ExportWiiSave();
-  void CompressISO(bool decompress);
+  // PLAIN decompresses, GCZ and DCZ compress
+  void CompressISO(DiscIO::BlobType format);
   void ChangeDisc();
   void NewTag();
   void DeleteTag();
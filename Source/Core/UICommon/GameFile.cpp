@@ -20,6 +20,7 @@
 #include "Common/ChunkFile.h"
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
@@ -47,6 +48,30 @@ namespace UICommon
 {
 static const std::string EMPTY_STRING;
 
+// Returns 0 for empty data, so that the hash also says whether there is an image
+static u64 HashImageData(const u8* data, size_t size, u64 seed = 0)
+{
+  if (size == 0)
+    return 0;
+
+  const Common::SHA1::Digest digest = Common::SHA1::CalculateDigest(data, size);
+  u64 hash;
+  std::memcpy(&hash, digest.data(), sizeof(hash));
+  return (hash ^ seed) | 1;
+}
+
+static u64 HashBanner(const GameBanner& banner)
+{
+  return HashImageData(reinterpret_cast<const u8*>(banner.buffer.data()),
+                       banner.buffer.size() * sizeof(u32),
+                       (u64(banner.width) << 32) | banner.height);
+}
+
+static u64 HashCover(const GameCover& cover)
+{
+  return HashImageData(cover.buffer.data(), cover.buffer.size());
+}
+
 static bool UseGameCovers()
 {
 // We ifdef this out on Android because accessing the config before emulation start makes us crash.
@@ -142,7 +167,10 @@ GameFile::GameFile(const std::string& path)
       m_disc_number = volume->GetDiscNumber().value_or(0);
       m_apploader_date = volume->GetApploaderDate();
 
-      m_volume_banner.buffer = volume->GetBanner(&m_volume_banner.width, &m_volume_banner.height);
+      GameBanner banner;
+      banner.buffer = volume->GetBanner(&banner.width, &banner.height);
+      m_image_hashes.volume_banner = HashBanner(banner);
+      ModifyImages([banner](GameImages* images) { images->volume_banner = banner; });
 
       m_valid = true;
     }
@@ -170,7 +198,7 @@ bool GameFile::IsValid() const
 
 bool GameFile::CustomCoverChanged()
 {
-  if (!m_custom_cover.buffer.empty() || !UseGameCovers())
+  if (m_image_hashes.custom_cover != 0 || !UseGameCovers())
     return false;
 
   std::string path, name;
@@ -197,7 +225,7 @@ bool GameFile::CustomCoverChanged()
 
 void GameFile::DownloadDefaultCover()
 {
-  if (!m_default_cover.buffer.empty() || !UseGameCovers())
+  if (m_image_hashes.default_cover != 0 || !UseGameCovers())
     return;
 
   const auto cover_path = File::GetUserPath(D_COVERCACHE_IDX) + DIR_SEP;
@@ -264,7 +292,7 @@ void GameFile::DownloadDefaultCover()
 
 bool GameFile::DefaultCoverChanged()
 {
-  if (!m_default_cover.buffer.empty() || !UseGameCovers())
+  if (m_image_hashes.default_cover != 0 || !UseGameCovers())
     return false;
 
   const auto cover_path = File::GetUserPath(D_COVERCACHE_IDX) + DIR_SEP;
@@ -283,12 +311,18 @@ bool GameFile::DefaultCoverChanged()
 
 void GameFile::CustomCoverCommit()
 {
-  m_custom_cover = std::move(m_pending.custom_cover);
+  m_image_hashes.custom_cover = HashCover(m_pending.custom_cover);
+  ModifyImages([custom_cover = std::move(m_pending.custom_cover)](GameImages* images) {
+    images->custom_cover = custom_cover;
+  });
 }
 
 void GameFile::DefaultCoverCommit()
 {
-  m_default_cover = std::move(m_pending.default_cover);
+  m_image_hashes.default_cover = HashCover(m_pending.default_cover);
+  ModifyImages([default_cover = std::move(m_pending.default_cover)](GameImages* images) {
+    images->default_cover = default_cover;
+  });
 }
 
 void GameBanner::DoState(PointerWrap& p)
@@ -303,6 +337,14 @@ void GameCover::DoState(PointerWrap& p)
   p.Do(buffer);
 }
 
+void GameImages::DoState(PointerWrap& p)
+{
+  volume_banner.DoState(p);
+  custom_banner.DoState(p);
+  default_cover.DoState(p);
+  custom_cover.DoState(p);
+}
+
 void GameFile::DoState(PointerWrap& p)
 {
   p.Do(m_valid);
@@ -331,10 +373,7 @@ void GameFile::DoState(PointerWrap& p)
   p.Do(m_disc_number);
   p.Do(m_apploader_date);
 
-  m_volume_banner.DoState(p);
-  m_custom_banner.DoState(p);
-  m_default_cover.DoState(p);
-  m_custom_cover.DoState(p);
+  p.Do(m_image_hashes);
 }
 
 bool GameFile::IsElfOrDol() const
@@ -353,7 +392,7 @@ bool GameFile::WiiBannerChanged()
   // In case the cache was created without a save file existing,
   // let's try reading the save file again, because it might exist now.
 
-  if (!m_volume_banner.empty())
+  if (m_image_hashes.volume_banner != 0)
     return false;
   if (!DiscIO::IsWii(m_platform))
     return false;
@@ -369,7 +408,10 @@ bool GameFile::WiiBannerChanged()
 
 void GameFile::WiiBannerCommit()
 {
-  m_volume_banner = std::move(m_pending.volume_banner);
+  m_image_hashes.volume_banner = HashBanner(m_pending.volume_banner);
+  ModifyImages([volume_banner = std::move(m_pending.volume_banner)](GameImages* images) {
+    images->volume_banner = volume_banner;
+  });
 }
 
 bool GameFile::ReadPNGBanner(const std::string& path)
@@ -415,12 +457,15 @@ bool GameFile::CustomBannerChanged()
     }
   }
 
-  return m_pending.custom_banner != m_custom_banner;
+  return HashBanner(m_pending.custom_banner) != m_image_hashes.custom_banner;
 }
 
 void GameFile::CustomBannerCommit()
 {
-  m_custom_banner = std::move(m_pending.custom_banner);
+  m_image_hashes.custom_banner = HashBanner(m_pending.custom_banner);
+  ModifyImages([custom_banner = std::move(m_pending.custom_banner)](GameImages* images) {
+    images->custom_banner = custom_banner;
+  });
 }
 
 const std::string& GameFile::GetName(const Core::TitleDatabase& title_database) const
@@ -497,12 +542,85 @@ std::string GameFile::GetWiiFSPath() const
 
 const GameBanner& GameFile::GetBannerImage() const
 {
-  return m_custom_banner.empty() ? m_volume_banner : m_custom_banner;
+  const GameImages& images = GetImages();
+  return images.custom_banner.empty() ? images.volume_banner : images.custom_banner;
 }
 
 const GameCover& GameFile::GetCoverImage() const
 {
-  return m_custom_cover.empty() ? m_default_cover : m_custom_cover;
+  const GameImages& images = GetImages();
+  return images.custom_cover.empty() ? images.default_cover : images.custom_cover;
+}
+
+bool GameFile::LazyImages::Load()
+{
+  if (loaded.load(std::memory_order_acquire))
+    return true;
+
+  std::lock_guard<std::mutex> lk(mutex);
+  if (!loaded.load(std::memory_order_relaxed))
+  {
+    // Maybe the cache file is being rewritten right now. Try again next time.
+    GameImages new_images;
+    if (!loader(&new_images))
+      return false;
+
+    images = std::move(new_images);
+    loader = {};
+    loaded.store(true, std::memory_order_release);
+  }
+  return true;
+}
+
+const GameImages& GameFile::GetImages() const
+{
+  if (!m_images->Load())
+  {
+    static const GameImages EMPTY_IMAGES;
+    return EMPTY_IMAGES;
+  }
+  return m_images->images;
+}
+
+bool GameFile::LoadImages() const
+{
+  return m_images->Load();
+}
+
+bool GameFile::AreImagesLoaded() const
+{
+  return m_images->loaded.load(std::memory_order_acquire);
+}
+
+void GameFile::SetImageLoader(GameImageLoader loader)
+{
+  m_images = std::make_shared<LazyImages>();
+  m_images->loader = std::move(loader);
+  m_images->loaded = false;
+}
+
+void GameFile::ModifyImages(std::function<void(GameImages* images)> modify)
+{
+  if (m_images.use_count() != 1 || !AreImagesLoaded())
+  {
+    std::shared_ptr<LazyImages> old_images = std::move(m_images);
+    m_images = std::make_shared<LazyImages>();
+    if (!old_images->Load())
+    {
+      // The copy stays unloaded, and gets the modification once the images can be read
+      m_images->loaded = false;
+      m_images->loader = [old_images, modify](GameImages* images) {
+        if (!old_images->Load())
+          return false;
+        *images = old_images->images;
+        modify(images);
+        return true;
+      };
+      return;
+    }
+    m_images->images = old_images->images;
+  }
+  modify(&m_images->images);
 }
 
 }  // namespace UICommon
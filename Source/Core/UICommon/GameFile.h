@@ -4,7 +4,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -40,6 +44,20 @@ struct GameCover
 bool operator==(const GameBanner& lhs, const GameBanner& rhs);
 bool operator!=(const GameBanner& lhs, const GameBanner& rhs);
 
+// The banners and covers of a GameFile. They make up most of the size of the game list cache,
+// so GameFileCache leaves them on disk until they're actually used.
+struct GameImages
+{
+  GameBanner volume_banner{};
+  GameBanner custom_banner{};
+  GameCover default_cover{};
+  GameCover custom_cover{};
+  void DoState(PointerWrap& p);
+};
+
+// Reads the images of a GameFile from wherever they were stored. Must be thread-safe.
+using GameImageLoader = std::function<bool(GameImages* images)>;
+
 // This class caches the metadata of a DiscIO::Volume (or a DOL/ELF file).
 class GameFile final
 {
@@ -82,8 +100,17 @@ public:
   const std::string& GetApploaderDate() const { return m_apploader_date; }
   u64 GetFileSize() const { return m_file_size; }
   u64 GetVolumeSize() const { return m_volume_size; }
+  // These read the images first if they haven't been read yet. Thread-safe.
   const GameBanner& GetBannerImage() const;
   const GameCover& GetCoverImage() const;
+  // Returns empty images if they haven't been loaded and the loader fails.
+  const GameImages& GetImages() const;
+  // Returns false if the images haven't been loaded and the loader fails.
+  bool LoadImages() const;
+  bool AreImagesLoaded() const;
+  // Makes the images be read by the loader when they're first needed
+  void SetImageLoader(GameImageLoader loader);
+  // Handles everything except the images, which have to be saved separately.
   void DoState(PointerWrap& p);
   bool WiiBannerChanged();
   void WiiBannerCommit();
@@ -103,6 +130,21 @@ private:
   LookupUsingConfigLanguage(const std::map<DiscIO::Language, std::string>& strings) const;
   bool IsElfOrDol() const;
   bool ReadPNGBanner(const std::string& path);
+  // Modifies the images, after making sure that they're not shared. The hashes of the images
+  // must be updated separately.
+  void ModifyImages(std::function<void(GameImages* images)> modify);
+
+  // Copies of a GameFile share the images until one of them modifies them.
+  struct LazyImages
+  {
+    std::mutex mutex;
+    std::atomic<bool> loaded{true};
+    GameImageLoader loader;
+    GameImages images;
+
+    // Returns false if the loader fails
+    bool Load();
+  };
 
   // IMPORTANT: Nearly all data members must be save/restored in DoState.
   // If anything is changed, make sure DoState handles it properly and
@@ -134,10 +176,16 @@ private:
   u8 m_disc_number{};
   std::string m_apploader_date{};
 
-  GameBanner m_volume_banner{};
-  GameBanner m_custom_banner{};
-  GameCover m_default_cover{};
-  GameCover m_custom_cover{};
+  // Not handled in DoState, except for the hashes. These let the checks for changed images
+  // run without reading images that haven't been loaded yet. 0 means that an image is empty.
+  std::shared_ptr<LazyImages> m_images = std::make_shared<LazyImages>();
+  struct
+  {
+    u64 volume_banner;
+    u64 custom_banner;
+    u64 default_cover;
+    u64 custom_cover;
+  } m_image_hashes{};
 
   // The following data members allow GameFileCache to construct updated versions
   // of GameFiles in a threadsafe way. They should not be handled in DoState.
@@ -5,21 +5,31 @@
 #include "UICommon/GameFileCache.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdio>
+#include <cstring>
 #include <functional>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/File.h"
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
 
 #include "DiscIO/DirectoryBlob.h"
 
@@ -27,13 +37,111 @@
 
 namespace UICommon
 {
-static constexpr u32 CACHE_REVISION = 15;  // Last changed in PR 7816
+static constexpr u32 CACHE_MAGIC = 0x43464744;   // "DGFC"
+static constexpr u32 RECORD_MAGIC = 0x44434552;  // "RECD"
+static constexpr u32 CACHE_REVISION = 17;        // Last changed when splitting up the cache file
+
+struct CacheHeader
+{
+  u32 magic;
+  u32 revision;
+};
+
+struct RecordHeader
+{
+  u32 magic;
+  u32 live;
+  u32 metadata_size;
+  u32 images_size;
+  u64 file_size;
+  s64 file_modification_time;
+  u64 metadata_hash;
+  u64 images_hash;
+};
+static_assert(sizeof(RecordHeader) == 48, "The cache file layout must not depend on padding");
+
+// Reading metadata is mostly waiting for the disk (or network), so this doesn't have to be tied
+// to the number of cores, but too many threads would make a hard drive seek back and forth.
+static constexpr size_t MAX_PARSE_THREADS = 8;
+
+using Clock = std::chrono::steady_clock;
+
+static double ToMilliseconds(Clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static u64 HashBytes(const std::vector<u8>& data)
+{
+  const Common::SHA1::Digest digest = Common::SHA1::CalculateDigest(data.data(), data.size());
+  u64 hash;
+  std::memcpy(&hash, digest.data(), sizeof(hash));
+  return hash;
+}
+
+template <typename T>
+static std::vector<u8> Serialize(T* object)
+{
+  u8* ptr = nullptr;
+  PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+  object->DoState(p);
+  std::vector<u8> buffer(reinterpret_cast<size_t>(ptr));
+  ptr = buffer.data();
+  p.SetMode(PointerWrap::MODE_WRITE);
+  object->DoState(p);
+  return buffer;
+}
+
+template <typename T>
+static bool Deserialize(std::vector<u8>* buffer, T* object)
+{
+  u8* ptr = buffer->data();
+  PointerWrap p(&ptr, PointerWrap::MODE_READ);
+  object->DoState(p);
+  return p.GetMode() == PointerWrap::MODE_READ && ptr == buffer->data() + buffer->size();
+}
+
+// Where the images of a record are in the cache file. Shared with the loaders of the GameFiles
+// that were read from the record, so that they can follow the record when the file is rewritten.
+struct GameFileCache::ImageLocation
+{
+  bool Read(std::vector<u8>* data)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    File::IOFile f(path, "rb");
+    data->resize(size);
+    return f && f.Seek(offset, SEEK_SET) && f.ReadBytes(data->data(), data->size()) &&
+           HashBytes(*data) == hash;
+  }
+
+  std::mutex mutex;
+  std::string path;
+  u64 offset;
+  u32 size;
+  u64 hash;
+};
+
+bool GameFileCache::FileStamp::operator==(const FileStamp& other) const
+{
+  return size == other.size && modification_time == other.modification_time;
+}
+
+bool GameFileCache::FileStamp::operator!=(const FileStamp& other) const
+{
+  return !operator==(other);
+}
+
+GameFileCache::FileStamp GameFileCache::GetFileStamp(const std::string& path)
+{
+  const File::FileInfo info(path);
+  return {info.GetSize(), info.GetModificationTime()};
+}
 
 std::vector<std::string> FindAllGamePaths(const std::vector<std::string>& directories_to_scan,
                                           bool recursive_scan)
 {
   static const std::vector<std::string> search_extensions = {
-      ".gcm", ".tgc", ".iso", ".ciso", ".gcz", ".wbfs", ".wad", ".dol", ".elf"};
+      ".gcm", ".tgc", ".iso", ".ciso", ".gcz", ".dcz", ".wbfs", ".wad", ".dol", ".elf"};
 
   // TODO: We could process paths iteratively as they are found
   return Common::DoFileSearch(directories_to_scan, search_extensions, recursive_scan);
@@ -64,6 +172,9 @@ void GameFileCache::Clear(DeleteOnDisk delete_on_disk)
     File::Delete(m_path);
 
   m_cached_files.clear();
+  m_records.clear();
+  m_file_end = 0;
+  m_dead_bytes = 0;
 }
 
 std::shared_ptr<const GameFile> GameFileCache::AddOrGet(const std::string& path,
@@ -72,12 +183,21 @@ std::shared_ptr<const GameFile> GameFileCache::AddOrGet(const std::string& path,
   auto it = std::find_if(
       m_cached_files.begin(), m_cached_files.end(),
       [&path](const std::shared_ptr<GameFile>& file) { return file->GetFilePath() == path; });
+  const FileStamp stamp = GetFileStamp(path);
+  if (it != m_cached_files.end() && m_records[path].stamp != stamp)
+  {
+    // The file has been modified since it was read
+    *it = std::move(m_cached_files.back());
+    m_cached_files.pop_back();
+    it = m_cached_files.end();
+  }
   const bool found = it != m_cached_files.cend();
   if (!found)
   {
     std::shared_ptr<UICommon::GameFile> game = std::make_shared<GameFile>(path);
     if (!game->IsValid())
       return nullptr;
+    m_records[path].stamp = stamp;
     m_cached_files.emplace_back(std::move(game));
   }
   std::shared_ptr<GameFile>& result = found ? *it : m_cached_files.back();
@@ -95,6 +215,8 @@ bool GameFileCache::Update(
   // Copy game paths into a set, except ones that match DiscIO::ShouldHideFromGameList.
   // TODO: Prevent DoFileSearch from looking inside /files/ directories of DirectoryBlobs at all?
   // TODO: Make DoFileSearch support filter predicates so we don't have remove things afterwards?
+  const Clock::time_point scan_start = Clock::now();
+
   std::unordered_set<std::string> game_paths;
   game_paths.reserve(all_game_paths.size());
   for (const std::string& path : all_game_paths)
@@ -107,13 +229,19 @@ bool GameFileCache::Update(
 
   // Delete paths that aren't in game_paths from m_cached_files,
   // while simultaneously deleting paths that are in m_cached_files from game_paths.
+  // Files that have been modified since they were read are deleted from m_cached_files but
+  // stay in game_paths, so that they get read again.
   // For the sake of speed, we don't care about maintaining the order of m_cached_files.
+  size_t num_modified = 0;
   {
     auto it = m_cached_files.begin();
     auto end = m_cached_files.end();
     while (it != end)
     {
-      if (game_paths.erase((*it)->GetFilePath()))
+      const std::string& path = (*it)->GetFilePath();
+      const bool modified = game_paths.count(path) && GetFileStamp(path) != m_records[path].stamp;
+      num_modified += modified;
+      if (!modified && game_paths.erase(path))
       {
         ++it;
       }
@@ -130,22 +258,92 @@ bool GameFileCache::Update(
     m_cached_files.erase(it, m_cached_files.end());
   }
 
+  const Clock::time_point parse_start = Clock::now();
+  m_timings.scan_ms = ToMilliseconds(parse_start - scan_start);
+
   // Now that the previous loop has run, game_paths only contains paths that
   // aren't in m_cached_files, so we simply add all of them to m_cached_files.
-  for (const std::string& path : game_paths)
+  const size_t num_added =
+      AddGameFiles(std::vector<std::string>(game_paths.begin(), game_paths.end()),
+                   game_added_to_cache);
+  if (num_added != 0)
+    cache_changed = true;
+
+  m_timings.parse_ms = ToMilliseconds(Clock::now() - parse_start);
+  INFO_LOG(COMMON,
+           "Game list update: %zu paths, %zu new or modified (%zu modified) files read in %.1f ms, "
+           "scan took %.1f ms",
+           all_game_paths.size(), game_paths.size(), num_modified, m_timings.parse_ms,
+           m_timings.scan_ms);
+
+  return cache_changed;
+}
+
+size_t GameFileCache::AddGameFiles(
+    const std::vector<std::string>& paths,
+    const std::function<void(const std::shared_ptr<const GameFile>&)>& added)
+{
+  // Constructing a GameFile opens the file and reads its banner and names, which adds up for
+  // big libraries. Worker threads do that part, and this thread adds the results to
+  // m_cached_files as they come in, so that the callback still runs on the calling thread.
+  std::mutex mutex;
+  std::condition_variable cv;
+  using ParsedFile = std::pair<std::shared_ptr<GameFile>, FileStamp>;
+  std::vector<ParsedFile> finished;
+  std::atomic<size_t> next_path{0};
+
+  const size_t num_threads = std::min<size_t>(
+      paths.size(), std::min<size_t>(std::max(std::thread::hardware_concurrency(), 2u),
+                                     MAX_PARSE_THREADS));
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i)
   {
-    auto file = std::make_shared<GameFile>(path);
-    if (file->IsValid())
+    threads.emplace_back([&] {
+      for (size_t index = next_path++; index < paths.size(); index = next_path++)
+      {
+        // Getting the stamp first means that a modification while reading makes the next
+        // Update read the file again rather than miss the modification
+        const FileStamp stamp = GetFileStamp(paths[index]);
+        auto file = std::make_shared<GameFile>(paths[index]);
+        std::lock_guard<std::mutex> lk(mutex);
+        finished.emplace_back(std::move(file), stamp);
+        cv.notify_one();
+      }
+    });
+  }
+
+  size_t num_added = 0;
+  std::vector<ParsedFile> batch;
+  for (size_t num_handled = 0; num_handled < paths.size(); num_handled += batch.size())
+  {
+    batch.clear();
     {
-      if (game_added_to_cache)
-        game_added_to_cache(file);
+      std::unique_lock<std::mutex> lk(mutex);
+      cv.wait(lk, [&] { return !finished.empty(); });
+      std::swap(batch, finished);
+    }
 
-      cache_changed = true;
+    for (auto& parsed : batch)
+    {
+      std::shared_ptr<GameFile>& file = parsed.first;
+      if (!file->IsValid())
+        continue;
+
+      m_records[file->GetFilePath()].stamp = parsed.second;
+
+      if (added)
+        added(file);
+
+      ++num_added;
       m_cached_files.push_back(std::move(file));
     }
   }
 
-  return cache_changed;
+  for (std::thread& thread : threads)
+    thread.join();
+
+  return num_added;
 }
 
 bool GameFileCache::UpdateAdditionalMetadata(
@@ -198,79 +396,304 @@ bool GameFileCache::UpdateAdditionalMetadata(std::shared_ptr<GameFile>* game_fil
 
 bool GameFileCache::Load()
 {
-  return SyncCacheFile(false);
+  const Clock::time_point start = Clock::now();
+  const bool success = ReadCacheFile();
+  m_timings.serialize_ms = ToMilliseconds(Clock::now() - start);
+  INFO_LOG(COMMON, "Loaded game list cache with %zu files in %.1f ms", m_cached_files.size(),
+           m_timings.serialize_ms);
+  return success;
 }
 
 bool GameFileCache::Save()
 {
-  return SyncCacheFile(true);
+  const Clock::time_point start = Clock::now();
+  // The file is rewritten once more than half of it is dead records, or if something other
+  // than the last Load or Save has changed it
+  const bool in_place = m_file_end != 0 && m_dead_bytes <= m_file_end / 2 &&
+                        File::GetSize(m_path) == m_file_end;
+  const bool success = in_place ? UpdateCacheFile() : WriteCacheFile();
+  m_timings.serialize_ms = ToMilliseconds(Clock::now() - start);
+  INFO_LOG(COMMON, "Saved game list cache with %zu files %s in %.1f ms", m_cached_files.size(),
+           in_place ? "in place" : "to a new file", m_timings.serialize_ms);
+  return success;
 }
 
-bool GameFileCache::SyncCacheFile(bool save)
+bool GameFileCache::ReadCacheFile()
 {
-  const char* open_mode = save ? "wb" : "rb";
-  File::IOFile f(m_path, open_mode);
+  File::IOFile f(m_path, "rb");
   if (!f)
     return false;
-  bool success = false;
-  if (save)
+
+  CacheHeader header;
+  if (!f.ReadArray(&header, 1) || header.magic != CACHE_MAGIC ||
+      header.revision != CACHE_REVISION)
+  {
+    // Probably a cache from an older version of Dolphin
+    f.Close();
+    File::Delete(m_path);
+    return false;
+  }
+
+  m_cached_files.clear();
+  m_records.clear();
+  m_dead_bytes = 0;
+
+  // Only the headers and metadata are read. The images are skipped until they're needed.
+  const u64 file_size = f.GetSize();
+  u64 offset = sizeof(header);
+  bool clean = true;
+  std::vector<u8> metadata;
+  RecordHeader record;
+  while (offset < file_size)
   {
-    // Measure the size of the buffer.
-    u8* ptr = nullptr;
-    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-    DoState(&p);
-    const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-
-    // Then actually do the write.
-    std::vector<u8> buffer(buffer_size);
-    ptr = &buffer[0];
-    p.SetMode(PointerWrap::MODE_WRITE);
-    DoState(&p, buffer_size);
-    if (f.WriteBytes(buffer.data(), buffer.size()))
-      success = true;
+    if (!f.Seek(offset, SEEK_SET) || !f.ReadArray(&record, 1) || record.magic != RECORD_MAGIC)
+    {
+      clean = false;
+      break;
+    }
+
+    const u64 record_size = sizeof(record) + u64(record.metadata_size) + record.images_size;
+    if (!record.live)
+    {
+      m_dead_bytes += record_size;
+      offset += record_size;
+      continue;
+    }
+
+    // A record at the end may be incomplete if Dolphin crashed while appending it
+    metadata.resize(record.metadata_size);
+    auto file = std::make_shared<GameFile>();
+    if (offset + record_size > file_size || !f.ReadBytes(metadata.data(), metadata.size()) ||
+        HashBytes(metadata) != record.metadata_hash || !Deserialize(&metadata, file.get()))
+    {
+      clean = false;
+      break;
+    }
+
+    auto images = std::make_shared<ImageLocation>();
+    images->path = m_path;
+    images->offset = offset + sizeof(record) + record.metadata_size;
+    images->size = record.images_size;
+    images->hash = record.images_hash;
+    file->SetImageLoader([images](GameImages* out) {
+      std::vector<u8> data;
+      return images->Read(&data) && Deserialize(&data, out);
+    });
+
+    Record& entry = m_records[file->GetFilePath()];
+    if (entry.written)
+    {
+      // Left behind by a save that was interrupted. The later record is the current one.
+      clean = false;
+      m_cached_files.erase(std::find(m_cached_files.begin(), m_cached_files.end(), entry.written));
+    }
+    entry = {{record.file_size, record.file_modification_time}, file, offset, record_size, images};
+    m_cached_files.push_back(std::move(file));
+
+    offset += record_size;
   }
-  else
+
+  // Anything unexpected makes the next save write a new file
+  m_file_end = clean ? offset : 0;
+  return true;
+}
+
+bool GameFileCache::WriteCacheFile()
+{
+  // The new file is written next to the old one and then replaces it in one go, so that a crash
+  // or a second instance of Dolphin never sees a half-written cache. Images that haven't been
+  // loaded are copied over without deserializing them.
+  const std::string temp_path = m_path + ".tmp";
+  File::IOFile f(temp_path, "wb");
+  const CacheHeader header = {CACHE_MAGIC, CACHE_REVISION};
+  bool success = f.WriteArray(&header, 1);
+
+  struct Written
+  {
+    Record* record;
+    std::shared_ptr<GameFile> file;
+    u64 offset;
+    u64 size;
+    std::shared_ptr<ImageLocation> images;
+    u32 images_size;
+    u64 images_hash;
+  };
+  std::vector<Written> written;
+  written.reserve(m_cached_files.size());
+
+  u64 offset = sizeof(header);
+  for (const std::shared_ptr<GameFile>& file : m_cached_files)
   {
-    std::vector<u8> buffer(f.GetSize());
-    if (!buffer.empty() && f.ReadBytes(buffer.data(), buffer.size()))
+    if (!success)
+      break;
+
+    Record& record = m_records[file->GetFilePath()];
+    std::vector<u8> images;
+    bool relocated = false;
+    if (record.written == file && !file->AreImagesLoaded() && record.images)
+    {
+      // If the images can't be read, the file gets left out and will be read again next time
+      if (!record.images->Read(&images))
+        continue;
+      relocated = true;
+    }
+    else
     {
-      u8* ptr = buffer.data();
-      PointerWrap p(&ptr, PointerWrap::MODE_READ);
-      DoState(&p, buffer.size());
-      if (p.GetMode() == PointerWrap::MODE_READ)
-        success = true;
+      if (!file->LoadImages())
+        continue;
+      GameImages loaded_images = file->GetImages();
+      images = Serialize(&loaded_images);
     }
+    const std::vector<u8> metadata = Serialize(file.get());
+
+    const RecordHeader record_header = {RECORD_MAGIC,
+                                        1,
+                                        static_cast<u32>(metadata.size()),
+                                        static_cast<u32>(images.size()),
+                                        record.stamp.size,
+                                        record.stamp.modification_time,
+                                        HashBytes(metadata),
+                                        HashBytes(images)};
+    success = f.WriteArray(&record_header, 1) && f.WriteBytes(metadata.data(), metadata.size()) &&
+              f.WriteBytes(images.data(), images.size());
+
+    auto location = relocated ? record.images : std::make_shared<ImageLocation>();
+    const u64 size = sizeof(record_header) + metadata.size() + images.size();
+    written.push_back({&record, file, offset, size, std::move(location), record_header.images_size,
+                       record_header.images_hash});
+    offset += size;
   }
-  if (!success)
+
+  if (!success || !f.Close() || !File::Rename(temp_path, m_path))
   {
-    // If some file operation failed, try to delete the probably-corrupted cache
     f.Close();
-    File::Delete(m_path);
+    File::Delete(temp_path);
+    return false;
   }
-  return success;
+
+  // Loaders that read images in between the rename and this will simply try again later
+  std::unordered_set<const Record*> written_records;
+  written_records.reserve(written.size());
+  for (Written& w : written)
+  {
+    {
+      std::lock_guard<std::mutex> lk(w.images->mutex);
+      w.images->path = m_path;
+      w.images->offset = w.offset + w.size - w.images_size;
+      w.images->size = w.images_size;
+      w.images->hash = w.images_hash;
+    }
+    written_records.insert(w.record);
+    w.record->written = std::move(w.file);
+    w.record->offset = w.offset;
+    w.record->size = w.size;
+    w.record->images = std::move(w.images);
+  }
+
+  // Forget about files that were removed from the cache, and ones that couldn't be written
+  for (auto it = m_records.begin(); it != m_records.end();)
+  {
+    it = written_records.count(&it->second) ? std::next(it) : m_records.erase(it);
+  }
+
+  m_file_end = offset;
+  m_dead_bytes = 0;
+  return true;
 }
 
-void GameFileCache::DoState(PointerWrap* p, u64 size)
+bool GameFileCache::UpdateCacheFile()
 {
-  struct
+  // Files whose images can't be read can't be appended, but WriteCacheFile leaves them out
+  for (const std::shared_ptr<GameFile>& file : m_cached_files)
   {
-    u32 revision;
-    u64 expected_size;
-  } header = {CACHE_REVISION, size};
-  p->Do(header);
-  if (p->GetMode() == PointerWrap::MODE_READ)
+    const auto it = m_records.find(file->GetFilePath());
+    if ((it == m_records.end() || it->second.written != file) && !file->LoadImages())
+      return WriteCacheFile();
+  }
+
+  File::IOFile f(m_path, "r+b");
+  if (!f)
+    return WriteCacheFile();
+
+  std::vector<u8> appended;
+  std::vector<u64> dead_offsets;
+  std::unordered_set<std::string> paths;
+  paths.reserve(m_cached_files.size());
+  for (const std::shared_ptr<GameFile>& file : m_cached_files)
   {
-    if (header.revision != CACHE_REVISION || header.expected_size != size)
+    paths.insert(file->GetFilePath());
+    Record& record = m_records[file->GetFilePath()];
+    if (record.written == file)
+      continue;
+
+    if (record.written)
     {
-      p->SetMode(PointerWrap::MODE_MEASURE);
-      return;
+      dead_offsets.push_back(record.offset);
+      m_dead_bytes += record.size;
     }
+
+    GameImages loaded_images = file->GetImages();
+    const std::vector<u8> images = Serialize(&loaded_images);
+    const std::vector<u8> metadata = Serialize(file.get());
+    const RecordHeader record_header = {RECORD_MAGIC,
+                                        1,
+                                        static_cast<u32>(metadata.size()),
+                                        static_cast<u32>(images.size()),
+                                        record.stamp.size,
+                                        record.stamp.modification_time,
+                                        HashBytes(metadata),
+                                        HashBytes(images)};
+
+    record.written = file;
+    record.offset = m_file_end + appended.size();
+    record.size = sizeof(record_header) + metadata.size() + images.size();
+    record.images = std::make_shared<ImageLocation>();
+    record.images->path = m_path;
+    record.images->offset = record.offset + record.size - images.size();
+    record.images->size = static_cast<u32>(images.size());
+    record.images->hash = record_header.images_hash;
+
+    const u8* header_ptr = reinterpret_cast<const u8*>(&record_header);
+    appended.insert(appended.end(), header_ptr, header_ptr + sizeof(record_header));
+    appended.insert(appended.end(), metadata.begin(), metadata.end());
+    appended.insert(appended.end(), images.begin(), images.end());
   }
-  p->DoEachElement(m_cached_files, [](PointerWrap& state, std::shared_ptr<GameFile>& elem) {
-    if (state.GetMode() == PointerWrap::MODE_READ)
-      elem = std::make_shared<GameFile>();
-    elem->DoState(state);
-  });
+
+  for (auto it = m_records.begin(); it != m_records.end();)
+  {
+    if (paths.count(it->first))
+    {
+      ++it;
+      continue;
+    }
+
+    if (it->second.written)
+    {
+      dead_offsets.push_back(it->second.offset);
+      m_dead_bytes += it->second.size;
+    }
+    it = m_records.erase(it);
+  }
+
+  // The new records are appended before the old ones are marked as dead, so that a crash in
+  // between leaves duplicates (which ReadCacheFile handles) rather than missing files.
+  bool success = f.Seek(m_file_end, SEEK_SET) && f.WriteBytes(appended.data(), appended.size()) &&
+                 f.Flush();
+  const u32 dead = 0;
+  for (u64 dead_offset : dead_offsets)
+  {
+    success = success && f.Seek(dead_offset + offsetof(RecordHeader, live), SEEK_SET) &&
+              f.WriteArray(&dead, 1);
+  }
+
+  if (!success || !f.Close())
+  {
+    m_file_end = 0;
+    return false;
+  }
+
+  m_file_end += appended.size();
+  return true;
 }
 
 }  // namespace DiscIO
@@ -8,12 +8,11 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
 
-class PointerWrap;
-
 namespace UICommon
 {
 class GameFile;
@@ -30,6 +29,17 @@ public:
     Yes = 1,
   };
 
+  // How long the phases of the last Update, Load and Save took
+  struct Timings
+  {
+    // Comparing the paths that were found with the cached files
+    double scan_ms = 0;
+    // Reading the metadata of the files that weren't cached
+    double parse_ms = 0;
+    // The last Load or Save
+    double serialize_ms = 0;
+  };
+
   GameFileCache();  // Uses the default path
   explicit GameFileCache(std::string path);
 
@@ -51,14 +61,56 @@ public:
   bool Load();
   bool Save();
 
+  const Timings& GetTimings() const { return m_timings; }
+
 private:
+  // Adds the valid files among paths, which must not be in the cache yet.
+  // Returns how many were added.
+  size_t AddGameFiles(const std::vector<std::string>& paths,
+                      const std::function<void(const std::shared_ptr<const GameFile>&)>& added);
   bool UpdateAdditionalMetadata(std::shared_ptr<GameFile>* game_file);
 
-  bool SyncCacheFile(bool save);
-  void DoState(PointerWrap* p, u64 size = 0);
+  // Identifies a version of a game file without reading it
+  struct FileStamp
+  {
+    u64 size = 0;
+    s64 modification_time = 0;
+    bool operator==(const FileStamp& other) const;
+    bool operator!=(const FileStamp& other) const;
+  };
+  static FileStamp GetFileStamp(const std::string& path);
+
+  struct ImageLocation;
+
+  // The cache file consists of one record per game file, with the images at the end of the
+  // record so that loading the cache can skip them. Records that are outdated are marked as
+  // dead, and new records are appended, until the dead records take up too much space.
+  struct Record
+  {
+    // Of the game file when the GameFile was created
+    FileStamp stamp;
+    // The GameFile that the record on disk is for, or nullptr if there is no record on disk.
+    // Changed GameFiles are replaced instead of modified, so comparing pointers is enough
+    // to tell whether the record is outdated.
+    std::shared_ptr<const GameFile> written;
+    u64 offset = 0;
+    u64 size = 0;
+    std::shared_ptr<ImageLocation> images;
+  };
+
+  bool ReadCacheFile();
+  // Writes a new cache file with a record for every file in the cache.
+  bool WriteCacheFile();
+  // Marks the outdated records in the existing cache file as dead and appends new records.
+  bool UpdateCacheFile();
 
   std::string m_path;
   std::vector<std::shared_ptr<GameFile>> m_cached_files;
+  std::unordered_map<std::string, Record> m_records;
+  // The size of the cache file as of the last Load or Save, or 0 if it has to be rewritten
+  u64 m_file_end = 0;
+  u64 m_dead_bytes = 0;
+  Timings m_timings;
 };
 
 }  // namespace UICommon
@@ -31,6 +31,9 @@
 #include "Core/IOS/IOS.h"
 #include "Core/IOS/STM/STM.h"
 
+#include "DiscIO/FileBlob.h"
+#include "DiscIO/SharedChunkCache.h"
+
 #include "InputCommon/GCAdapter.h"
 
 #include "UICommon/DiscordPresence.h"
@@ -70,10 +73,29 @@ static void InitCustomPaths()
     File::SetUserPath(F_WIISDCARD_IDX, sd_path);
 }
 
+static int s_shared_chunk_cache_size_mib = 0;
+
+static void InitSharedChunkCache()
+{
+  const int size_mib = std::max(Config::Get(Config::MAIN_SHARED_CHUNK_CACHE_SIZE), 0);
+  if (size_mib == s_shared_chunk_cache_size_mib)
+    return;
+  s_shared_chunk_cache_size_mib = size_mib;
+
+  DiscIO::SharedChunkCache::SetGlobal("dolphin-chunks", u64(size_mib) << 20);
+}
+
+static void InitDiscImageMapping()
+{
+  DiscIO::PlainFileReader::SetMappingEnabled(Config::Get(Config::MAIN_MAP_DISC_IMAGES));
+}
+
 void Init()
 {
   Config::Init();
   Config::AddConfigChangedCallback(InitCustomPaths);
+  Config::AddConfigChangedCallback(InitSharedChunkCache);
+  Config::AddConfigChangedCallback(InitDiscImageMapping);
   Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
   SConfig::Init();
   Discord::Init();
@@ -94,6 +116,9 @@ void Shutdown()
   LogManager::Shutdown();
   Discord::Shutdown();
   SConfig::Shutdown();
+  DiscIO::SharedChunkCache::SetGlobal("", 0);
+  s_shared_chunk_cache_size_mib = 0;
+  DiscIO::PlainFileReader::SetMappingEnabled(false);
   Config::Shutdown();
 }
 
@@ -50,6 +50,7 @@ static const u64 TEXHASH_INVALID = 0;
 // Sonic the Fighters (inside Sonic Gems Collection) loops a 64 frames animation
 static const int TEXTURE_KILL_THRESHOLD = 64;
 static const int TEXTURE_POOL_KILL_THRESHOLD = 3;
+static const size_t MAX_MEMORY_HASHES = 16384;
 
 std::unique_ptr<TextureCacheBase> g_texture_cache;
 
@@ -86,10 +87,11 @@ TextureCacheBase::TextureCacheBase()
 
   TexDecoder_SetTexFmtOverlayOptions(backup_config.texfmt_overlay,
                                      backup_config.texfmt_overlay_center);
+  TexDecoder_SetDecodingThreads(g_ActiveConfig.GetTextureDecodingThreads());
 
   HiresTexture::Init();
 
-  Common::SetHash64Function();
+  Common::SetHash64Function(g_ActiveConfig.bFullTextureHash);
 
   InvalidateAllBindPoints();
 }
@@ -101,6 +103,7 @@ TextureCacheBase::~TextureCacheBase()
 
   HiresTexture::Shutdown();
   Invalidate();
+  TexDecoder_SetDecodingThreads(0);
   Common::FreeAlignedMemory(temp);
   temp = nullptr;
 }
@@ -125,12 +128,12 @@ void TextureCacheBase::Invalidate()
     bound_textures[i] = nullptr;
   }
 
-  for (auto& tex : textures_by_address)
-  {
-    delete tex.second;
-  }
+  TexAddrCache::iterator iter = textures_by_address.begin();
+  while (iter != textures_by_address.end())
+    delete *iter++;
   textures_by_address.clear();
   textures_by_hash.clear();
+  m_memory_hashes.clear();
 
   texture_pool.clear();
 }
@@ -145,6 +148,7 @@ void TextureCacheBase::OnConfigChanged(VideoConfig& config)
 
   // TODO: Invalidating texcache is really stupid in some of these cases
   if (config.iSafeTextureCache_ColorSamples != backup_config.color_samples ||
+      config.bFullTextureHash != backup_config.full_texture_hash ||
       config.bTexFmtOverlayEnable != backup_config.texfmt_overlay ||
       config.bTexFmtOverlayCenter != backup_config.texfmt_overlay_center ||
       config.bHiresTextures != backup_config.hires_textures ||
@@ -153,11 +157,14 @@ void TextureCacheBase::OnConfigChanged(VideoConfig& config)
       config.bArbitraryMipmapDetection != backup_config.arbitrary_mipmap_detection)
   {
     Invalidate();
+    Common::SetHash64Function(config.bFullTextureHash);
 
     TexDecoder_SetTexFmtOverlayOptions(g_ActiveConfig.bTexFmtOverlayEnable,
                                        g_ActiveConfig.bTexFmtOverlayCenter);
   }
 
+  TexDecoder_SetDecodingThreads(config.GetTextureDecodingThreads());
+
   SetBackupConfig(config);
 }
 
@@ -167,25 +174,26 @@ void TextureCacheBase::Cleanup(int _frameCount)
   TexAddrCache::iterator tcend = textures_by_address.end();
   while (iter != tcend)
   {
-    if (iter->second->tmem_only)
+    TCacheEntry* entry = *iter;
+    if (entry->tmem_only)
     {
       iter = InvalidateTexture(iter);
     }
-    else if (iter->second->frameCount == FRAMECOUNT_INVALID)
+    else if (entry->frameCount == FRAMECOUNT_INVALID)
     {
-      iter->second->frameCount = _frameCount;
+      entry->frameCount = _frameCount;
       ++iter;
     }
-    else if (_frameCount > TEXTURE_KILL_THRESHOLD + iter->second->frameCount)
+    else if (_frameCount > TEXTURE_KILL_THRESHOLD + entry->frameCount)
     {
-      if (iter->second->IsCopy())
+      if (entry->IsCopy())
       {
         // Only remove EFB copies when they wouldn't be used anymore(changed hash), because EFB
         // copies living on the
         // host GPU are unrecoverable. Perform this check only every TEXTURE_KILL_THRESHOLD for
         // performance reasons
-        if ((_frameCount - iter->second->frameCount) % TEXTURE_KILL_THRESHOLD == 1 &&
-            iter->second->hash != iter->second->CalculateHash())
+        if ((_frameCount - entry->frameCount) % TEXTURE_KILL_THRESHOLD == 1 &&
+            entry->hash != entry->CalculateHash())
         {
           iter = InvalidateTexture(iter);
         }
@@ -238,6 +246,7 @@ bool TextureCacheBase::TCacheEntry::OverlapsMemoryRange(u32 range_address, u32 r
 void TextureCacheBase::SetBackupConfig(const VideoConfig& config)
 {
   backup_config.color_samples = config.iSafeTextureCache_ColorSamples;
+  backup_config.full_texture_hash = config.bFullTextureHash;
   backup_config.texfmt_overlay = config.bTexFmtOverlayEnable;
   backup_config.texfmt_overlay_center = config.bTexFmtOverlayCenter;
   backup_config.hires_textures = config.bHiresTextures;
@@ -270,7 +279,7 @@ TextureCacheBase::ApplyPaletteToEntry(TCacheEntry* entry, u8* palette, TLUTForma
   decoded_entry->may_have_overlapping_textures = entry->may_have_overlapping_textures;
 
   ConvertTexture(decoded_entry, entry, palette, tlutfmt);
-  textures_by_address.emplace(entry->addr, decoded_entry);
+  textures_by_address.insert(entry->addr, decoded_entry);
 
   return decoded_entry;
 }
@@ -341,7 +350,7 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
   auto iter = FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes);
   while (iter.first != iter.second)
   {
-    TCacheEntry* entry = iter.first->second;
+    TCacheEntry* entry = *iter.first;
     if (entry != entry_to_update && entry->IsCopy() && !entry->tmem_only &&
         entry->references.count(entry_to_update) == 0 &&
         entry->OverlapsMemoryRange(entry_to_update->addr, entry_to_update->size_in_bytes) &&
@@ -749,7 +758,7 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
   const u32 tmem_address_odd = from_tmem ? tex.texImage2[id].tmem_odd * TMEM_LINE_SIZE : 0;
 
   auto entry = GetTexture(address, width, height, texformat,
-                          g_ActiveConfig.iSafeTextureCache_ColorSamples, tlutaddr, tlutfmt,
+                          g_ActiveConfig.GetTextureCacheSamples(), tlutaddr, tlutfmt,
                           use_mipmaps, tex_levels, from_tmem, tmem_address_even, tmem_address_odd);
 
   if (!entry)
@@ -765,6 +774,33 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
   return entry;
 }
 
+u64 TextureCacheBase::HashTextureMemory(u32 address, const u8* src, u32 size, int samples)
+{
+  u64 write_count;
+  if (!g_ActiveConfig.bTrackTextureWrites ||
+      !Memory::GetWriteCount(address, size, false, &write_count))
+  {
+    return Common::GetHash64(src, size, samples);
+  }
+
+  auto iter = m_memory_hashes.find(address);
+  if (iter != m_memory_hashes.end() && iter->second.size == size &&
+      iter->second.samples == samples && iter->second.write_count == write_count)
+  {
+    return iter->second.hash;
+  }
+
+  // Start tracking before hashing, so that a write while hashing changes the count
+  Memory::GetWriteCount(address, size, true, &write_count);
+  const u64 hash = Common::GetHash64(src, size, samples);
+
+  // Every address games have ever used a texture at adds up over time
+  if (iter == m_memory_hashes.end() && m_memory_hashes.size() >= MAX_MEMORY_HASHES)
+    m_memory_hashes.clear();
+  m_memory_hashes[address] = {size, samples, write_count, hash};
+  return hash;
+}
+
 TextureCacheBase::TCacheEntry*
 TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFormat texformat,
                              const int textureCacheSafetyColorSampleSize, u32 tlutaddr,
@@ -837,7 +873,15 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
 
   // TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data
   // from the low tmem bank than it should)
-  base_hash = Common::GetHash64(src_data, texture_size, textureCacheSafetyColorSampleSize);
+  if (from_tmem)
+  {
+    base_hash = Common::GetHash64(src_data, texture_size, textureCacheSafetyColorSampleSize);
+  }
+  else
+  {
+    base_hash =
+        HashTextureMemory(address, src_data, texture_size, textureCacheSafetyColorSampleSize);
+  }
   u32 palette_size = 0;
   if (isPaletteTexture)
   {
@@ -897,7 +941,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
 
   while (iter != iter_range.second)
   {
-    TCacheEntry* entry = iter->second;
+    TCacheEntry* entry = *iter;
 
     // Skip entries that are only left in our texture cache for the tmem cache emulation
     if (entry->tmem_only)
@@ -952,7 +996,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
           entry->native_levels >= tex_levels && entry->native_width == nativeW &&
           entry->native_height == nativeH)
       {
-        entry = DoPartialTextureUpdates(iter->second, &texMem[tlutaddr], tlutfmt);
+        entry = DoPartialTextureUpdates(*iter, &texMem[tlutaddr], tlutfmt);
         entry->texture->FinishedRendering();
         return entry;
       }
@@ -977,7 +1021,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   if (unconverted_copy != textures_by_address.end())
   {
     TCacheEntry* decoded_entry =
-        ApplyPaletteToEntry(unconverted_copy->second, &texMem[tlutaddr], tlutfmt);
+        ApplyPaletteToEntry(*unconverted_copy, &texMem[tlutaddr], tlutfmt);
 
     if (decoded_entry)
     {
@@ -998,12 +1042,12 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
     TexHashCache::iterator hash_iter = hash_range.first;
     while (hash_iter != hash_range.second)
     {
-      TCacheEntry* entry = hash_iter->second;
+      TCacheEntry* entry = *hash_iter;
       // All parameters, except the address, need to match here
       if (entry->format == full_format && entry->native_levels >= tex_levels &&
           entry->native_width == nativeW && entry->native_height == nativeH)
       {
-        entry = DoPartialTextureUpdates(hash_iter->second, &texMem[tlutaddr], tlutfmt);
+        entry = DoPartialTextureUpdates(*hash_iter, &texMem[tlutaddr], tlutfmt);
         entry->texture->FinishedRendering();
         return entry;
       }
@@ -1114,11 +1158,11 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
     }
   }
 
-  iter = textures_by_address.emplace(address, entry);
+  iter = textures_by_address.insert(address, entry);
   if (textureCacheSafetyColorSampleSize == 0 ||
       std::max(texture_size, palette_size) <= (u32)textureCacheSafetyColorSampleSize * 8)
   {
-    entry->textures_by_hash_iter = textures_by_hash.emplace(full_hash, entry);
+    textures_by_hash.insert(full_hash, entry);
   }
 
   entry->SetGeneralParameters(address, texture_size, full_format, false);
@@ -1157,6 +1201,11 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       ptr_odd = &texMem[tmem_address_odd];
     }
 
+    // The levels that are decoded on the CPU are decoded together, so that the small ones can be
+    // decoded at the same time instead of one after another.
+    std::vector<TextureDecodeLevel> cpu_levels;
+    std::vector<u32> cpu_level_indices;
+
     for (u32 level = 1; level != texLevels; ++level)
     {
       const u32 mip_width = CalculateLevelSize(width, level);
@@ -1175,18 +1224,28 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       {
         // No need to call CheckTempSize here, as the whole buffer is preallocated at the beginning
         const u32 decoded_mip_size = expanded_mip_width * sizeof(u32) * expanded_mip_height;
-        TexDecoder_Decode(dst_buffer, mip_src_data, expanded_mip_width, expanded_mip_height,
-                          texformat, tlut, tlutfmt);
-        entry->texture->Load(level, mip_width, mip_height, expanded_mip_width, dst_buffer,
-                             decoded_mip_size);
-
-        arbitrary_mip_detector.AddLevel(mip_width, mip_height, expanded_mip_width, dst_buffer);
+        cpu_levels.push_back({dst_buffer, mip_src_data, static_cast<int>(expanded_mip_width),
+                              static_cast<int>(expanded_mip_height)});
+        cpu_level_indices.push_back(level);
 
         dst_buffer += decoded_mip_size;
       }
 
       mip_src_data += mip_size;
     }
+
+    TexDecoder_DecodeLevels(cpu_levels.data(), cpu_levels.size(), texformat, tlut, tlutfmt);
+    for (size_t i = 0; i < cpu_levels.size(); ++i)
+    {
+      const TextureDecodeLevel& decoded = cpu_levels[i];
+      const u32 level = cpu_level_indices[i];
+      const u32 mip_width = CalculateLevelSize(width, level);
+      const u32 mip_height = CalculateLevelSize(height, level);
+      entry->texture->Load(level, mip_width, mip_height, decoded.width, decoded.dst,
+                           decoded.width * sizeof(u32) * decoded.height);
+
+      arbitrary_mip_detector.AddLevel(mip_width, mip_height, decoded.width, decoded.dst);
+    }
   }
 
   entry->has_arbitrary_mips = hires_tex ? hires_tex->HasArbitraryMipmaps() :
@@ -1203,7 +1262,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   INCSTAT(stats.numTexturesUploaded);
   SETSTAT(stats.numTexturesAlive, textures_by_address.size());
 
-  entry = DoPartialTextureUpdates(iter->second, &texMem[tlutaddr], tlutfmt);
+  entry = DoPartialTextureUpdates(*iter, &texMem[tlutaddr], tlutfmt);
 
   // This should only be needed if the texture was updated, or used GPU decoding.
   entry->texture->FinishedRendering();
@@ -1276,7 +1335,7 @@ TextureCacheBase::GetXFBTexture(u32 address, u32 width, u32 height, u32 stride,
   entry->texture->FinishedRendering();
 
   // Insert into the texture cache so we can re-use it next frame, if needed.
-  textures_by_address.emplace(entry->addr, entry);
+  textures_by_address.insert(entry->addr, entry);
   SETSTAT(stats.numTexturesAlive, textures_by_address.size());
   INCSTAT(stats.numTexturesUploaded);
 
@@ -1303,7 +1362,7 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::GetXFBFromCache(u32 address, u3
 
   while (iter != iter_range.second)
   {
-    TCacheEntry* entry = iter->second;
+    TCacheEntry* entry = *iter;
 
     // The only thing which has to match exactly is the stride. We can use a partial rectangle if
     // the VI width/height differs from that of the XFB copy.
@@ -1357,7 +1416,7 @@ void TextureCacheBase::StitchXFBCopy(TCacheEntry* stitched_entry)
     // our force progressive hack means that an XFB copy should always have a matching stride. If
     // the hack is disabled, XFB2RAM should also be enabled. Should we wish to implement interlaced
     // stitching in the future, this would require a shader which grabs every second line.
-    TCacheEntry* entry = iter.first->second;
+    TCacheEntry* entry = *iter.first;
     if (entry != stitched_entry && entry->IsCopy() && !entry->tmem_only &&
         entry->OverlapsMemoryRange(stitched_entry->addr, stitched_entry->size_in_bytes) &&
         entry->memory_stride == stitched_entry->memory_stride)
@@ -1774,7 +1833,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(
   auto iter = FindOverlappingTextures(dstAddr, covered_range);
   while (iter.first != iter.second)
   {
-    TCacheEntry* overlapping_entry = iter.first->second;
+    TCacheEntry* overlapping_entry = *iter.first;
 
     if (overlapping_entry->addr == dstAddr && overlapping_entry->is_xfb_copy)
     {
@@ -1820,11 +1879,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(
 
       // Do not load textures by hash, if they were at least partly overwritten by an efb copy.
       // In this case, comparing the hash is not enough to check, if two textures are identical.
-      if (overlapping_entry->textures_by_hash_iter != textures_by_hash.end())
-      {
-        textures_by_hash.erase(overlapping_entry->textures_by_hash_iter);
-        overlapping_entry->textures_by_hash_iter = textures_by_hash.end();
-      }
+      textures_by_hash.erase(overlapping_entry);
     }
     ++iter.first;
   }
@@ -1847,7 +1902,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(
   {
     const u64 hash = entry->CalculateHash();
     entry->SetHashes(hash, hash);
-    textures_by_address.emplace(dstAddr, entry);
+    textures_by_address.insert(dstAddr, entry);
   }
 }
 
@@ -1898,7 +1953,7 @@ void TextureCacheBase::FlushEFBCopy(TCacheEntry* entry)
     auto range = FindOverlappingTextures(entry->addr, covered_range);
     for (auto iter = range.first; iter != range.second; ++iter)
     {
-      TCacheEntry* overlapping_entry = iter->second;
+      TCacheEntry* overlapping_entry = *iter;
       if (overlapping_entry->may_have_overlapping_textures && overlapping_entry->is_xfb_copy &&
           overlapping_entry->OverlapsMemoryRange(entry->addr, covered_range))
       {
@@ -1983,7 +2038,6 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::AllocateCacheEntry(const Textur
 
   TCacheEntry* cacheEntry =
       new TCacheEntry(std::move(alloc->texture), std::move(alloc->framebuffer));
-  cacheEntry->textures_by_hash_iter = textures_by_hash.end();
   cacheEntry->id = last_entry_id++;
   return cacheEntry;
 }
@@ -2038,22 +2092,6 @@ TextureCacheBase::FindMatchingTextureFromPool(const TextureConfig& config)
   return matching_iter != range.second ? matching_iter : texture_pool.end();
 }
 
-TextureCacheBase::TexAddrCache::iterator
-TextureCacheBase::GetTexCacheIter(TextureCacheBase::TCacheEntry* entry)
-{
-  auto iter_range = textures_by_address.equal_range(entry->addr);
-  TexAddrCache::iterator iter = iter_range.first;
-  while (iter != iter_range.second)
-  {
-    if (iter->second == entry)
-    {
-      return iter;
-    }
-    ++iter;
-  }
-  return textures_by_address.end();
-}
-
 std::pair<TextureCacheBase::TexAddrCache::iterator, TextureCacheBase::TexAddrCache::iterator>
 TextureCacheBase::FindOverlappingTextures(u32 addr, u32 size_in_bytes)
 {
@@ -2077,13 +2115,9 @@ TextureCacheBase::InvalidateTexture(TexAddrCache::iterator iter, bool discard_pe
   if (iter == textures_by_address.end())
     return textures_by_address.end();
 
-  TCacheEntry* entry = iter->second;
+  TCacheEntry* entry = *iter;
 
-  if (entry->textures_by_hash_iter != textures_by_hash.end())
-  {
-    textures_by_hash.erase(entry->textures_by_hash_iter);
-    entry->textures_by_hash_iter = textures_by_hash.end();
-  }
+  textures_by_hash.erase(entry);
 
   for (size_t i = 0; i < bound_textures.size(); ++i)
   {
@@ -2127,11 +2161,13 @@ TextureCacheBase::InvalidateTexture(TexAddrCache::iterator iter, bool discard_pe
   texture_pool.emplace(config,
                        TexPoolEntry(std::move(entry->texture), std::move(entry->framebuffer)));
 
+  iter = textures_by_address.erase(iter);
+
   // Don't delete if there's a pending EFB copy, as we need the TCacheEntry alive.
   if (!entry->pending_efb_copy)
     delete entry;
 
-  return textures_by_address.erase(iter);
+  return iter;
 }
 
 bool TextureCacheBase::CreateUtilityTextures()
@@ -2469,7 +2505,7 @@ int TextureCacheBase::TCacheEntry::HashSampleSize() const
     return 0;
   }
 
-  return g_ActiveConfig.iSafeTextureCache_ColorSamples;
+  return g_ActiveConfig.GetTextureCacheSamples();
 }
 
 u64 TextureCacheBase::TCacheEntry::CalculateHash() const
@@ -6,7 +6,6 @@
 
 #include <array>
 #include <bitset>
-#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -18,6 +17,7 @@
 #include "Common/CommonTypes.h"
 #include "VideoCommon/AbstractTexture.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/TextureCacheIndex.h"
 #include "VideoCommon/TextureConfig.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoCommon.h"
@@ -114,9 +114,9 @@ public:
     // used to delete textures which haven't been used for TEXTURE_KILL_THRESHOLD frames
     int frameCount = FRAMECOUNT_INVALID;
 
-    // Keep an iterator to the entry in textures_by_hash, so it does not need to be searched when
-    // removing the cache entry
-    std::multimap<u64, TCacheEntry*>::iterator textures_by_hash_iter;
+    // Links for textures_by_address and textures_by_hash
+    VideoCommon::IndexLink<TCacheEntry, u32> address_link;
+    VideoCommon::IndexLink<TCacheEntry, u64> hash_link;
 
     // This is used to keep track of both:
     //   * efb copies used by this partially updated texture
@@ -269,8 +269,8 @@ private:
 
     TexPoolEntry(std::unique_ptr<AbstractTexture> tex, std::unique_ptr<AbstractFramebuffer> fb);
   };
-  using TexAddrCache = std::multimap<u32, TCacheEntry*>;
-  using TexHashCache = std::multimap<u64, TCacheEntry*>;
+  using TexAddrCache = VideoCommon::AddressIndex<TCacheEntry, &TCacheEntry::address_link>;
+  using TexHashCache = VideoCommon::HashIndex<TCacheEntry, &TCacheEntry::hash_link>;
   using TexPool = std::unordered_multimap<TextureConfig, TexPoolEntry>;
 
   bool CreateUtilityTextures();
@@ -291,7 +291,6 @@ private:
   TCacheEntry* AllocateCacheEntry(const TextureConfig& config);
   std::optional<TexPoolEntry> AllocateTexture(const TextureConfig& config);
   TexPool::iterator FindMatchingTextureFromPool(const TextureConfig& config);
-  TexAddrCache::iterator GetTexCacheIter(TCacheEntry* entry);
 
   // Return all possible overlapping textures. As addr+size of the textures is not
   // indexed, this may return false positives.
@@ -304,6 +303,9 @@ private:
 
   void UninitializeXFBMemory(u8* dst, u32 stride, u32 bytes_per_row, u32 num_blocks_y);
 
+  // Hashes a texture in RAM, or reuses the last hash of it if the memory wasn't written since.
+  u64 HashTextureMemory(u32 address, const u8* src, u32 size, int samples);
+
   // Precomputing the coefficients for the previous, current, and next lines for the copy filter.
   static EFBCopyFilterCoefficients
   GetRAMCopyFilterCoefficients(const CopyFilterCoefficients::Values& coefficients);
@@ -326,10 +328,21 @@ private:
   TexPool texture_pool;
   u64 last_entry_id = 0;
 
+  // The last hash of each texture address, for bTrackTextureWrites
+  struct MemoryHash
+  {
+    u32 size;
+    int samples;
+    u64 write_count;
+    u64 hash;
+  };
+  std::unordered_map<u32, MemoryHash> m_memory_hashes;
+
   // Backup configuration values
   struct BackupConfig
   {
     int color_samples;
+    bool full_texture_hash;
     bool texfmt_overlay;
     bool texfmt_overlay_center;
     bool hires_textures;
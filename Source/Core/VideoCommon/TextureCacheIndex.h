@@ -0,0 +1,375 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "Common/BitSet.h"
+#include "Common/CommonTypes.h"
+
+// Indexes for the texture cache. Both are intrusive: the links live in the entries themselves, so
+// inserting and removing entries never allocates, and walking an index touches nothing but the
+// entries. Entries with equal keys are kept in insertion order, and iterators stay valid when
+// other entries are inserted or removed, just like with std::multimap.
+
+namespace VideoCommon
+{
+template <typename T, typename Key>
+struct IndexLink
+{
+  T* prev = nullptr;
+  T* next = nullptr;
+  Key key = 0;
+  bool linked = false;
+};
+
+// Forward iterator over entries linked through Link. Dereferences to the entry pointer.
+template <typename T, typename Key, IndexLink<T, Key> T::*Link>
+class IndexIterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = T*;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T* const*;
+  using reference = T* const&;
+
+  IndexIterator() = default;
+  explicit IndexIterator(T* entry) : m_entry(entry) {}
+
+  reference operator*() const { return m_entry; }
+  IndexIterator& operator++()
+  {
+    m_entry = (m_entry->*Link).next;
+    return *this;
+  }
+  IndexIterator operator++(int)
+  {
+    IndexIterator old = *this;
+    ++*this;
+    return old;
+  }
+  bool operator==(const IndexIterator& other) const { return m_entry == other.m_entry; }
+  bool operator!=(const IndexIterator& other) const { return m_entry != other.m_entry; }
+
+private:
+  T* m_entry = nullptr;
+};
+
+// Entries sorted by their address. All entries form one list in address order, and a directory
+// with the first entry of every 4 KiB page turns finding the start of a range into an array
+// lookup. A bitmap of the pages that have entries lets range queries skip empty pages 64 at a
+// time, which matters because overlap queries look back as far as the biggest texture.
+template <typename T, IndexLink<T, u32> T::*Link>
+class AddressIndex
+{
+public:
+  using iterator = IndexIterator<T, u32, Link>;
+
+  iterator begin() const { return iterator(m_head); }
+  iterator end() const { return iterator(); }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  // The first entry with an address >= addr
+  iterator lower_bound(u32 addr) const { return iterator(FindFirst(addr, false)); }
+  // The first entry with an address > addr
+  iterator upper_bound(u32 addr) const { return iterator(FindFirst(addr, true)); }
+  std::pair<iterator, iterator> equal_range(u32 addr) const
+  {
+    return {lower_bound(addr), upper_bound(addr)};
+  }
+
+  // Inserts the entry after all entries with the same address.
+  iterator insert(u32 addr, T* entry)
+  {
+    IndexLink<T, u32>& link = entry->*Link;
+    T* const next = FindFirst(addr, true);
+    T* const prev = next ? (next->*Link).prev : m_tail;
+    link.prev = prev;
+    link.next = next;
+    link.key = addr;
+    link.linked = true;
+    (prev ? (prev->*Link).next : m_head) = entry;
+    (next ? (next->*Link).prev : m_tail) = entry;
+    ++m_size;
+
+    const u32 page = addr >> PAGE_SHIFT;
+    if (page >= m_first_in_page.size())
+    {
+      m_first_in_page.resize(page + 1);
+      m_used_pages.resize(page / 64 + 1);
+    }
+    if (!prev || ((prev->*Link).key >> PAGE_SHIFT) != page)
+    {
+      m_first_in_page[page] = entry;
+      m_used_pages[page / 64] |= u64(1) << (page % 64);
+    }
+
+    return iterator(entry);
+  }
+
+  // Removes the entry and returns the entry after it.
+  iterator erase(iterator iter)
+  {
+    T* const entry = *iter;
+    IndexLink<T, u32>& link = entry->*Link;
+    T* const next = link.next;
+
+    const u32 page = link.key >> PAGE_SHIFT;
+    if (m_first_in_page[page] == entry)
+    {
+      if (next && ((next->*Link).key >> PAGE_SHIFT) == page)
+      {
+        m_first_in_page[page] = next;
+      }
+      else
+      {
+        m_first_in_page[page] = nullptr;
+        m_used_pages[page / 64] &= ~(u64(1) << (page % 64));
+      }
+    }
+
+    (link.prev ? (link.prev->*Link).next : m_head) = next;
+    (next ? (next->*Link).prev : m_tail) = link.prev;
+    link = {};
+    --m_size;
+
+    return iterator(next);
+  }
+
+  // Forgets all entries without touching them, for when they have already been deleted.
+  void clear()
+  {
+    m_head = nullptr;
+    m_tail = nullptr;
+    m_size = 0;
+    std::fill(m_first_in_page.begin(), m_first_in_page.end(), nullptr);
+    std::fill(m_used_pages.begin(), m_used_pages.end(), 0);
+  }
+
+private:
+  static constexpr u32 PAGE_SHIFT = 12;
+
+  T* FindFirst(u32 addr, bool greater) const
+  {
+    u32 page = addr >> PAGE_SHIFT;
+    if (page >= m_first_in_page.size())
+      return nullptr;
+
+    for (T* entry = m_first_in_page[page]; entry; entry = (entry->*Link).next)
+    {
+      const u32 key = (entry->*Link).key;
+      if ((key >> PAGE_SHIFT) != page)
+        return entry;
+      if (greater ? key > addr : key >= addr)
+        return entry;
+    }
+    if (!m_first_in_page[page])
+      return FirstInPageFrom(page);
+
+    // The whole list ended in this page
+    return nullptr;
+  }
+
+  // The first entry in the first used page >= page
+  T* FirstInPageFrom(u32 page) const
+  {
+    size_t word = page / 64;
+    u64 bits = m_used_pages[word] & (~u64(0) << (page % 64));
+    while (bits == 0)
+    {
+      if (++word == m_used_pages.size())
+        return nullptr;
+      bits = m_used_pages[word];
+    }
+    return m_first_in_page[word * 64 + Common::LeastSignificantSetBit(bits)];
+  }
+
+  T* m_head = nullptr;
+  T* m_tail = nullptr;
+  size_t m_size = 0;
+  std::vector<T*> m_first_in_page;
+  std::vector<u64> m_used_pages;
+};
+
+// Entries grouped by a 64-bit hash. Each distinct hash gets one slot in an open addressing table
+// (Robin Hood hashing with backward shift deletion), which points to the list of its entries.
+template <typename T, IndexLink<T, u64> T::*Link>
+class HashIndex
+{
+public:
+  using iterator = IndexIterator<T, u64, Link>;
+
+  iterator end() const { return iterator(); }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  // All entries with the hash, in insertion order
+  std::pair<iterator, iterator> equal_range(u64 hash) const
+  {
+    const size_t index = FindSlot(hash);
+    return {iterator(index != NOT_FOUND ? m_slots[index].head : nullptr), iterator()};
+  }
+
+  bool contains(const T* entry) const { return (entry->*Link).linked; }
+
+  void insert(u64 hash, T* entry)
+  {
+    IndexLink<T, u64>& link = entry->*Link;
+    link.next = nullptr;
+    link.key = hash;
+    link.linked = true;
+    ++m_size;
+
+    const size_t index = FindSlot(hash);
+    if (index != NOT_FOUND)
+    {
+      Slot& slot = m_slots[index];
+      link.prev = slot.tail;
+      (slot.tail->*Link).next = entry;
+      slot.tail = entry;
+      return;
+    }
+
+    link.prev = nullptr;
+    if ((m_used_slots + 1) * 8 > m_slots.size() * 7)
+      Rehash(m_slots.empty() ? MIN_SLOTS : m_slots.size() * 2);
+    InsertSlot({hash, entry, entry, 0});
+    ++m_used_slots;
+  }
+
+  // Removes the entry if it is in the index. Returns whether it was.
+  bool erase(T* entry)
+  {
+    IndexLink<T, u64>& link = entry->*Link;
+    if (!link.linked)
+      return false;
+
+    if (link.prev && link.next)
+    {
+      // Somewhere in the middle, so the slot doesn't change
+      (link.prev->*Link).next = link.next;
+      (link.next->*Link).prev = link.prev;
+    }
+    else
+    {
+      const size_t index = FindSlot(link.key);
+      Slot& slot = m_slots[index];
+      (link.prev ? (link.prev->*Link).next : slot.head) = link.next;
+      (link.next ? (link.next->*Link).prev : slot.tail) = link.prev;
+      if (!slot.head)
+      {
+        EraseSlot(index);
+        --m_used_slots;
+      }
+    }
+
+    link = {};
+    --m_size;
+    return true;
+  }
+
+  // Forgets all entries without touching them, for when they have already been deleted.
+  void clear()
+  {
+    std::fill(m_slots.begin(), m_slots.end(), Slot{});
+    m_size = 0;
+    m_used_slots = 0;
+  }
+
+private:
+  static constexpr size_t NOT_FOUND = ~size_t(0);
+  static constexpr size_t MIN_SLOTS = 256;
+
+  struct Slot
+  {
+    u64 hash;
+    T* head;  // nullptr if the slot is free
+    T* tail;
+    // How far the slot is from where its hash wants it to be
+    u32 distance;
+  };
+
+  size_t HomeSlot(u64 hash) const
+  {
+    // Fibonacci hashing, so that hashes which only differ in their upper bits spread out too
+    return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> m_shift);
+  }
+
+  size_t FindSlot(u64 hash) const
+  {
+    if (m_slots.empty())
+      return NOT_FOUND;
+
+    const size_t mask = m_slots.size() - 1;
+    size_t index = HomeSlot(hash);
+    for (u32 distance = 0;; ++distance)
+    {
+      const Slot& slot = m_slots[index];
+      // A slot which is closer to home than we are means the hash isn't in the table, or it
+      // would have taken this slot when it was inserted.
+      if (!slot.head || slot.distance < distance)
+        return NOT_FOUND;
+      if (slot.hash == hash)
+        return index;
+      index = (index + 1) & mask;
+    }
+  }
+
+  void InsertSlot(Slot slot)
+  {
+    const size_t mask = m_slots.size() - 1;
+    size_t index = HomeSlot(slot.hash);
+    slot.distance = 0;
+    while (m_slots[index].head)
+    {
+      if (m_slots[index].distance < slot.distance)
+        std::swap(m_slots[index], slot);
+      index = (index + 1) & mask;
+      ++slot.distance;
+    }
+    m_slots[index] = slot;
+  }
+
+  void EraseSlot(size_t index)
+  {
+    const size_t mask = m_slots.size() - 1;
+    size_t next = (index + 1) & mask;
+    while (m_slots[next].head && m_slots[next].distance > 0)
+    {
+      m_slots[index] = m_slots[next];
+      --m_slots[index].distance;
+      index = next;
+      next = (next + 1) & mask;
+    }
+    m_slots[index] = Slot{};
+  }
+
+  void Rehash(size_t num_slots)
+  {
+    std::vector<Slot> old_slots(num_slots, Slot{});
+    std::swap(m_slots, old_slots);
+    m_shift = 64;
+    for (size_t i = num_slots; i > 1; i /= 2)
+      --m_shift;
+
+    for (const Slot& slot : old_slots)
+    {
+      if (slot.head)
+        InsertSlot(slot);
+    }
+  }
+
+  std::vector<Slot> m_slots;
+  u32 m_shift = 64;
+  size_t m_size = 0;
+  size_t m_used_slots = 0;
+};
+}  // namespace VideoCommon
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <tuple>
 #include "Common/CommonTypes.h"
 
@@ -108,8 +109,22 @@ int TexDecoder_GetEFBCopyBlockHeightInTexels(EFBCopyFormat format);
 int TexDecoder_GetPaletteSize(TextureFormat fmt);
 TextureFormat TexDecoder_GetEFBCopyBaseFormat(EFBCopyFormat format);
 
+// One level of a texture for TexDecoder_DecodeLevels. width and height are the expanded size,
+// i.e. multiples of the block size.
+struct TextureDecodeLevel
+{
+  u8* dst;
+  const u8* src;
+  int width;
+  int height;
+};
+
 void TexDecoder_Decode(u8* dst, const u8* src, int width, int height, TextureFormat texformat,
                        const u8* tlut, TLUTFormat tlutfmt);
+// Decodes all the levels at once. Large levels are split into bands of block rows, and the bands
+// of all levels are spread over the decoding threads.
+void TexDecoder_DecodeLevels(const TextureDecodeLevel* levels, size_t num_levels,
+                             TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt);
 void TexDecoder_DecodeRGBA8FromTmem(u8* dst, const u8* src_ar, const u8* src_gb, int width,
                                     int height);
 void TexDecoder_DecodeTexel(u8* dst, const u8* src, int s, int t, int imageWidth,
@@ -119,7 +134,19 @@ void TexDecoder_DecodeTexelRGBA8FromTmem(u8* dst, const u8* src_ar, const u8* sr
 void TexDecoder_DecodeXFB(u8* dst, const u8* src, u32 width, u32 height, u32 stride);
 
 void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center);
+// The number of threads that help the calling thread decode large textures. 0 decodes everything
+// on the calling thread.
+void TexDecoder_SetDecodingThreads(u32 num_threads);
 
 /* Internal method, implemented by TextureDecoder_Generic and TextureDecoder_x64. */
 void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
                             const u8* tlut, TLUTFormat tlutfmt);
+/* The reference C implementation. Built on every platform so that the optimized decoders can be
+ * checked against it. */
+void _TexDecoder_DecodeImpl_Generic(u32* dst, const u8* src, int width, int height,
+                                    TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt);
+#ifdef _M_X86
+/* Picks the decoders for the given instruction sets instead of the best ones cpu_info allows,
+ * so that the tests can check all of them. */
+void _TexDecoder_SelectDecoders(bool ssse3, bool avx2);
+#endif
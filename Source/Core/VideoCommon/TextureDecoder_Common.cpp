@@ -4,12 +4,18 @@
 
 #include <algorithm>
 #include <cmath>
+#include <condition_variable>
 #include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/MathUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
+#include "Common/Thread.h"
 
 #include "VideoCommon/LookUpTables.h"
 #include "VideoCommon/TextureDecoder.h"
@@ -371,13 +377,195 @@ static void TexDecoder_DrawOverlay(u8* dst, int width, int height, TextureFormat
   }
 }
 
-void TexDecoder_Decode(u8* dst, const u8* src, int width, int height, TextureFormat texformat,
-                       const u8* tlut, TLUTFormat tlutfmt)
+namespace
+{
+// Persistent threads that decode bands of textures together with the thread that asked for them.
+class DecodingThreadPool
+{
+public:
+  ~DecodingThreadPool() { Resize(0); }
+
+  u32 GetNumThreads() const { return static_cast<u32>(m_threads.size()); }
+
+  void Resize(u32 num_threads)
+  {
+    std::lock_guard<std::mutex> run_lk(m_run_mutex);
+    if (num_threads == m_threads.size())
+      return;
+
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_shutdown = true;
+    }
+    m_work_cv.notify_all();
+    for (std::thread& thread : m_threads)
+      thread.join();
+    m_threads.clear();
+
+    m_shutdown = false;
+    for (u32 i = 0; i < num_threads; ++i)
+      m_threads.emplace_back(&DecodingThreadPool::WorkerThread, this);
+  }
+
+  // Calls function for every index in [0, count) and returns once all calls have returned.
+  void Run(size_t count, const std::function<void(size_t)>& function)
+  {
+    std::lock_guard<std::mutex> run_lk(m_run_mutex);
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_function = &function;
+      m_count = count;
+      m_next = 0;
+      m_remaining = count;
+    }
+    m_work_cv.notify_all();
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (m_next < m_count)
+      RunOne(lk);
+    m_done_cv.wait(lk, [this] { return m_remaining == 0; });
+    m_function = nullptr;
+  }
+
+private:
+  // Takes the next index and runs it without holding the lock.
+  void RunOne(std::unique_lock<std::mutex>& lk)
+  {
+    const size_t index = m_next++;
+    const std::function<void(size_t)>& function = *m_function;
+    lk.unlock();
+    function(index);
+    lk.lock();
+    if (--m_remaining == 0)
+      m_done_cv.notify_one();
+  }
+
+  void WorkerThread()
+  {
+    Common::SetCurrentThreadName("Texture Decoder");
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (true)
+    {
+      m_work_cv.wait(lk, [this] { return m_shutdown || (m_function && m_next < m_count); });
+      if (m_shutdown)
+        return;
+      RunOne(lk);
+    }
+  }
+
+  std::vector<std::thread> m_threads;
+  // Only one texture is decoded at a time
+  std::mutex m_run_mutex;
+
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_done_cv;
+  const std::function<void(size_t)>* m_function = nullptr;
+  size_t m_count = 0;
+  size_t m_next = 0;
+  size_t m_remaining = 0;
+  bool m_shutdown = false;
+};
+
+struct DecodeBand
+{
+  u32* dst;
+  const u8* src;
+  int width;
+  int height;
+};
+
+// Waking up a thread costs about as much as decoding a few thousand texels, so bands are at least
+// this big and smaller textures are decoded on the calling thread.
+constexpr int MIN_TEXELS_PER_BAND = 128 * 128;
+}  // namespace
+
+static DecodingThreadPool s_decoding_threads;
+
+void TexDecoder_SetDecodingThreads(u32 num_threads)
+{
+  s_decoding_threads.Resize(num_threads);
+}
+
+static void SplitIntoBands(std::vector<DecodeBand>* bands, const TextureDecodeLevel& level,
+                           TextureFormat texformat, u32 num_threads)
+{
+  u32* const dst = reinterpret_cast<u32*>(level.dst);
+  const int texels = level.width * level.height;
+
+  // XFB isn't made of blocks, and is decoded on the GPU anyway
+  if (texformat == TextureFormat::XFB || texels < MIN_TEXELS_PER_BAND * 2)
+  {
+    bands->push_back({dst, level.src, level.width, level.height});
+    return;
+  }
+
+  // The blocks are stored row by row, so a band of block rows is a contiguous part of the source.
+  // The decoders find blocks relative to the first row they are given.
+  const int block_width = TexDecoder_GetBlockWidthInTexels(texformat);
+  const int block_height = TexDecoder_GetBlockHeightInTexels(texformat);
+  const int block_rows = (level.height + block_height - 1) / block_height;
+  const int blocks_per_row = (level.width + block_width - 1) / block_width;
+  const int bytes_per_block_row =
+      TexDecoder_GetTextureSizeInBytes(blocks_per_row * block_width, block_height, texformat);
+
+  // A few bands per thread, so that a thread that is slow to wake up doesn't hold up the rest
+  const int texels_per_block_row = level.width * block_height;
+  const int max_bands = static_cast<int>(num_threads + 1) * 3;
+  const int rows_per_band =
+      std::max((block_rows + max_bands - 1) / max_bands,
+               (MIN_TEXELS_PER_BAND + texels_per_block_row - 1) / texels_per_block_row);
+
+  for (int row = 0; row < block_rows; row += rows_per_band)
+  {
+    const int y = row * block_height;
+    bands->push_back({dst + y * level.width, level.src + row * bytes_per_block_row, level.width,
+                      std::min(rows_per_band * block_height, level.height - y)});
+  }
+}
+
+void TexDecoder_DecodeLevels(const TextureDecodeLevel* levels, size_t num_levels,
+                             TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt)
 {
-  _TexDecoder_DecodeImpl((u32*)dst, src, width, height, texformat, tlut, tlutfmt);
+  const u32 num_threads = s_decoding_threads.GetNumThreads();
+  if (num_threads == 0)
+  {
+    for (size_t i = 0; i < num_levels; ++i)
+    {
+      _TexDecoder_DecodeImpl(reinterpret_cast<u32*>(levels[i].dst), levels[i].src, levels[i].width,
+                             levels[i].height, texformat, tlut, tlutfmt);
+    }
+  }
+  else
+  {
+    std::vector<DecodeBand> bands;
+    for (size_t i = 0; i < num_levels; ++i)
+      SplitIntoBands(&bands, levels[i], texformat, num_threads);
+
+    const auto decode_band = [&](size_t i) {
+      const DecodeBand& band = bands[i];
+      _TexDecoder_DecodeImpl(band.dst, band.src, band.width, band.height, texformat, tlut,
+                             tlutfmt);
+    };
+    if (bands.size() == 1)
+      decode_band(0);
+    else if (!bands.empty())
+      s_decoding_threads.Run(bands.size(), decode_band);
+  }
 
   if (TexFmt_Overlay_Enable)
-    TexDecoder_DrawOverlay(dst, width, height, texformat);
+  {
+    for (size_t i = 0; i < num_levels; ++i)
+      TexDecoder_DrawOverlay(levels[i].dst, levels[i].width, levels[i].height, texformat);
+  }
+}
+
+void TexDecoder_Decode(u8* dst, const u8* src, int width, int height, TextureFormat texformat,
+                       const u8* tlut, TLUTFormat tlutfmt)
+{
+  const TextureDecodeLevel level = {dst, src, width, height};
+  TexDecoder_DecodeLevels(&level, 1, texformat, tlut, tlutfmt);
 }
 
 static inline u32 DecodePixel_IA8(u16 val)
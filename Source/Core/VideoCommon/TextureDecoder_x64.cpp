@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstring>
 
@@ -1410,90 +1411,519 @@ static void TexDecoder_DecodeImpl_CMPR(u32* dst, const u8* src, int width, int h
   }
 }
 
-void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
-                            const u8* tlut, TLUTFormat tlutfmt)
+// AVX2 decoders. The 4x4 formats decode a whole block at once, and the paletted formats look texels
+// up in a palette that is converted to RGBA8 once per texture, instead of converting each texel.
+
+static inline u32 ReadU32(const u8* src)
+{
+  u32 value;
+  std::memcpy(&value, src, sizeof(value));
+  return value;
+}
+
+// Stores a 4x4 block that is in the order the 16-bit formats decode into: rows 0 and 2 in one
+// register, rows 1 and 3 in the other.
+FUNCTION_TARGET_AVX2
+static inline void StoreBlock4x4_AVX2(u32* dst, int width, __m256i rows02, __m256i rows13)
+{
+  _mm_storeu_si128((__m128i*)(dst + width * 0), _mm256_castsi256_si128(rows02));
+  _mm_storeu_si128((__m128i*)(dst + width * 1), _mm256_castsi256_si128(rows13));
+  _mm_storeu_si128((__m128i*)(dst + width * 2), _mm256_extracti128_si256(rows02, 1));
+  _mm_storeu_si128((__m128i*)(dst + width * 3), _mm256_extracti128_si256(rows13, 1));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i ByteSwap16_AVX2(__m256i v)
+{
+  const __m256i mask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0,
+                                        3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  return _mm256_shuffle_epi8(v, mask);
+}
+
+// Convert3To8 etc. for 16-bit lanes
+FUNCTION_TARGET_AVX2
+static inline __m256i Convert3To8_AVX2(__m256i v)
+{
+  return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(v, 5), _mm256_slli_epi16(v, 2)),
+                         _mm256_srli_epi16(v, 1));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Convert4To8_AVX2(__m256i v)
+{
+  return _mm256_or_si256(_mm256_slli_epi16(v, 4), v);
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Convert5To8_AVX2(__m256i v)
+{
+  return _mm256_or_si256(_mm256_slli_epi16(v, 3), _mm256_srli_epi16(v, 2));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Convert6To8_AVX2(__m256i v)
+{
+  return _mm256_or_si256(_mm256_slli_epi16(v, 2), _mm256_srli_epi16(v, 4));
+}
+
+// Combines 16 texels worth of 8-bit channels in 16-bit lanes into RGBA8. Like unpacking, this
+// works on each 128-bit half separately: lo gets texels 0-3 and 8-11, hi gets 4-7 and 12-15.
+FUNCTION_TARGET_AVX2
+static inline void CombineChannels_AVX2(__m256i r, __m256i g, __m256i b, __m256i a, __m256i* lo,
+                                        __m256i* hi)
+{
+  const __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+  const __m256i ba = _mm256_or_si256(b, _mm256_slli_epi16(a, 8));
+  *lo = _mm256_unpacklo_epi16(rg, ba);
+  *hi = _mm256_unpackhi_epi16(rg, ba);
+}
+
+// Decoders for 16 texels of the 16-bit formats, which are also the TLUT formats.
+FUNCTION_TARGET_AVX2
+static inline void DecodeIA8_AVX2(__m256i src, __m256i* lo, __m256i* hi)
+{
+  // Each texel is an alpha byte followed by an intensity byte
+  const __m256i mask_lo = _mm256_setr_epi8(1, 1, 1, 0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6, 1, 1, 1,
+                                           0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6);
+  const __m256i mask_hi = _mm256_setr_epi8(9, 9, 9, 8, 11, 11, 11, 10, 13, 13, 13, 12, 15, 15, 15,
+                                           14, 9, 9, 9, 8, 11, 11, 11, 10, 13, 13, 13, 12, 15, 15,
+                                           15, 14);
+  *lo = _mm256_shuffle_epi8(src, mask_lo);
+  *hi = _mm256_shuffle_epi8(src, mask_hi);
+}
+
+FUNCTION_TARGET_AVX2
+static inline void DecodeRGB565_AVX2(__m256i src, __m256i* lo, __m256i* hi)
+{
+  const __m256i val = ByteSwap16_AVX2(src);
+  const __m256i r = Convert5To8_AVX2(_mm256_srli_epi16(val, 11));
+  const __m256i g =
+      Convert6To8_AVX2(_mm256_and_si256(_mm256_srli_epi16(val, 5), _mm256_set1_epi16(0x3f)));
+  const __m256i b = Convert5To8_AVX2(_mm256_and_si256(val, _mm256_set1_epi16(0x1f)));
+  CombineChannels_AVX2(r, g, b, _mm256_set1_epi16(0xff), lo, hi);
+}
+
+FUNCTION_TARGET_AVX2
+static inline void DecodeRGB5A3_AVX2(__m256i src, __m256i* lo, __m256i* hi)
 {
-  int Wsteps4 = (width + 3) / 4;
-  int Wsteps8 = (width + 7) / 8;
+  const __m256i val = ByteSwap16_AVX2(src);
+  const __m256i mask3 = _mm256_set1_epi16(0x7);
+  const __m256i mask4 = _mm256_set1_epi16(0xf);
+  const __m256i mask5 = _mm256_set1_epi16(0x1f);
+
+  // Texels with the top bit set are opaque RGB555, the others are RGB4A3
+  const __m256i opaque = _mm256_srai_epi16(val, 15);
+
+  const __m256i r555 = Convert5To8_AVX2(_mm256_and_si256(_mm256_srli_epi16(val, 10), mask5));
+  const __m256i g555 = Convert5To8_AVX2(_mm256_and_si256(_mm256_srli_epi16(val, 5), mask5));
+  const __m256i b555 = Convert5To8_AVX2(_mm256_and_si256(val, mask5));
+
+  const __m256i a4443 = Convert3To8_AVX2(_mm256_and_si256(_mm256_srli_epi16(val, 12), mask3));
+  const __m256i r4443 = Convert4To8_AVX2(_mm256_and_si256(_mm256_srli_epi16(val, 8), mask4));
+  const __m256i g4443 = Convert4To8_AVX2(_mm256_and_si256(_mm256_srli_epi16(val, 4), mask4));
+  const __m256i b4443 = Convert4To8_AVX2(_mm256_and_si256(val, mask4));
+
+  CombineChannels_AVX2(_mm256_blendv_epi8(r4443, r555, opaque),
+                       _mm256_blendv_epi8(g4443, g555, opaque),
+                       _mm256_blendv_epi8(b4443, b555, opaque),
+                       _mm256_blendv_epi8(a4443, _mm256_set1_epi16(0xff), opaque), lo, hi);
+}
 
-  switch (texformat)
+// Converts the first num_entries (a multiple of 16) entries of the TLUT to RGBA8.
+FUNCTION_TARGET_AVX2
+static bool DecodePalette_AVX2(u32* palette, const u8* tlut, TLUTFormat tlutfmt, int num_entries)
+{
+  for (int i = 0; i < num_entries; i += 16)
   {
-  case TextureFormat::C4:
-    TexDecoder_DecodeImpl_C4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
-    break;
+    const __m256i src = _mm256_loadu_si256((const __m256i*)(tlut + 2 * i));
+    __m256i lo, hi;
+    switch (tlutfmt)
+    {
+    case TLUTFormat::IA8:
+      DecodeIA8_AVX2(src, &lo, &hi);
+      break;
+    case TLUTFormat::RGB565:
+      DecodeRGB565_AVX2(src, &lo, &hi);
+      break;
+    case TLUTFormat::RGB5A3:
+      DecodeRGB5A3_AVX2(src, &lo, &hi);
+      break;
+    default:
+      return false;
+    }
+    _mm256_storeu_si256((__m256i*)(palette + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i*)(palette + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+  }
+  return true;
+}
 
-  case TextureFormat::I4:
-    if (cpu_info.bSSSE3)
-      TexDecoder_DecodeImpl_I4_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                     Wsteps8);
-    else
-      TexDecoder_DecodeImpl_I4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
-    break;
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_C4_AVX2(u32* dst, const u8* src, int width, int height,
+                                          TextureFormat texformat, const u8* tlut,
+                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  alignas(32) u32 palette[16];
+  if (!DecodePalette_AVX2(palette, tlut, tlutfmt, 16))
+    return;
+
+  // Eight texels are looked up with one permute per half of the palette
+  const __m256i palette_lo = _mm256_load_si256((const __m256i*)palette);
+  const __m256i palette_hi = _mm256_load_si256((const __m256i*)(palette + 8));
+  // Each byte holds two indices, the left one in the high nibble
+  const __m256i spread = _mm256_setr_epi8(0, -1, -1, -1, 0, -1, -1, -1, 1, -1, -1, -1, 1, -1, -1,
+                                          -1, 2, -1, -1, -1, 2, -1, -1, -1, 3, -1, -1, -1, 3, -1,
+                                          -1, -1);
+  const __m256i shifts = _mm256_setr_epi32(4, 0, 4, 0, 4, 0, 4, 0);
+  const __m256i mask4 = _mm256_set1_epi32(0xf);
+  const __m256i seven = _mm256_set1_epi32(7);
 
-  case TextureFormat::I8:
-    if (cpu_info.bSSSE3)
-      TexDecoder_DecodeImpl_I8_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                     Wsteps8);
-    else
-      TexDecoder_DecodeImpl_I8(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
-    break;
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 8 * yStep; iy < 8; iy++, xStep++)
+      {
+        const __m256i bytes =
+            _mm256_shuffle_epi8(_mm256_set1_epi32(ReadU32(src + 4 * xStep)), spread);
+        const __m256i indices = _mm256_and_si256(_mm256_srlv_epi32(bytes, shifts), mask4);
+        const __m256i texels =
+            _mm256_blendv_epi8(_mm256_permutevar8x32_epi32(palette_lo, indices),
+                               _mm256_permutevar8x32_epi32(palette_hi, indices),
+                               _mm256_cmpgt_epi32(indices, seven));
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), texels);
+      }
+    }
+  }
+}
 
-  case TextureFormat::C8:
-    TexDecoder_DecodeImpl_C8(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
-    break;
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_I4_AVX2(u32* dst, const u8* src, int width, int height,
+                                          TextureFormat texformat, const u8* tlut,
+                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  // Each byte holds two texels, the left one in the high nibble. Every texel gets a copy of its
+  // byte in all four channels, and then the nibble that isn't needed is shifted out.
+  const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2,
+                                          2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+  const __m256i shifts = _mm256_setr_epi32(4, 0, 4, 0, 4, 0, 4, 0);
+  const __m256i mask4 = _mm256_set1_epi8(0xf);
 
-  case TextureFormat::IA4:
-    TexDecoder_DecodeImpl_IA4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
-    break;
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 8 * yStep; iy < 8; iy++, xStep++)
+      {
+        const __m256i bytes =
+            _mm256_shuffle_epi8(_mm256_set1_epi32(ReadU32(src + 4 * xStep)), spread);
+        const __m256i i4 = _mm256_and_si256(_mm256_srlv_epi32(bytes, shifts), mask4);
+        const __m256i texels = _mm256_or_si256(i4, _mm256_slli_epi32(i4, 4));
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), texels);
+      }
+    }
+  }
+}
 
-  case TextureFormat::IA8:
-    if (cpu_info.bSSSE3)
-      TexDecoder_DecodeImpl_IA8_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                      Wsteps8);
-    else
-      TexDecoder_DecodeImpl_IA8(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                Wsteps8);
-    break;
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_I8_AVX2(u32* dst, const u8* src, int width, int height,
+                                          TextureFormat texformat, const u8* tlut,
+                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4,
+                                          4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
 
-  case TextureFormat::C14X2:
-    TexDecoder_DecodeImpl_C14X2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                Wsteps8);
-    break;
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+      {
+        const __m256i bytes =
+            _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+                            _mm256_shuffle_epi8(bytes, spread));
+      }
+    }
+  }
+}
 
-  case TextureFormat::RGB565:
-    TexDecoder_DecodeImpl_RGB565(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                 Wsteps8);
-    break;
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_C8_AVX2(u32* dst, const u8* src, int width, int height,
+                                          TextureFormat texformat, const u8* tlut,
+                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  alignas(32) u32 palette[256];
+  if (!DecodePalette_AVX2(palette, tlut, tlutfmt, 256))
+    return;
 
-  case TextureFormat::RGB5A3:
-    if (cpu_info.bSSSE3)
-      TexDecoder_DecodeImpl_RGB5A3_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                         Wsteps8);
-    else
-      TexDecoder_DecodeImpl_RGB5A3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                   Wsteps8);
-    break;
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+      {
+        const __m256i indices =
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+                            _mm256_i32gather_epi32((const int*)palette, indices, 4));
+      }
+    }
+  }
+}
 
-  case TextureFormat::RGBA8:
-    if (cpu_info.bSSSE3)
-      TexDecoder_DecodeImpl_RGBA8_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                        Wsteps8);
-    else
-      TexDecoder_DecodeImpl_RGBA8(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                  Wsteps8);
-    break;
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_IA8_AVX2(u32* dst, const u8* src, int width, int height,
+                                           TextureFormat texformat, const u8* tlut,
+                                           TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      __m256i rows02, rows13;
+      DecodeIA8_AVX2(_mm256_loadu_si256((const __m256i*)(src + 32 * yStep)), &rows02, &rows13);
+      StoreBlock4x4_AVX2(dst + y * width + x, width, rows02, rows13);
+    }
+  }
+}
 
-  case TextureFormat::CMPR:
-    TexDecoder_DecodeImpl_CMPR(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
-    break;
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGB565_AVX2(u32* dst, const u8* src, int width, int height,
+                                              TextureFormat texformat, const u8* tlut,
+                                              TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      __m256i rows02, rows13;
+      DecodeRGB565_AVX2(_mm256_loadu_si256((const __m256i*)(src + 32 * yStep)), &rows02,
+                        &rows13);
+      StoreBlock4x4_AVX2(dst + y * width + x, width, rows02, rows13);
+    }
+  }
+}
 
-  case TextureFormat::XFB:
-    TexDecoder_DecodeXFB(reinterpret_cast<u8*>(dst), src, width, height, width * 2);
-    break;
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGB5A3_AVX2(u32* dst, const u8* src, int width, int height,
+                                              TextureFormat texformat, const u8* tlut,
+                                              TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      __m256i rows02, rows13;
+      DecodeRGB5A3_AVX2(_mm256_loadu_si256((const __m256i*)(src + 32 * yStep)), &rows02,
+                        &rows13);
+      StoreBlock4x4_AVX2(dst + y * width + x, width, rows02, rows13);
+    }
+  }
+}
 
-  default:
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGBA8_AVX2(u32* dst, const u8* src, int width, int height,
+                                             TextureFormat texformat, const u8* tlut,
+                                             TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  // Unpacking the AR and GB halves of a block gives AGRB texels
+  const __m256i mask2130 = _mm256_setr_epi8(2, 1, 3, 0, 6, 5, 7, 4, 10, 9, 11, 8, 14, 13, 15, 12, 2,
+                                            1, 3, 0, 6, 5, 7, 4, 10, 9, 11, 8, 14, 13, 15, 12);
+
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      const u8* src2 = src + 64 * yStep;
+      const __m256i ar = _mm256_loadu_si256((const __m256i*)src2);
+      const __m256i gb = _mm256_loadu_si256((const __m256i*)src2 + 1);
+      const __m256i rows02 = _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar, gb), mask2130);
+      const __m256i rows13 = _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar, gb), mask2130);
+      StoreBlock4x4_AVX2(dst + y * width + x, width, rows02, rows13);
+    }
+  }
+}
+
+// (5 * own + 3 * other) / 8 for 32-bit lanes, like DXTBlend
+FUNCTION_TARGET_AVX2
+static inline __m256i DXTBlend_AVX2(__m256i own, __m256i other)
+{
+  return _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(own, 2), own),
+                                            _mm256_add_epi32(_mm256_slli_epi32(other, 1), other)),
+                           3);
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i MakeRGB_AVX2(__m256i r, __m256i g, __m256i b)
+{
+  return _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)), _mm256_slli_epi32(b, 16));
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_CMPR_AVX2(u32* dst, const u8* src, int width, int height,
+                                            TextureFormat texformat, const u8* tlut,
+                                            TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  // An 8x8 tile is four DXT blocks: top left, top right, bottom left, bottom right. The palettes
+  // of all four are computed at once, with the two colors of each block in neighbouring 32-bit
+  // lanes. Each line of the tile is then one permute of the palettes of two blocks.
+  const __m256i colors_mask =
+      _mm256_setr_epi8(1, 0, -1, -1, 3, 2, -1, -1, 9, 8, -1, -1, 11, 10, -1, -1, 1, 0, -1, -1, 3,
+                       2, -1, -1, 9, 8, -1, -1, 11, 10, -1, -1);
+  const __m256i mask5 = _mm256_set1_epi32(0x1f);
+  const __m256i mask6 = _mm256_set1_epi32(0x3f);
+  const __m256i alpha = _mm256_set1_epi32(0xff000000);
+  const __m256i odd_lanes = _mm256_setr_epi32(0, -1, 0, -1, 0, -1, 0, -1);
+  const __m256i top_lines = _mm256_setr_epi32(1, 1, 1, 1, 3, 3, 3, 3);
+  const __m256i bottom_lines = _mm256_setr_epi32(5, 5, 5, 5, 7, 7, 7, 7);
+  const __m256i right_block = _mm256_setr_epi32(0, 0, 0, 0, 4, 4, 4, 4);
+  const __m256i mask2 = _mm256_set1_epi32(0x3);
+  // The leftmost texel of a line is in the top two bits of its byte
+  const __m256i line_shifts[4] = {
+      _mm256_setr_epi32(6, 4, 2, 0, 6, 4, 2, 0),
+      _mm256_setr_epi32(14, 12, 10, 8, 14, 12, 10, 8),
+      _mm256_setr_epi32(22, 20, 18, 16, 22, 20, 18, 16),
+      _mm256_setr_epi32(30, 28, 26, 24, 30, 28, 26, 24),
+  };
+
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      const __m256i tile = _mm256_loadu_si256((const __m256i*)(src + 32 * yStep));
+
+      const __m256i colors = _mm256_shuffle_epi8(tile, colors_mask);
+      const __m256i r5 = _mm256_srli_epi32(colors, 11);
+      const __m256i g6 = _mm256_and_si256(_mm256_srli_epi32(colors, 5), mask6);
+      const __m256i b5 = _mm256_and_si256(colors, mask5);
+      const __m256i r = _mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2));
+      const __m256i g = _mm256_or_si256(_mm256_slli_epi32(g6, 2), _mm256_srli_epi32(g6, 4));
+      const __m256i b = _mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2));
+
+      // The other color of the same block
+      const __m256i other_colors = _mm256_shuffle_epi32(colors, _MM_SHUFFLE(2, 3, 0, 1));
+      const __m256i other_r = _mm256_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1));
+      const __m256i other_g = _mm256_shuffle_epi32(g, _MM_SHUFFLE(2, 3, 0, 1));
+      const __m256i other_b = _mm256_shuffle_epi32(b, _MM_SHUFFLE(2, 3, 0, 1));
+
+      // Blending towards the color in the same lane gives color 2 in even lanes and color 3 in
+      // odd lanes. The average is the same in both.
+      const __m256i blended = MakeRGB_AVX2(DXTBlend_AVX2(r, other_r), DXTBlend_AVX2(g, other_g),
+                                           DXTBlend_AVX2(b, other_b));
+      const __m256i averaged =
+          MakeRGB_AVX2(_mm256_srli_epi32(_mm256_add_epi32(r, other_r), 1),
+                       _mm256_srli_epi32(_mm256_add_epi32(g, other_g), 1),
+                       _mm256_srli_epi32(_mm256_add_epi32(b, other_b), 1));
+
+      // Blocks whose first color is greater use the blends, the others use the average, with
+      // color 3 transparent.
+      const __m256i use_blend =
+          _mm256_shuffle_epi32(_mm256_cmpgt_epi32(colors, other_colors), _MM_SHUFFLE(2, 2, 0, 0));
+      const __m256i transparent = _mm256_andnot_si256(use_blend, odd_lanes);
+      const __m256i colors01 = _mm256_or_si256(MakeRGB_AVX2(r, g, b), alpha);
+      const __m256i colors23 = _mm256_or_si256(_mm256_blendv_epi8(averaged, blended, use_blend),
+                                               _mm256_andnot_si256(transparent, alpha));
+
+      // Gather the four colors of each block, and put the palettes of the blocks that share lines
+      // into one register.
+      const __m256i left_palettes = _mm256_unpacklo_epi64(colors01, colors23);
+      const __m256i right_palettes = _mm256_unpackhi_epi64(colors01, colors23);
+      const __m256i top_palettes = _mm256_permute2x128_si256(left_palettes, right_palettes, 0x20);
+      const __m256i bottom_palettes =
+          _mm256_permute2x128_si256(left_palettes, right_palettes, 0x31);
+
+      const __m256i top = _mm256_permutevar8x32_epi32(tile, top_lines);
+      const __m256i bottom = _mm256_permutevar8x32_epi32(tile, bottom_lines);
+      for (int iy = 0; iy < 4; iy++)
+      {
+        const __m256i top_indices = _mm256_or_si256(
+            _mm256_and_si256(_mm256_srlv_epi32(top, line_shifts[iy]), mask2), right_block);
+        const __m256i bottom_indices = _mm256_or_si256(
+            _mm256_and_si256(_mm256_srlv_epi32(bottom, line_shifts[iy]), mask2), right_block);
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+                            _mm256_permutevar8x32_epi32(top_palettes, top_indices));
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy + 4) * width + x),
+                            _mm256_permutevar8x32_epi32(bottom_palettes, bottom_indices));
+      }
+    }
+  }
+}
+
+static void TexDecoder_DecodeImpl_XFB(u32* dst, const u8* src, int width, int height,
+                                      TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt,
+                                      int Wsteps4, int Wsteps8)
+{
+  TexDecoder_DecodeXFB(reinterpret_cast<u8*>(dst), src, width, height, width * 2);
+}
+
+using DecodeFunction = void (*)(u32* dst, const u8* src, int width, int height,
+                                TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt,
+                                int Wsteps4, int Wsteps8);
+// Indexed by TextureFormat
+using DecoderTable = std::array<DecodeFunction, 16>;
+
+static DecoderTable MakeDecoderTable(bool ssse3, bool avx2)
+{
+  const auto pick = [&](DecodeFunction generic, DecodeFunction with_ssse3,
+                        DecodeFunction with_avx2) {
+    if (avx2 && with_avx2)
+      return with_avx2;
+    if (ssse3 && with_ssse3)
+      return with_ssse3;
+    return generic;
+  };
+
+  DecoderTable table{};
+  const auto set = [&table](TextureFormat format, DecodeFunction function) {
+    table[static_cast<size_t>(format)] = function;
+  };
+  set(TextureFormat::I4, pick(TexDecoder_DecodeImpl_I4, TexDecoder_DecodeImpl_I4_SSSE3,
+                              TexDecoder_DecodeImpl_I4_AVX2));
+  set(TextureFormat::I8, pick(TexDecoder_DecodeImpl_I8, TexDecoder_DecodeImpl_I8_SSSE3,
+                              TexDecoder_DecodeImpl_I8_AVX2));
+  set(TextureFormat::IA4, TexDecoder_DecodeImpl_IA4);
+  set(TextureFormat::IA8, pick(TexDecoder_DecodeImpl_IA8, TexDecoder_DecodeImpl_IA8_SSSE3,
+                               TexDecoder_DecodeImpl_IA8_AVX2));
+  set(TextureFormat::RGB565,
+      pick(TexDecoder_DecodeImpl_RGB565, nullptr, TexDecoder_DecodeImpl_RGB565_AVX2));
+  set(TextureFormat::RGB5A3, pick(TexDecoder_DecodeImpl_RGB5A3, TexDecoder_DecodeImpl_RGB5A3_SSSE3,
+                                  TexDecoder_DecodeImpl_RGB5A3_AVX2));
+  set(TextureFormat::RGBA8, pick(TexDecoder_DecodeImpl_RGBA8, TexDecoder_DecodeImpl_RGBA8_SSSE3,
+                                 TexDecoder_DecodeImpl_RGBA8_AVX2));
+  set(TextureFormat::C4, pick(TexDecoder_DecodeImpl_C4, nullptr, TexDecoder_DecodeImpl_C4_AVX2));
+  set(TextureFormat::C8, pick(TexDecoder_DecodeImpl_C8, nullptr, TexDecoder_DecodeImpl_C8_AVX2));
+  set(TextureFormat::C14X2, TexDecoder_DecodeImpl_C14X2);
+  set(TextureFormat::CMPR,
+      pick(TexDecoder_DecodeImpl_CMPR, nullptr, TexDecoder_DecodeImpl_CMPR_AVX2));
+  set(TextureFormat::XFB, TexDecoder_DecodeImpl_XFB);
+  return table;
+}
+
+// Picked once instead of checking cpu_info for every texture
+static DecoderTable& GetDecoders()
+{
+  static DecoderTable s_decoders = MakeDecoderTable(cpu_info.bSSSE3, cpu_info.bAVX2);
+  return s_decoders;
+}
+
+void _TexDecoder_SelectDecoders(bool ssse3, bool avx2)
+{
+  GetDecoders() = MakeDecoderTable(ssse3, avx2);
+}
+
+void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
+                            const u8* tlut, TLUTFormat tlutfmt)
+{
+  const DecoderTable& decoders = GetDecoders();
+  const size_t index = static_cast<size_t>(texformat);
+  if (index >= decoders.size() || !decoders[index])
+  {
     PanicAlert("Invalid Texture Format (0x%X)! (_TexDecoder_DecodeImpl)",
                static_cast<int>(texformat));
-    break;
+    return;
   }
+
+  const int Wsteps4 = (width + 3) / 4;
+  const int Wsteps8 = (width + 7) / 8;
+  decoders[index](dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
 }
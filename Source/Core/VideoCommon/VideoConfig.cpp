@@ -99,6 +99,9 @@ void VideoConfig::Refresh()
   iBitrateKbps = Config::Get(Config::GFX_BITRATE_KBPS);
   bInternalResolutionFrameDumps = Config::Get(Config::GFX_INTERNAL_RESOLUTION_FRAME_DUMPS);
   bEnableGPUTextureDecoding = Config::Get(Config::GFX_ENABLE_GPU_TEXTURE_DECODING);
+  iTextureDecodingThreads = Config::Get(Config::GFX_TEXTURE_DECODING_THREADS);
+  bTrackTextureWrites = Config::Get(Config::GFX_TRACK_TEXTURE_WRITES);
+  bFullTextureHash = Config::Get(Config::GFX_FULL_TEXTURE_HASH);
   bEnablePixelLighting = Config::Get(Config::GFX_ENABLE_PIXEL_LIGHTING);
   bFastDepthCalc = Config::Get(Config::GFX_FAST_DEPTH_CALC);
   iMultisamples = Config::Get(Config::GFX_MSAA);
@@ -207,6 +210,22 @@ u32 VideoConfig::GetShaderCompilerThreads() const
     return GetNumAutoShaderCompilerThreads();
 }
 
+u32 VideoConfig::GetTextureDecodingThreads() const
+{
+  if (iTextureDecodingThreads >= 0)
+    return static_cast<u32>(iTextureDecodingThreads);
+
+  // Automatic number. The CPU and GPU threads already keep two cores busy, and decoding one
+  // texture doesn't split into enough work for many more threads to help.
+  return static_cast<u32>(std::min(std::max(cpu_info.num_cores - 2, 0), 4));
+}
+
+int VideoConfig::GetTextureCacheSamples() const
+{
+  // The full hash always hashes everything, which is the same as not sampling
+  return bFullTextureHash ? 0 : iSafeTextureCache_ColorSamples;
+}
+
 u32 VideoConfig::GetShaderPrecompilerThreads() const
 {
   // When using background compilation, always keep the same thread count.
@@ -108,6 +108,15 @@ struct VideoConfig final
   bool bFreeLook;
   bool bBorderlessFullscreen;
   bool bEnableGPUTextureDecoding;
+  // Number of threads that help decode large textures on the CPU.
+  // 0 decodes them on the GPU thread only.
+  // -1 uses an automatic number based on the CPU threads.
+  int iTextureDecodingThreads;
+  // Skip hashing textures whose memory hasn't been written since they were last hashed.
+  // Needs fastmem, and isn't available on macOS.
+  bool bTrackTextureWrites;
+  // Hash all of every texture with a hash made for speed, instead of sampling it.
+  bool bFullTextureHash;
   int iBitrateKbps;
 
   // Hacks
@@ -237,6 +246,9 @@ struct VideoConfig final
   bool UsingUberShaders() const;
   u32 GetShaderCompilerThreads() const;
   u32 GetShaderPrecompilerThreads() const;
+  u32 GetTextureDecodingThreads() const;
+  // The number of samples to hash textures with, 0 for all of them
+  int GetTextureCacheSamples() const;
 };
 
 extern VideoConfig g_Config;
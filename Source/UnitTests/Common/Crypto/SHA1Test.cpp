@@ -0,0 +1,67 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mbedtls/sha1.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
+
+namespace
+{
+std::vector<u8> MakeData(size_t size)
+{
+  std::vector<u8> data(size);
+  u32 state = 0x12345678;
+  for (u8& byte : data)
+  {
+    state = state * 1103515245 + 12345;
+    byte = static_cast<u8>(state >> 16);
+  }
+  return data;
+}
+
+Common::SHA1::Digest ReferenceDigest(const u8* msg, size_t len)
+{
+  Common::SHA1::Digest digest;
+  mbedtls_sha1(msg, len, digest.data());
+  return digest;
+}
+}  // namespace
+
+TEST(SHA1, KnownAnswer)
+{
+  static constexpr char MESSAGE[] = "abc";
+  static constexpr Common::SHA1::Digest EXPECTED{{0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81,
+                                                  0x6a, 0xba, 0x3e, 0x25, 0x71, 0x78, 0x50,
+                                                  0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d}};
+  EXPECT_EQ(EXPECTED, Common::SHA1::CalculateDigest(reinterpret_cast<const u8*>(MESSAGE),
+                                                    std::strlen(MESSAGE)));
+}
+
+TEST(SHA1, MatchesMbedtls)
+{
+  // Covers every position of the final block, where the padding may spill into an extra block.
+  const std::vector<u8> data = MakeData(300);
+  for (size_t size = 0; size <= data.size(); ++size)
+    EXPECT_EQ(ReferenceDigest(data.data(), size), Common::SHA1::CalculateDigest(data.data(), size));
+}
+
+TEST(SHA1, IncrementalUpdates)
+{
+  const std::vector<u8> data = MakeData(0x8000);
+  const Common::SHA1::Digest expected = ReferenceDigest(data.data(), data.size());
+
+  for (size_t chunk_size : {1, 7, 63, 64, 65, 1000, 0x400})
+  {
+    auto context = Common::SHA1::CreateContext();
+    for (size_t offset = 0; offset < data.size(); offset += chunk_size)
+      context->Update(data.data() + offset, std::min(chunk_size, data.size() - offset));
+    EXPECT_EQ(expected, context->Finish());
+  }
+}
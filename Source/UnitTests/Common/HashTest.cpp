@@ -0,0 +1,115 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+
+namespace
+{
+std::vector<u8> MakeRandomData(size_t size, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<u8> data(size);
+  std::generate(data.begin(), data.end(), [&rng] { return static_cast<u8>(rng()); });
+  return data;
+}
+
+struct InstructionSets
+{
+  const char* name;
+  bool sse2;
+  bool avx2;
+};
+
+// The instruction sets the full hash can use on this CPU, selected through cpu_info
+std::vector<InstructionSets> GetInstructionSets()
+{
+  std::vector<InstructionSets> sets = {{"Generic", false, false}};
+#ifdef _M_X86
+  if (cpu_info.bSSE2)
+    sets.push_back({"SSE2", true, false});
+  if (cpu_info.bAVX2)
+    sets.push_back({"AVX2", true, true});
+#endif
+  return sets;
+}
+
+void SelectFullHash(const InstructionSets& sets)
+{
+  const CPUInfo saved = cpu_info;
+  cpu_info.bSSE2 = sets.sse2;
+  cpu_info.bAVX2 = sets.avx2;
+  Common::SetHash64Function(true);
+  cpu_info = saved;
+}
+}  // namespace
+
+TEST(Hash, FullHashMatchesOnEveryInstructionSet)
+{
+  const std::vector<u8> data = MakeRandomData(0x4000, 1);
+  std::vector<u32> lengths;
+  for (u32 len = 0; len <= 300; ++len)
+    lengths.push_back(len);
+  // Around the block size, and texture sizes
+  for (u32 len : {1023u, 1024u, 1025u, 2047u, 2048u, 2049u, 4096u, 0x3000u, 0x3FFFu})
+    lengths.push_back(len);
+
+  const std::vector<InstructionSets> instruction_sets = GetInstructionSets();
+  for (u32 len : lengths)
+  {
+    // Unaligned too
+    for (u32 offset : {0u, 3u})
+    {
+      const u8* src = data.data() + offset;
+      SelectFullHash(instruction_sets[0]);
+      const u64 expected = Common::GetHash64(src, len, 0);
+      for (const InstructionSets& sets : instruction_sets)
+      {
+        SelectFullHash(sets);
+        EXPECT_EQ(expected, Common::GetHash64(src, len, 0)) << sets.name << " " << len;
+        // The samples don't matter
+        EXPECT_EQ(expected, Common::GetHash64(src, len, 128)) << sets.name << " " << len;
+      }
+    }
+  }
+
+  Common::SetHash64Function(false);
+}
+
+TEST(Hash, FullHashCoversEveryByte)
+{
+  for (const InstructionSets& sets : GetInstructionSets())
+  {
+    SelectFullHash(sets);
+
+    // A length which needs every part: whole blocks, whole stripes and an overlapping last stripe
+    std::vector<u8> data = MakeRandomData(2 * 1024 + 3 * 64 + 17, 2);
+    const u64 hash = Common::GetHash64(data.data(), static_cast<u32>(data.size()), 0);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+      data[i] ^= 1;
+      EXPECT_NE(hash, Common::GetHash64(data.data(), static_cast<u32>(data.size()), 0))
+          << sets.name << " " << i;
+      data[i] ^= 1;
+    }
+
+    // Zero extending short data doesn't make it collide with longer data
+    const std::vector<u8> zeros(64);
+    for (u32 len = 0; len < 64; ++len)
+    {
+      EXPECT_NE(Common::GetHash64(zeros.data(), len, 0),
+                Common::GetHash64(zeros.data(), len + 1, 0))
+          << sets.name << " " << len;
+    }
+  }
+
+  Common::SetHash64Function(false);
+}
@@ -0,0 +1,117 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/CompressedBlob.h"
+
+#include "DiscImageTest.h"
+
+namespace
+{
+// The single-threaded compression loop CompressFileToBlob used before it was parallelized,
+// kept here to check that the output didn't change.
+std::vector<u8> ReferenceCompress(const std::vector<u8>& image, u32 block_size)
+{
+  DiscIO::CompressedBlobHeader header;
+  header.magic_cookie = DiscIO::GCZ_MAGIC;
+  header.sub_type = 0;
+  header.block_size = block_size;
+  header.data_size = image.size();
+  header.num_blocks = static_cast<u32>((header.data_size + (block_size - 1)) / block_size);
+
+  std::vector<u64> offsets(header.num_blocks);
+  std::vector<u32> hashes(header.num_blocks);
+  std::vector<u8> data;
+  std::vector<u8> in_buf(block_size);
+  std::vector<u8> out_buf(block_size);
+
+  z_stream z = {};
+  deflateInit(&z, 9);
+  for (u32 i = 0; i < header.num_blocks; i++)
+  {
+    offsets[i] = data.size();
+
+    const size_t offset = static_cast<size_t>(i) * block_size;
+    const size_t length = std::min<size_t>(block_size, image.size() - offset);
+    std::fill(in_buf.begin(), in_buf.end(), 0);
+    std::copy_n(image.begin() + offset, length, in_buf.begin());
+
+    deflateReset(&z);
+    z.next_in = in_buf.data();
+    z.avail_in = block_size;
+    z.next_out = out_buf.data();
+    z.avail_out = block_size;
+    const int status = deflate(&z, Z_FINISH);
+
+    const u8* write_buf = out_buf.data();
+    u32 write_size = block_size - z.avail_out;
+    if (status != Z_STREAM_END || z.avail_out < 10)
+    {
+      write_buf = in_buf.data();
+      write_size = block_size;
+      offsets[i] |= 0x8000000000000000ULL;
+    }
+
+    data.insert(data.end(), write_buf, write_buf + write_size);
+    hashes[i] = Common::HashAdler32(write_buf, write_size);
+  }
+  deflateEnd(&z);
+  header.compressed_data_size = data.size();
+
+  std::vector<u8> result(sizeof(header) + (sizeof(u64) + sizeof(u32)) * header.num_blocks);
+  u8* out = result.data();
+  std::memcpy(out, &header, sizeof(header));
+  out += sizeof(header);
+  std::memcpy(out, offsets.data(), offsets.size() * sizeof(u64));
+  out += offsets.size() * sizeof(u64);
+  std::memcpy(out, hashes.data(), hashes.size() * sizeof(u32));
+  result.insert(result.end(), data.begin(), data.end());
+  return result;
+}
+}  // namespace
+
+class CompressedBlobTest : public DiscImageTest
+{
+protected:
+  CompressedBlobTest() : m_gcz_path(m_temp_dir + "/image.gcz") {}
+
+  std::string m_gcz_path;
+};
+
+TEST_F(CompressedBlobTest, MatchesSerialCompression)
+{
+  const std::vector<u8> image = MakeImage(0x300000 + 0x1234, 0x8000);
+  WriteImage(image);
+
+  for (u32 block_size : {0x4000u, 0x10000u})
+  {
+    ASSERT_TRUE(DiscIO::CompressFileToBlob(m_image_path, m_gcz_path, 0, block_size,
+                                           &ProgressCallback, nullptr));
+    EXPECT_EQ(ReferenceCompress(image, block_size), ReadFile(m_gcz_path)) << block_size;
+
+    std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_gcz_path);
+    ASSERT_TRUE(reader);
+    std::vector<u8> decompressed(image.size());
+    ASSERT_TRUE(reader->Read(0, decompressed.size(), decompressed.data()));
+    EXPECT_EQ(image, decompressed) << block_size;
+    reader.reset();
+
+    ASSERT_TRUE(DiscIO::DecompressBlobToFile(m_gcz_path, m_image_path + ".out", &ProgressCallback,
+                                             nullptr));
+    EXPECT_EQ(image, ReadFile(m_image_path + ".out")) << block_size;
+  }
+}
@@ -0,0 +1,366 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mbedtls/aes.h>
+#include <mbedtls/sha1.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Swap.h"
+#include "Core/IOS/ES/Formats.h"
+#include "Core/IOS/IOSC.h"
+#include "Core/IOS/Uids.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/DCZBlob.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeWii.h"
+
+#include "DiscImageTest.h"
+
+namespace
+{
+// A Wii disc with one encrypted partition, built the way a real disc is laid out.
+struct WiiDisc
+{
+  static constexpr u64 PARTITION_OFFSET = 0x50000;
+  static constexpr u64 H3_TABLE_OFFSET = 0x8000;
+  static constexpr u64 DATA_OFFSET = 0x20000;
+  // Two full groups and a partial one, like at the end of a partition.
+  static constexpr size_t NUM_BLOCKS = 2 * DiscIO::VolumeWii::BLOCKS_PER_GROUP + 13;
+  // In the second group, which can't be reproduced from its decrypted data.
+  static constexpr size_t CORRUPTED_BLOCK = DiscIO::VolumeWii::BLOCKS_PER_GROUP + 6;
+
+  std::array<u8, 16> title_key;
+  // The decrypted partition data
+  std::vector<u8> data;
+  std::vector<u8> image;
+};
+
+WiiDisc MakeWiiDisc()
+{
+  using DiscIO::VolumeWii;
+
+  WiiDisc disc;
+  std::mt19937 rng(1357);
+  std::generate(disc.title_key.begin(), disc.title_key.end(),
+                [&rng] { return static_cast<u8>(rng()); });
+
+  // Repetitive data in the first group, data that doesn't compress in the second and padding
+  // at the end of the last one
+  disc.data.resize(WiiDisc::NUM_BLOCKS * VolumeWii::BLOCK_DATA_SIZE);
+  for (size_t i = 0; i < VolumeWii::GROUP_DATA_SIZE; i++)
+    disc.data[i] = static_cast<u8>((i * 13) ^ (i >> 9));
+  std::generate(disc.data.begin() + VolumeWii::GROUP_DATA_SIZE, disc.data.end() - 0x20000,
+                [&rng] { return static_cast<u8>(rng()); });
+
+  const u64 data_size = WiiDisc::NUM_BLOCKS * VolumeWii::BLOCK_TOTAL_SIZE;
+  disc.image.resize(WiiDisc::PARTITION_OFFSET + WiiDisc::DATA_OFFSET + data_size + 0x4321);
+  u8* image = disc.image.data();
+  const auto write_u32 = [](u8* ptr, u32 value) {
+    const u32 swapped = Common::swap32(value);
+    std::memcpy(ptr, &swapped, sizeof(swapped));
+  };
+
+  std::copy_n("RDZE01", 6, image);
+  write_u32(image + 0x18, 0x5D1C9EA3);
+  // One game partition
+  write_u32(image + 0x40000, 1);
+  write_u32(image + 0x40004, 0x40020 >> 2);
+  write_u32(image + 0x40020, WiiDisc::PARTITION_OFFSET >> 2);
+  write_u32(image + 0x40024, 0);
+  // Something after the partition
+  std::generate(disc.image.end() - 0x4321, disc.image.end(),
+                [&rng] { return static_cast<u8>(rng()); });
+
+  IOS::ES::Ticket ticket = {};
+  ticket.signature.type = static_cast<IOS::SignatureType>(Common::swap32(
+      static_cast<u32>(IOS::SignatureType::RSA2048)));
+  std::strcpy(ticket.signature.issuer, "Root-CA00000001-XS00000003");
+  ticket.title_id = Common::swap64(0x0001000052445A45);
+  u8 iv[16] = {};
+  std::memcpy(iv, &ticket.title_id, sizeof(ticket.title_id));
+  IOS::HLE::IOSC().Encrypt(IOS::HLE::IOSC::HANDLE_COMMON_KEY, iv, disc.title_key.data(), 16,
+                           ticket.title_key, IOS::PID_ES);
+
+  u8* partition = image + WiiDisc::PARTITION_OFFSET;
+  std::memcpy(partition, &ticket, sizeof(ticket));
+  write_u32(partition + 0x2b4, WiiDisc::H3_TABLE_OFFSET >> 2);
+  write_u32(partition + 0x2b8, WiiDisc::DATA_OFFSET >> 2);
+  write_u32(partition + 0x2bc, static_cast<u32>(data_size >> 2));
+
+  u8* encrypted = partition + WiiDisc::DATA_OFFSET;
+  for (size_t block = 0; block < WiiDisc::NUM_BLOCKS; block += VolumeWii::BLOCKS_PER_GROUP)
+  {
+    const size_t num_blocks =
+        std::min<size_t>(VolumeWii::BLOCKS_PER_GROUP, WiiDisc::NUM_BLOCKS - block);
+    u8* group = encrypted + block * VolumeWii::BLOCK_TOTAL_SIZE;
+    VolumeWii::EncryptGroup(&disc.data[block * VolumeWii::BLOCK_DATA_SIZE], num_blocks,
+                            disc.title_key, group);
+
+    // The H3 hash is the hash of the H2 table, which every block of the group has a copy of
+    mbedtls_aes_context aes_context;
+    mbedtls_aes_init(&aes_context);
+    mbedtls_aes_setkey_dec(&aes_context, disc.title_key.data(), 128);
+    u8 header_iv[16] = {};
+    std::array<u8, VolumeWii::BLOCK_HEADER_SIZE> header;
+    mbedtls_aes_crypt_cbc(&aes_context, MBEDTLS_AES_DECRYPT, header.size(), header_iv, group,
+                          header.data());
+    mbedtls_aes_free(&aes_context);
+    mbedtls_sha1(header.data() + 0x340, 20 * 8,
+                 partition + WiiDisc::H3_TABLE_OFFSET + block / VolumeWii::BLOCKS_PER_GROUP * 20);
+  }
+
+  // A bit flip in the data: re-encrypting the group won't give back this block, and the data
+  // which the block decrypts to is what reads of the decrypted partition return
+  encrypted[WiiDisc::CORRUPTED_BLOCK * VolumeWii::BLOCK_TOTAL_SIZE + 0x1234] ^= 0x40;
+  const size_t group_start = WiiDisc::CORRUPTED_BLOCK / VolumeWii::BLOCKS_PER_GROUP *
+                             VolumeWii::BLOCKS_PER_GROUP;
+  VolumeWii::DecryptGroup(encrypted + group_start * VolumeWii::BLOCK_TOTAL_SIZE,
+                          VolumeWii::BLOCKS_PER_GROUP, disc.title_key,
+                          &disc.data[group_start * VolumeWii::BLOCK_DATA_SIZE]);
+
+  return disc;
+}
+}  // namespace
+
+class DCZBlobTest : public DiscImageTest
+{
+protected:
+  DCZBlobTest() : m_dcz_path(m_temp_dir + "/image.dcz") {}
+
+  std::string m_dcz_path;
+};
+
+TEST_F(DCZBlobTest, RoundTrip)
+{
+  const std::vector<u8> image = MakeImage(0x400000 + 0x2345, 0x10000);
+  WriteImage(image);
+
+  for (DiscIO::DCZCodec codec : {DiscIO::DCZCodec::None, DiscIO::DCZCodec::Zlib,
+                                 DiscIO::DCZCodec::LZO})
+  {
+    for (u32 chunk_size : {DiscIO::DCZ_MIN_CHUNK_SIZE, DiscIO::DCZ_MAX_CHUNK_SIZE})
+    {
+      ASSERT_TRUE(DiscIO::CompressFileToDCZ(m_image_path, m_dcz_path, codec, 6, chunk_size, false,
+                                            &ProgressCallback, nullptr));
+
+      std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_dcz_path);
+      ASSERT_TRUE(reader);
+      EXPECT_EQ(DiscIO::BlobType::DCZ, reader->GetBlobType());
+      EXPECT_EQ(image.size(), reader->GetDataSize());
+
+      std::vector<u8> decompressed(image.size());
+      ASSERT_TRUE(reader->Read(0, decompressed.size(), decompressed.data()));
+      EXPECT_EQ(image, decompressed) << static_cast<u32>(codec) << " " << chunk_size;
+
+      // Unaligned reads crossing chunk boundaries.
+      std::vector<u8> part(chunk_size + 0x123);
+      const u64 offset = chunk_size - 0x45;
+      ASSERT_TRUE(reader->Read(offset, part.size(), part.data()));
+      EXPECT_TRUE(std::equal(part.begin(), part.end(), image.begin() + offset));
+    }
+  }
+}
+
+TEST_F(DCZBlobTest, ZeroChunksAreNotStored)
+{
+  std::vector<u8> image(0x800000);
+  std::fill_n(image.begin() + 0x100000, 0x8000, 0xAB);
+  WriteImage(image);
+
+  ASSERT_TRUE(DiscIO::CompressFileToDCZ(m_image_path, m_dcz_path, DiscIO::DCZCodec::None, 0,
+                                        DiscIO::DCZ_MIN_CHUNK_SIZE, false, &ProgressCallback,
+                                        nullptr));
+
+  // Only the one chunk that isn't zero takes up space besides the headers.
+  const u64 num_chunks = image.size() / DiscIO::DCZ_MIN_CHUNK_SIZE;
+  EXPECT_EQ(sizeof(DiscIO::DCZHeader) + num_chunks * sizeof(DiscIO::DCZChunk) +
+                DiscIO::DCZ_MIN_CHUNK_SIZE,
+            File::GetSize(m_dcz_path));
+
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_dcz_path);
+  ASSERT_TRUE(reader);
+  std::vector<u8> decompressed(image.size());
+  ASSERT_TRUE(reader->Read(0, decompressed.size(), decompressed.data()));
+  EXPECT_EQ(image, decompressed);
+}
+
+TEST_F(DCZBlobTest, DecompressToFile)
+{
+  const std::vector<u8> image = MakeImage(0x300000 + 0x2345, 0x10000);
+  WriteImage(image);
+
+  ASSERT_TRUE(DiscIO::CompressFileToDCZ(m_image_path, m_dcz_path, DiscIO::DCZCodec::Zlib, 6,
+                                        DiscIO::DCZ_MAX_CHUNK_SIZE, false, &ProgressCallback,
+                                        nullptr));
+  const std::string out_path = m_temp_dir + "/image.gcm";
+  ASSERT_TRUE(DiscIO::DecompressBlobToFile(m_dcz_path, out_path, &ProgressCallback, nullptr));
+
+  EXPECT_EQ(image, ReadFile(out_path));
+}
+
+TEST_F(DCZBlobTest, InvalidChunkTableIsRejected)
+{
+  const std::vector<u8> image = MakeImage(0x100000, 0x10000);
+  WriteImage(image);
+  ASSERT_TRUE(DiscIO::CompressFileToDCZ(m_image_path, m_dcz_path, DiscIO::DCZCodec::Zlib, 6,
+                                        DiscIO::DCZ_MIN_CHUNK_SIZE, false, &ProgressCallback,
+                                        nullptr));
+  const std::vector<u8> dcz = ReadFile(m_dcz_path);
+
+  const auto corrupt_chunk = [&](auto modify) {
+    std::vector<u8> corrupted = dcz;
+    DiscIO::DCZChunk chunk;
+    std::memcpy(&chunk, &corrupted[sizeof(DiscIO::DCZHeader)], sizeof(chunk));
+    modify(&chunk);
+    std::memcpy(&corrupted[sizeof(DiscIO::DCZHeader)], &chunk, sizeof(chunk));
+    File::IOFile file(m_dcz_path, "wb");
+    file.WriteBytes(corrupted.data(), corrupted.size());
+  };
+
+  // Too big for a compressed chunk
+  corrupt_chunk([](DiscIO::DCZChunk* chunk) {
+    chunk->type = DiscIO::DCZChunkType::Compressed;
+    chunk->size = 0xFFFFFFFF;
+  });
+  EXPECT_FALSE(DiscIO::CreateBlobReader(m_dcz_path));
+
+  // Past the end of the file
+  corrupt_chunk([&dcz](DiscIO::DCZChunk* chunk) { chunk->offset = dcz.size() - 1; });
+  EXPECT_FALSE(DiscIO::CreateBlobReader(m_dcz_path));
+
+  // Unchanged
+  corrupt_chunk([](DiscIO::DCZChunk*) {});
+  EXPECT_TRUE(DiscIO::CreateBlobReader(m_dcz_path));
+}
+
+TEST_F(DCZBlobTest, EncryptedWiiPartition)
+{
+  using DiscIO::VolumeWii;
+
+  const WiiDisc disc = MakeWiiDisc();
+  WriteImage(disc.image);
+  const DiscIO::Partition partition(WiiDisc::PARTITION_OFFSET);
+  const u64 data_offset = WiiDisc::PARTITION_OFFSET + WiiDisc::DATA_OFFSET;
+
+  ASSERT_TRUE(DiscIO::CompressFileToDCZ(m_image_path, m_dcz_path, DiscIO::DCZCodec::Zlib, 6,
+                                        DiscIO::DCZ_DEFAULT_CHUNK_SIZE, false, &ProgressCallback,
+                                        nullptr));
+
+  // The groups that can be encrypted again are stored decrypted, the corrupted one as it was.
+  {
+    File::IOFile file(m_dcz_path, "rb");
+    DiscIO::DCZHeader header;
+    ASSERT_TRUE(file.ReadArray(&header, 1));
+    ASSERT_EQ(1u, header.num_wii_partitions);
+    DiscIO::DCZWiiPartition dcz_partition;
+    ASSERT_TRUE(file.ReadArray(&dcz_partition, 1));
+    EXPECT_EQ(WiiDisc::PARTITION_OFFSET, dcz_partition.partition_offset);
+    EXPECT_EQ(data_offset, dcz_partition.data_offset);
+    EXPECT_EQ(disc.title_key, dcz_partition.title_key);
+    ASSERT_EQ(3u, dcz_partition.num_chunks);
+    std::vector<DiscIO::DCZChunk> chunks(header.num_chunks);
+    ASSERT_TRUE(file.ReadArray(chunks.data(), chunks.size()));
+    EXPECT_EQ(DiscIO::DCZChunkType::Compressed, chunks[dcz_partition.first_chunk].type);
+    EXPECT_EQ(DiscIO::DCZChunkType::StoredEncrypted, chunks[dcz_partition.first_chunk + 1].type);
+    EXPECT_EQ(DiscIO::DCZChunkType::Compressed, chunks[dcz_partition.first_chunk + 2].type);
+  }
+
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_dcz_path);
+  ASSERT_TRUE(reader);
+  ASSERT_TRUE(reader->SupportsReadWiiDecrypted());
+
+  // Raw reads encrypt the groups and compute their hashes again
+  std::vector<u8> raw(disc.image.size());
+  ASSERT_TRUE(reader->Read(0, raw.size(), raw.data()));
+  EXPECT_EQ(disc.image, raw);
+
+  std::vector<u8> decrypted(disc.data.size());
+  ASSERT_TRUE(reader->ReadWiiDecrypted(0, decrypted.size(), decrypted.data(),
+                                       WiiDisc::PARTITION_OFFSET));
+  EXPECT_EQ(disc.data, decrypted);
+
+  // Unaligned, across the groups
+  std::vector<u8> part(VolumeWii::GROUP_DATA_SIZE + 0x123);
+  const u64 offset = VolumeWii::GROUP_DATA_SIZE - 0x45;
+  ASSERT_TRUE(reader->ReadWiiDecrypted(offset, part.size(), part.data(),
+                                       WiiDisc::PARTITION_OFFSET));
+  EXPECT_TRUE(std::equal(part.begin(), part.end(), disc.data.begin() + offset));
+  EXPECT_FALSE(reader->ReadWiiDecrypted(0, decrypted.size() + 1, decrypted.data(),
+                                        WiiDisc::PARTITION_OFFSET));
+  reader.reset();
+
+  // Reads through the volume, which uses ReadWiiDecrypted for DCZ and decrypts for the ISO
+  for (const std::string& path : {m_image_path, m_dcz_path})
+  {
+    std::unique_ptr<DiscIO::Volume> volume = DiscIO::CreateVolumeFromFilename(path);
+    ASSERT_TRUE(volume);
+    ASSERT_EQ(partition, volume->GetGamePartition());
+    std::fill(decrypted.begin(), decrypted.end(), 0);
+    ASSERT_TRUE(volume->Read(0, decrypted.size(), decrypted.data(), partition));
+    EXPECT_EQ(disc.data, decrypted) << path;
+
+    // Checks the H0 to H3 hashes
+    for (u64 block = 0; block < WiiDisc::NUM_BLOCKS; block++)
+    {
+      EXPECT_EQ(block != WiiDisc::CORRUPTED_BLOCK, volume->CheckBlockIntegrity(block, partition))
+          << path << " " << block;
+    }
+  }
+
+  // And back to an ISO
+  ASSERT_TRUE(DiscIO::DecompressBlobToFile(m_dcz_path, m_image_path + ".out", &ProgressCallback,
+                                           nullptr));
+  EXPECT_EQ(disc.image, ReadFile(m_image_path + ".out"));
+}
+
+TEST(VolumeWiiGroup, EncryptDecryptRoundTrip)
+{
+  using DiscIO::VolumeWii;
+
+  std::mt19937 rng(2468);
+  std::array<u8, 16> key;
+  std::generate(key.begin(), key.end(), [&rng] { return static_cast<u8>(rng()); });
+
+  // A full group and the kind of partial group found at the end of a partition.
+  for (size_t num_blocks : {size_t(VolumeWii::BLOCKS_PER_GROUP), size_t(13)})
+  {
+    std::vector<u8> data(num_blocks * VolumeWii::BLOCK_DATA_SIZE);
+    std::generate(data.begin(), data.end(), [&rng] { return static_cast<u8>(rng()); });
+
+    std::vector<u8> encrypted(num_blocks * VolumeWii::BLOCK_TOTAL_SIZE);
+    VolumeWii::EncryptGroup(data.data(), num_blocks, key, encrypted.data());
+    std::vector<u8> decrypted(data.size());
+    VolumeWii::DecryptGroup(encrypted.data(), num_blocks, key, decrypted.data());
+    EXPECT_EQ(data, decrypted);
+
+    // The H0 hashes of the last block are where CheckBlockIntegrity looks for them.
+    const size_t last = num_blocks - 1;
+    mbedtls_aes_context aes_context;
+    mbedtls_aes_init(&aes_context);
+    mbedtls_aes_setkey_dec(&aes_context, key.data(), 128);
+    u8 iv[16] = {};
+    std::array<u8, VolumeWii::BLOCK_HEADER_SIZE> header;
+    mbedtls_aes_crypt_cbc(&aes_context, MBEDTLS_AES_DECRYPT, header.size(), iv,
+                          &encrypted[last * VolumeWii::BLOCK_TOTAL_SIZE], header.data());
+    mbedtls_aes_free(&aes_context);
+
+    for (size_t i = 0; i < 31; i++)
+    {
+      u8 hash[20];
+      mbedtls_sha1(&data[last * VolumeWii::BLOCK_DATA_SIZE + i * 0x400], 0x400, hash);
+      EXPECT_TRUE(std::equal(hash, hash + sizeof(hash), header.begin() + i * sizeof(hash)));
+    }
+  }
+}
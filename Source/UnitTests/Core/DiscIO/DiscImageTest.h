@@ -0,0 +1,133 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+
+// Base fixture for tests that write disc images, which go in a temporary directory that is
+// deleted afterwards.
+class DiscImageTest : public testing::Test
+{
+protected:
+  DiscImageTest()
+      : m_temp_dir(File::CreateTempDir()), m_image_path(m_temp_dir + "/image.iso")
+  {
+  }
+
+  ~DiscImageTest() override { File::DeleteDirRecursively(m_temp_dir); }
+
+  void WriteImage(const std::vector<u8>& image)
+  {
+    File::IOFile file(m_image_path, "wb");
+    file.WriteBytes(image.data(), image.size());
+  }
+
+  // A mix of what disc images contain: padding, repetitive data and data that doesn't compress,
+  // in runs of run_size bytes. Pick a size that isn't a multiple of any block size being tested.
+  static std::vector<u8> MakeImage(size_t size, size_t run_size)
+  {
+    std::mt19937 rng(4321);
+    std::vector<u8> image(size);
+    for (size_t offset = 0; offset < size; offset += run_size)
+    {
+      const size_t length = std::min(run_size, size - offset);
+      switch (rng() % 3)
+      {
+      case 0:
+        break;
+      case 1:
+        for (size_t i = 0; i < length; i++)
+          image[offset + i] = static_cast<u8>((i * 7) ^ (i >> 5));
+        break;
+      case 2:
+        std::generate_n(image.begin() + offset, length, [&rng] { return static_cast<u8>(rng()); });
+        break;
+      }
+    }
+    return image;
+  }
+
+  static std::vector<u8> ReadFile(const std::string& path)
+  {
+    File::IOFile file(path, "rb");
+    std::vector<u8> data(file.GetSize());
+    file.ReadBytes(data.data(), data.size());
+    return data;
+  }
+
+  // For the CompressCB parameters
+  static bool ProgressCallback(const std::string&, float, void*) { return true; }
+
+  std::string m_temp_dir;
+  std::string m_image_path;
+};
+
+// Generates the data of its blocks instead of reading it, and counts the blocks it generated
+class TestSectorReader final : public DiscIO::SectorReader
+{
+public:
+  static constexpr u32 BLOCK_SIZE = 0x4000;
+
+  explicit TestSectorReader(u64 num_blocks, int chunk_blocks = 1) : m_num_blocks(num_blocks)
+  {
+    SetSectorSize(BLOCK_SIZE);
+    SetChunkSize(chunk_blocks);
+  }
+  ~TestSectorReader() override { StopPrefetching(); }
+
+  using DiscIO::SectorReader::EnablePrefetching;
+  using DiscIO::SectorReader::EnableSharedCache;
+  using DiscIO::SectorReader::GetCacheStats;
+  using DiscIO::SectorReader::StopPrefetching;
+
+  static u8 ExpectedByte(u64 offset) { return static_cast<u8>(offset / BLOCK_SIZE * 31 + offset); }
+
+  DiscIO::BlobType GetBlobType() const override { return DiscIO::BlobType::GCZ; }
+  u64 GetRawSize() const override { return GetDataSize(); }
+  u64 GetDataSize() const override { return m_num_blocks * BLOCK_SIZE; }
+  bool IsDataSizeAccurate() const override { return true; }
+
+  bool GetBlock(u64 block_num, u8* out_ptr) override
+  {
+    if (block_num >= m_num_blocks)
+      return false;
+    for (u32 i = 0; i < BLOCK_SIZE; ++i)
+      out_ptr[i] = ExpectedByte(block_num * BLOCK_SIZE + i);
+    m_blocks_read++;
+    return true;
+  }
+
+  u64 GetBlocksRead() const { return m_blocks_read; }
+
+  // Reads through the cache and checks that the data is what GetBlock generated
+  bool CheckRead(u64 offset, u64 size)
+  {
+    std::vector<u8> buffer(size);
+    if (!Read(offset, size, buffer.data()))
+      return false;
+    for (u64 i = 0; i < size; ++i)
+    {
+      if (buffer[i] != ExpectedByte(offset + i))
+        return false;
+    }
+    return true;
+  }
+
+private:
+  u64 m_num_blocks;
+  std::atomic<u64> m_blocks_read{0};
+};
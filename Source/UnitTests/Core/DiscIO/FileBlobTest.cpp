@@ -0,0 +1,70 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/FileBlob.h"
+
+#include "DiscImageTest.h"
+
+namespace
+{
+class FileBlobTest : public DiscImageTest
+{
+protected:
+  FileBlobTest()
+  {
+    m_data.resize(0x123456);
+    for (size_t i = 0; i < m_data.size(); ++i)
+      m_data[i] = static_cast<u8>(i * 7 + (i >> 12));
+    WriteImage(m_data);
+  }
+
+  std::vector<u8> m_data;
+};
+}  // namespace
+
+TEST_F(FileBlobTest, NotMappedByDefault)
+{
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_image_path);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(nullptr, reader->GetMappedData(0, 0x20));
+
+  std::vector<u8> buffer(0x20);
+  ASSERT_TRUE(reader->Read(0x8765, buffer.size(), buffer.data()));
+  EXPECT_EQ(0, std::memcmp(m_data.data() + 0x8765, buffer.data(), buffer.size()));
+}
+
+TEST_F(FileBlobTest, MappedDataMatchesFile)
+{
+  DiscIO::PlainFileReader::SetMappingEnabled(true);
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_image_path);
+  DiscIO::PlainFileReader::SetMappingEnabled(false);
+  ASSERT_TRUE(reader);
+  ASSERT_EQ(DiscIO::BlobType::PLAIN, reader->GetBlobType());
+
+  const u8* mapped = reader->GetMappedData(0, m_data.size());
+  ASSERT_NE(nullptr, mapped);
+  EXPECT_EQ(0, std::memcmp(m_data.data(), mapped, m_data.size()));
+  EXPECT_EQ(mapped + 0x1000, reader->GetMappedData(0x1000, 0x20));
+
+  // Ranges that extend past the end can't be mapped, and reading them must fail like before
+  EXPECT_EQ(nullptr, reader->GetMappedData(m_data.size() - 0x10, 0x20));
+  EXPECT_EQ(nullptr, reader->GetMappedData(m_data.size() + 1, 0));
+  std::vector<u8> buffer(0x20);
+  EXPECT_FALSE(reader->Read(m_data.size() - 0x10, buffer.size(), buffer.data()));
+
+  // A failed read must not affect later ones
+  ASSERT_TRUE(reader->Read(0x8765, buffer.size(), buffer.data()));
+  EXPECT_EQ(0, std::memcmp(m_data.data() + 0x8765, buffer.data(), buffer.size()));
+}
@@ -0,0 +1,68 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/Blob.h"
+
+#include "DiscImageTest.h"
+
+constexpr u32 BLOCK_SIZE = TestSectorReader::BLOCK_SIZE;
+
+TEST(SectorReader, SequentialReadsArePrefetched)
+{
+  constexpr u64 NUM_BLOCKS = 256;
+  TestSectorReader reader(NUM_BLOCKS);
+  reader.EnablePrefetching();
+
+  // Unaligned reads spanning two or three blocks, like DVDThread does for streamed files
+  for (u64 offset = 0x100; offset < reader.GetDataSize(); offset += 0x8000)
+    ASSERT_TRUE(reader.CheckRead(offset, std::min<u64>(0x8000, reader.GetDataSize() - offset)));
+
+  const auto& stats = reader.GetCacheStats();
+  EXPECT_LE(stats.misses, 3u);
+  EXPECT_EQ(NUM_BLOCKS, stats.misses + stats.prefetch_hits);
+  EXPECT_EQ(0u, stats.prefetches_wasted);
+  EXPECT_EQ(NUM_BLOCKS, reader.GetBlocksRead());
+}
+
+TEST(SectorReader, ScatteredReadsAreNotPrefetched)
+{
+  constexpr u64 NUM_BLOCKS = 1024;
+  TestSectorReader reader(NUM_BLOCKS);
+  reader.EnablePrefetching();
+
+  for (u64 i = 0; i < 200; ++i)
+  {
+    const u64 block = i * 37 % NUM_BLOCKS;
+    ASSERT_TRUE(reader.CheckRead(block * BLOCK_SIZE + 0x10, 0x100));
+  }
+
+  const auto& stats = reader.GetCacheStats();
+  EXPECT_EQ(0u, stats.prefetches);
+  EXPECT_EQ(200u, stats.misses);
+}
+
+TEST(SectorReader, SeekingWastesPrefetchedChunks)
+{
+  constexpr u64 NUM_BLOCKS = 1024;
+  TestSectorReader reader(NUM_BLOCKS);
+  reader.EnablePrefetching();
+
+  for (u64 block = 0; block < 32; ++block)
+    ASSERT_TRUE(reader.CheckRead(block * BLOCK_SIZE, BLOCK_SIZE));
+  ASSERT_TRUE(reader.CheckRead(500 * BLOCK_SIZE, BLOCK_SIZE));
+  // The data must still be right after switching back and forth
+  for (u64 block = 32; block < 40; ++block)
+    ASSERT_TRUE(reader.CheckRead(block * BLOCK_SIZE, BLOCK_SIZE));
+  reader.StopPrefetching();
+
+  const auto& stats = reader.GetCacheStats();
+  EXPECT_GT(stats.prefetch_hits, 0u);
+  EXPECT_EQ(stats.prefetches, stats.prefetch_hits + stats.prefetches_wasted);
+}
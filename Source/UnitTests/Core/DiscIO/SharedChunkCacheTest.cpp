@@ -0,0 +1,229 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/SharedChunkCache.h"
+
+#include "DiscImageTest.h"
+
+namespace
+{
+constexpr u32 MAX_CHUNK_SIZE = 0x20000;
+// The chunk sizes of the caches that the tests create
+constexpr u32 CHUNK_SIZES[] = {0x4000, MAX_CHUNK_SIZE, 0x100000};
+
+std::vector<u8> MakeChunk(u64 image_id, u64 chunk_idx, u32 size)
+{
+  std::vector<u8> data(size);
+  for (u32 i = 0; i < size; ++i)
+    data[i] = static_cast<u8>(image_id * 13 + chunk_idx * 7 + i + (i >> 8));
+  return data;
+}
+
+class SharedChunkCacheTest : public testing::Test
+{
+protected:
+  // Each instance of Dolphin maps the cache separately, so two mappings in one process
+  // behave like two processes.
+  SharedChunkCacheTest() { Remove(); }
+  ~SharedChunkCacheTest() override { Remove(); }
+
+  std::shared_ptr<DiscIO::SharedChunkCache> Open(u64 size, u32 chunk_size = MAX_CHUNK_SIZE)
+  {
+    return DiscIO::SharedChunkCache::Open(m_name, size, chunk_size);
+  }
+
+  // Caches left over from a test that crashed
+  void Remove()
+  {
+    for (u32 chunk_size : CHUNK_SIZES)
+      DiscIO::SharedChunkCache::Remove(m_name, chunk_size);
+  }
+
+  const std::string m_name = "dolphin-chunks-test";
+};
+
+bool ReadAll(TestSectorReader& reader, u64 num_blocks)
+{
+  for (u64 block = 0; block < num_blocks; ++block)
+  {
+    if (!reader.CheckRead(block * TestSectorReader::BLOCK_SIZE, TestSectorReader::BLOCK_SIZE))
+      return false;
+  }
+  return true;
+}
+}  // namespace
+
+TEST_F(SharedChunkCacheTest, SharedBetweenMappings)
+{
+  std::shared_ptr<DiscIO::SharedChunkCache> first = Open(0x1000000);
+  ASSERT_TRUE(first);
+  // The size of the existing cache wins
+  std::shared_ptr<DiscIO::SharedChunkCache> second = Open(0x2000000);
+  ASSERT_TRUE(second);
+  EXPECT_EQ(first->GetSize(), second->GetSize());
+
+  const std::vector<u8> chunk = MakeChunk(1, 2, 0x4000);
+  std::vector<u8> buffer(MAX_CHUNK_SIZE);
+  EXPECT_EQ(0u, second->Lookup(1, 2, buffer.data(), MAX_CHUNK_SIZE));
+  first->Store(1, 2, chunk.data(), static_cast<u32>(chunk.size()));
+  ASSERT_EQ(chunk.size(), second->Lookup(1, 2, buffer.data(), MAX_CHUNK_SIZE));
+  buffer.resize(chunk.size());
+  EXPECT_EQ(chunk, buffer);
+
+  // Other images, other chunks and too small buffers all miss
+  buffer.resize(MAX_CHUNK_SIZE);
+  EXPECT_EQ(0u, second->Lookup(2, 2, buffer.data(), MAX_CHUNK_SIZE));
+  EXPECT_EQ(0u, second->Lookup(1, 3, buffer.data(), MAX_CHUNK_SIZE));
+  EXPECT_EQ(0u, second->Lookup(1, 2, buffer.data(), 0x3FFF));
+
+  EXPECT_EQ(1u, first->GetStats().stores);
+  EXPECT_EQ(1u, second->GetStats().hits);
+  EXPECT_EQ(4u, second->GetStats().misses);
+}
+
+TEST_F(SharedChunkCacheTest, DeletedWhenLastMappingCloses)
+{
+  std::shared_ptr<DiscIO::SharedChunkCache> first = Open(0x1000000);
+  std::shared_ptr<DiscIO::SharedChunkCache> second = Open(0x2000000);
+  ASSERT_TRUE(first && second);
+  const std::vector<u8> chunk = MakeChunk(1, 2, 0x4000);
+  first->Store(1, 2, chunk.data(), static_cast<u32>(chunk.size()));
+
+  // Still open in the second mapping
+  first.reset();
+  std::shared_ptr<DiscIO::SharedChunkCache> third = Open(0x2000000);
+  ASSERT_TRUE(third);
+  EXPECT_EQ(0x1000000u, third->GetSize());
+  std::vector<u8> buffer(MAX_CHUNK_SIZE);
+  EXPECT_EQ(chunk.size(), third->Lookup(1, 2, buffer.data(), MAX_CHUNK_SIZE));
+
+  // A new cache with the new size, without the old chunks
+  second.reset();
+  third.reset();
+  std::shared_ptr<DiscIO::SharedChunkCache> fourth = Open(0x2000000);
+  ASSERT_TRUE(fourth);
+  EXPECT_EQ(0x2000000u, fourth->GetSize());
+  EXPECT_EQ(0u, fourth->Lookup(1, 2, buffer.data(), MAX_CHUNK_SIZE));
+}
+
+TEST_F(SharedChunkCacheTest, SlotsFitTheChunkSize)
+{
+  std::shared_ptr<DiscIO::SharedChunkCache> small = Open(0x1000000, 0x4000);
+  std::shared_ptr<DiscIO::SharedChunkCache> big = Open(0x1000000, 0x100000);
+  ASSERT_TRUE(small && big);
+  EXPECT_EQ(0x4000u, small->GetSlotSize());
+  EXPECT_EQ(0x100000u, big->GetSlotSize());
+  EXPECT_EQ(0x1000000u, small->GetSize());
+  EXPECT_EQ(0x1000000u, big->GetSize());
+
+  std::vector<u8> buffer(0x100000);
+  const std::vector<u8> big_chunk = MakeChunk(1, 0, 0x100000);
+  small->Store(1, 0, big_chunk.data(), static_cast<u32>(big_chunk.size()));
+  EXPECT_EQ(0u, small->Lookup(1, 0, buffer.data(), static_cast<u32>(buffer.size())));
+  big->Store(1, 0, big_chunk.data(), static_cast<u32>(big_chunk.size()));
+  EXPECT_EQ(big_chunk.size(), big->Lookup(1, 0, buffer.data(), static_cast<u32>(buffer.size())));
+  EXPECT_EQ(big_chunk, buffer);
+}
+
+TEST_F(SharedChunkCacheTest, EvictsOldestChunkInSet)
+{
+  // The smallest cache is a single set
+  std::shared_ptr<DiscIO::SharedChunkCache> cache = Open(0);
+  ASSERT_TRUE(cache);
+  const u64 num_slots = cache->GetSize() / MAX_CHUNK_SIZE;
+
+  for (u64 i = 0; i <= num_slots; ++i)
+  {
+    const std::vector<u8> chunk = MakeChunk(7, i, 0x8000);
+    cache->Store(7, i, chunk.data(), static_cast<u32>(chunk.size()));
+  }
+
+  std::vector<u8> buffer(MAX_CHUNK_SIZE);
+  EXPECT_EQ(0u, cache->Lookup(7, 0, buffer.data(), MAX_CHUNK_SIZE));
+  for (u64 i = 1; i <= num_slots; ++i)
+    EXPECT_EQ(0x8000u, cache->Lookup(7, i, buffer.data(), MAX_CHUNK_SIZE));
+}
+
+TEST_F(SharedChunkCacheTest, ConcurrentAccessNeverReturnsTornChunks)
+{
+  // Few slots, so that the threads keep overwriting each other's chunks
+  std::shared_ptr<DiscIO::SharedChunkCache> first = Open(8 * MAX_CHUNK_SIZE);
+  std::shared_ptr<DiscIO::SharedChunkCache> second = Open(8 * MAX_CHUNK_SIZE);
+  ASSERT_TRUE(first && second);
+
+  std::atomic<u64> bad_chunks{0};
+  std::vector<std::thread> threads;
+  for (u32 t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&, t] {
+      DiscIO::SharedChunkCache& cache = t % 2 ? *first : *second;
+      std::vector<u8> buffer(MAX_CHUNK_SIZE);
+      for (u64 i = 0; i < 2000; ++i)
+      {
+        const u64 chunk_idx = (i * 7 + t) % 40;
+        const u32 size = static_cast<u32>(0x1000 * (chunk_idx % 8 + 1));
+        const u32 found = cache.Lookup(3, chunk_idx, buffer.data(), MAX_CHUNK_SIZE);
+        if (found)
+        {
+          buffer.resize(found);
+          if (found != size || buffer != MakeChunk(3, chunk_idx, size))
+            bad_chunks++;
+          buffer.resize(MAX_CHUNK_SIZE);
+        }
+        else
+        {
+          const std::vector<u8> chunk = MakeChunk(3, chunk_idx, size);
+          cache.Store(3, chunk_idx, chunk.data(), size);
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(0u, bad_chunks);
+  EXPECT_GT(first->GetStats().hits + second->GetStats().hits, 0u);
+}
+
+TEST_F(SharedChunkCacheTest, SectorReadersShareChunks)
+{
+  // Big enough that no set overflows
+  DiscIO::SharedChunkCache::SetGlobal(m_name, 0x4000000);
+
+  constexpr u64 NUM_BLOCKS = 64;
+  // The readers pretend to be the same image
+  const Common::SHA1::Digest hash =
+      Common::SHA1::CalculateDigest(reinterpret_cast<const u8*>("image"), 5);
+  TestSectorReader first(NUM_BLOCKS);
+  TestSectorReader second(NUM_BLOCKS);
+  first.EnableSharedCache(hash);
+  second.EnableSharedCache(hash);
+  EXPECT_TRUE(ReadAll(first, NUM_BLOCKS));
+  EXPECT_TRUE(ReadAll(second, NUM_BLOCKS));
+  EXPECT_EQ(NUM_BLOCKS, first.GetBlocksRead());
+  EXPECT_EQ(0u, second.GetBlocksRead());
+
+  // Chunks as big as DCZ allows
+  TestSectorReader third(NUM_BLOCKS, 64);
+  TestSectorReader fourth(NUM_BLOCKS, 64);
+  third.EnableSharedCache(hash);
+  fourth.EnableSharedCache(hash);
+  EXPECT_TRUE(ReadAll(third, NUM_BLOCKS));
+  EXPECT_TRUE(ReadAll(fourth, NUM_BLOCKS));
+  EXPECT_EQ(NUM_BLOCKS, third.GetBlocksRead());
+  EXPECT_EQ(0u, fourth.GetBlocksRead());
+
+  DiscIO::SharedChunkCache::SetGlobal("", 0);
+}
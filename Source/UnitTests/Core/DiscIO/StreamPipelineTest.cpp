@@ -0,0 +1,154 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/StreamPipeline.h"
+
+namespace
+{
+constexpr size_t CHUNK_SIZE = 0x100;
+
+// Reverses the chunk, taking longer for some chunks so that they finish out of order
+class ReverseTransform final : public DiscIO::ChunkTransform
+{
+public:
+  bool Transform(DiscIO::PipelineChunk* chunk) override
+  {
+    if (chunk->index % 3 == 0)
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    chunk->out_buf.assign(chunk->in_buf.rbegin(), chunk->in_buf.rend());
+    chunk->write_size = chunk->out_buf.size();
+    chunk->hash = static_cast<u32>(chunk->index);
+    return chunk->index != 1000;
+  }
+};
+
+void FillChunk(DiscIO::PipelineChunk* chunk)
+{
+  chunk->in_buf.resize(CHUNK_SIZE);
+  for (size_t i = 0; i < CHUNK_SIZE; ++i)
+    chunk->in_buf[i] = static_cast<u8>(chunk->index * 7 + i);
+}
+}  // namespace
+
+TEST(StreamPipeline, TransformedChunksAreWrittenInOrder)
+{
+  constexpr u64 NUM_CHUNKS = 200;
+  DiscIO::StreamPipeline pipeline;
+  pipeline.read = [](DiscIO::PipelineChunk* chunk) {
+    FillChunk(chunk);
+    return true;
+  };
+  pipeline.transform = [] { return std::make_unique<ReverseTransform>(); };
+
+  u64 next_chunk = 0;
+  bool data_ok = true;
+  pipeline.write = [&](const DiscIO::PipelineChunk& chunk) {
+    EXPECT_EQ(next_chunk, chunk.index);
+    EXPECT_EQ(next_chunk, chunk.hash);
+    DiscIO::PipelineChunk expected;
+    expected.index = chunk.index;
+    FillChunk(&expected);
+    std::reverse(expected.in_buf.begin(), expected.in_buf.end());
+    data_ok &= std::equal(expected.in_buf.begin(), expected.in_buf.end(), chunk.GetOutput()) &&
+               chunk.write_size == CHUNK_SIZE;
+    ++next_chunk;
+    return true;
+  };
+
+  EXPECT_EQ(DiscIO::StreamPipeline::Result::Success, pipeline.Run(NUM_CHUNKS));
+  EXPECT_EQ(NUM_CHUNKS, next_chunk);
+  EXPECT_TRUE(data_ok);
+}
+
+TEST(StreamPipeline, ReaderStaysTwoChunksAheadWithoutTransform)
+{
+  constexpr u64 NUM_CHUNKS = 100;
+  std::atomic<u64> num_read{0};
+  std::atomic<u64> num_written{0};
+  std::atomic<u64> max_ahead{0};
+
+  DiscIO::StreamPipeline pipeline;
+  pipeline.read = [&](DiscIO::PipelineChunk* chunk) {
+    FillChunk(chunk);
+    const u64 ahead = ++num_read - num_written;
+    if (ahead > max_ahead)
+      max_ahead = ahead;
+    return true;
+  };
+  pipeline.write = [&](const DiscIO::PipelineChunk& chunk) {
+    // Give the reader time to get ahead
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    ++num_written;
+    return chunk.stored && chunk.write_size == CHUNK_SIZE &&
+           chunk.GetOutput()[1] == static_cast<u8>(chunk.index * 7 + 1);
+  };
+
+  EXPECT_EQ(DiscIO::StreamPipeline::Result::Success, pipeline.Run(NUM_CHUNKS));
+  EXPECT_EQ(NUM_CHUNKS, num_written);
+  EXPECT_LE(max_ahead, 2u);
+}
+
+TEST(StreamPipeline, ProgressCallbackCancels)
+{
+  std::atomic<u64> num_read{0};
+  u64 num_written = 0;
+
+  DiscIO::StreamPipeline pipeline;
+  pipeline.read = [&](DiscIO::PipelineChunk* chunk) {
+    FillChunk(chunk);
+    ++num_read;
+    return true;
+  };
+  pipeline.transform = [] { return std::make_unique<ReverseTransform>(); };
+  pipeline.write = [&](const DiscIO::PipelineChunk&) {
+    ++num_written;
+    return true;
+  };
+  pipeline.progress = [](u64 chunks_done, u64 num_chunks) {
+    EXPECT_EQ(100000u, num_chunks);
+    return chunks_done < 10;
+  };
+
+  EXPECT_EQ(DiscIO::StreamPipeline::Result::Cancelled, pipeline.Run(100000));
+  EXPECT_EQ(10u, num_written);
+  // The reader stops too instead of going through the whole input
+  EXPECT_LT(num_read, 1000u);
+}
+
+TEST(StreamPipeline, FailuresStopThePipeline)
+{
+  const auto run = [](u64 num_chunks, u64 bad_read, u64 bad_write, bool transform) {
+    DiscIO::StreamPipeline pipeline;
+    pipeline.read = [bad_read](DiscIO::PipelineChunk* chunk) {
+      FillChunk(chunk);
+      return chunk->index != bad_read;
+    };
+    if (transform)
+      pipeline.transform = [] { return std::make_unique<ReverseTransform>(); };
+    pipeline.write = [bad_write](const DiscIO::PipelineChunk& chunk) {
+      return chunk.index != bad_write;
+    };
+    return pipeline.Run(num_chunks);
+  };
+
+  using Result = DiscIO::StreamPipeline::Result;
+  EXPECT_EQ(Result::ReadFailed, run(100, 50, 2000, true));
+  EXPECT_EQ(Result::ReadFailed, run(100, 50, 2000, false));
+  EXPECT_EQ(Result::ReadFailed, run(1, 0, 2000, false));
+  EXPECT_EQ(Result::WriteFailed, run(100, 2000, 50, true));
+  EXPECT_EQ(Result::WriteFailed, run(100, 2000, 50, false));
+  // ReverseTransform fails for chunk 1000
+  EXPECT_EQ(Result::TransformFailed, run(2000, 3000, 3000, true));
+  EXPECT_EQ(Result::Success, run(0, 2000, 2000, true));
+}
@@ -0,0 +1,168 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Core/Config/MainSettings.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/EXI/EXI.h"
+#include "Core/HW/Memmap.h"
+#include "Core/MemTools.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 PAGE_SIZE = 0x1000;
+
+class MemoryWriteTrackingTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    if (!EMM::IsExceptionHandlerProcessWide())
+      return;
+
+    m_profile_path = File::CreateTempDir();
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    Config::SetCurrent(Config::MAIN_LOAD_IPL_DUMP, false);
+    SConfig::GetInstance().bWii = true;
+    for (auto& device : SConfig::GetInstance().m_EXIDevice)
+      device = ExpansionInterface::EXIDEVICE_NONE;
+    PowerPC::Init(PowerPC::CPUCore::Interpreter);
+    CoreTiming::Init();
+    ExpansionInterface::Init();
+    Memory::Init();
+    EMM::InstallExceptionHandler();
+    Memory::EnableWriteTracking(true);
+    m_initialized = true;
+  }
+
+  void TearDown() override
+  {
+    if (!m_initialized)
+      return;
+
+    Memory::EnableWriteTracking(false);
+    EMM::UninstallExceptionHandler();
+    Memory::Shutdown();
+    ExpansionInterface::Shutdown();
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  static u64 Track(u32 address, u32 size)
+  {
+    u64 count = 0;
+    EXPECT_TRUE(Memory::GetWriteCount(address, size, true, &count));
+    return count;
+  }
+
+  bool m_initialized = false;
+  std::string m_profile_path;
+};
+}  // namespace
+
+TEST_F(MemoryWriteTrackingTest, CountsWrites)
+{
+  if (!m_initialized)
+    return;
+
+  for (u32 address : {0x00010000u, 0x10010000u})
+  {
+    const u64 count = Track(address, PAGE_SIZE * 4);
+    EXPECT_EQ(count, Track(address, PAGE_SIZE * 4));
+
+    // Writes outside of the range don't count
+    Memory::Write_U32(1, address - 4);
+    Memory::Write_U32(1, address + PAGE_SIZE * 4);
+    EXPECT_EQ(count, Track(address, PAGE_SIZE * 4));
+
+    Memory::Write_U32(1, address + PAGE_SIZE * 2);
+    const u64 new_count = Track(address, PAGE_SIZE * 4);
+    EXPECT_NE(count, new_count);
+    EXPECT_EQ(new_count, Track(address, PAGE_SIZE * 4));
+
+    // The same memory through the mirrors
+    Memory::Write_U32(1, (address | 0x80000000) + PAGE_SIZE * 3);
+    EXPECT_NE(new_count, Track(address, PAGE_SIZE * 4));
+
+    EXPECT_EQ(1u, Memory::Read_U32(address + PAGE_SIZE * 2));
+    EXPECT_EQ(1u, Memory::Read_U32(address + PAGE_SIZE * 3));
+  }
+}
+
+TEST_F(MemoryWriteTrackingTest, RejectsUntrackableRanges)
+{
+  if (!m_initialized)
+    return;
+
+  u64 count;
+  EXPECT_FALSE(Memory::GetWriteCount(0x01800000 - PAGE_SIZE, PAGE_SIZE * 2, true, &count));
+  EXPECT_FALSE(Memory::GetWriteCount(0x0C000000, PAGE_SIZE, true, &count));
+  EXPECT_FALSE(Memory::GetWriteCount(0x00010000, 0, true, &count));
+  EXPECT_TRUE(Memory::GetWriteCount(0x01800000 - PAGE_SIZE, PAGE_SIZE, true, &count));
+}
+
+TEST_F(MemoryWriteTrackingTest, CountsWritesFromOtherThreads)
+{
+  if (!m_initialized)
+    return;
+
+  const u32 address = 0x00100000;
+  const u64 count = Track(address, PAGE_SIZE);
+  std::thread([address] { std::memset(Memory::GetPointer(address), 0xAB, PAGE_SIZE); }).join();
+  EXPECT_NE(count, Track(address, PAGE_SIZE));
+  EXPECT_EQ(0xABABABABu, Memory::Read_U32(address + 0x100));
+}
+
+TEST_F(MemoryWriteTrackingTest, HostWrites)
+{
+  if (!m_initialized)
+    return;
+
+  File::IOFile file(m_profile_path + "/data", "w+b");
+  const std::string data(PAGE_SIZE * 2, 'x');
+  ASSERT_TRUE(file.WriteBytes(data.data(), data.size()));
+
+  // The OS doesn't fault on protected pages, so they have to be writable before reading into them
+  const u32 address = 0x00200000;
+  const u64 count = Track(address, PAGE_SIZE * 2);
+  u64 count_during_write;
+  {
+    const Memory::HostWriteAccess access(address, PAGE_SIZE * 2);
+    EXPECT_EQ(Memory::GetPointer(address), access.GetPointer());
+    // Another thread starting to track the range again doesn't protect the pages yet
+    count_during_write = Track(address, PAGE_SIZE * 2);
+    EXPECT_NE(count, count_during_write);
+    ASSERT_TRUE(file.Seek(0, SEEK_SET));
+    EXPECT_TRUE(file.ReadBytes(access.GetPointer(), PAGE_SIZE * 2));
+  }
+  EXPECT_NE(count_during_write, Track(address, PAGE_SIZE * 2));
+
+  // So does disabling tracking
+  Memory::EnableWriteTracking(false);
+  u64 disabled_count;
+  EXPECT_FALSE(Memory::GetWriteCount(address, PAGE_SIZE * 2, true, &disabled_count));
+  ASSERT_TRUE(file.Seek(0, SEEK_SET));
+  EXPECT_TRUE(file.ReadBytes(Memory::GetPointer(address), PAGE_SIZE * 2));
+}
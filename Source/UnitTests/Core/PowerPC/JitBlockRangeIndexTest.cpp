@@ -0,0 +1,123 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <list>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+struct Invalidation
+{
+  u32 address;
+  u32 length;
+};
+
+std::list<JitBlock> MakeBlocks(std::mt19937& rng, size_t count)
+{
+  // Blocks in the 24 MiB of MEM1. Some blocks have a second run of code, like blocks which
+  // follow a branch.
+  std::uniform_int_distribution<u32> address_dist(0, 0x01800000 / 4 - 64);
+  std::uniform_int_distribution<u32> size_dist(1, 48);
+  std::bernoulli_distribution follow_dist(0.25);
+
+  std::list<JitBlock> blocks;
+  for (size_t i = 0; i < count; i++)
+  {
+    JitBlock& block = blocks.emplace_back();
+    std::set<u32> addresses;
+    const int runs = follow_dist(rng) ? 2 : 1;
+    for (int run = 0; run < runs; run++)
+    {
+      const u32 start = address_dist(rng) * 4;
+      const u32 size = size_dist(rng);
+      for (u32 j = 0; j < size; j++)
+        addresses.insert(start + j * 4);
+    }
+    block.physical_addresses.assign(addresses.begin(), addresses.end());
+    block.physicalAddress = block.physical_addresses.front();
+  }
+  return blocks;
+}
+
+std::vector<Invalidation> MakeInvalidations(std::mt19937& rng, size_t count)
+{
+  // Mostly single cache lines (icbi, dcbf), with the occasional DMA-sized write.
+  std::uniform_int_distribution<u32> address_dist(0, 0x01800000 / 32 - 256);
+  std::bernoulli_distribution dma_dist(0.02);
+
+  std::vector<Invalidation> invalidations;
+  for (size_t i = 0; i < count; i++)
+    invalidations.push_back({address_dist(rng) * 32, dma_dist(rng) ? 0x2000u : 32u});
+  return invalidations;
+}
+
+std::vector<JitBlock*> Sorted(std::vector<JitBlock*> blocks)
+{
+  std::sort(blocks.begin(), blocks.end());
+  return blocks;
+}
+}  // namespace
+
+TEST(JitBlockRangeIndex, MatchesBruteForce)
+{
+  std::mt19937 rng(1234);
+  std::list<JitBlock> blocks = MakeBlocks(rng, 2000);
+
+  JitBlockRangeIndex index;
+  for (JitBlock& block : blocks)
+    index.Add(block);
+
+  // Drop some blocks again to make sure removal leaves the other blocks alone.
+  std::vector<JitBlock*> live_blocks;
+  bool remove = false;
+  for (JitBlock& block : blocks)
+  {
+    if (remove)
+      index.Remove(block);
+    else
+      live_blocks.push_back(&block);
+    remove = !remove;
+  }
+
+  for (const Invalidation& invalidation : MakeInvalidations(rng, 5000))
+  {
+    std::vector<JitBlock*> expected;
+    for (JitBlock* block : live_blocks)
+    {
+      if (block->OverlapsPhysicalRange(invalidation.address, invalidation.length))
+        expected.push_back(block);
+    }
+
+    EXPECT_EQ(Sorted(expected),
+              Sorted(index.FindOverlapping(invalidation.address, invalidation.length)));
+  }
+
+  index.Clear();
+  EXPECT_TRUE(index.FindOverlapping(0, 0xFFFFFFFF).empty());
+}
+
+TEST(JitBlockRangeIndex, EdgesOfAddressSpace)
+{
+  JitBlock low;
+  low.physical_addresses = {0x00000000, 0x00000004};
+  JitBlock high;
+  high.physical_addresses = {0xFFFFFFF8, 0xFFFFFFFC};
+
+  JitBlockRangeIndex index;
+  index.Add(low);
+  index.Add(high);
+
+  EXPECT_EQ(std::vector<JitBlock*>{&low}, index.FindOverlapping(0x00000004, 4));
+  EXPECT_TRUE(index.FindOverlapping(0x00000008, 0x100).empty());
+  EXPECT_EQ(std::vector<JitBlock*>{&high}, index.FindOverlapping(0xFFFFFFE0, 0x20));
+  EXPECT_EQ(2u, index.FindOverlapping(0, 0xFFFFFFFF).size());
+}
@@ -0,0 +1,298 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Swap.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
+#include "UICommon/GameFile.h"
+#include "UICommon/GameFileCache.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+class GameFileCacheTest : public testing::Test
+{
+protected:
+  // UpdateAdditionalMetadata reads the config
+  GameFileCacheTest() : m_temp_dir(File::CreateTempDir())
+  {
+    UICommon::SetUserDirectory(m_temp_dir + "/User");
+    Config::Init();
+    Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+  }
+  ~GameFileCacheTest() override
+  {
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_temp_dir);
+  }
+
+  // Writes a minimal GameCube disc header, which is enough for GameFile to consider it valid
+  std::string CreateDisc(int index, size_t size = 0x2440, const std::string& maker = "01")
+  {
+    std::vector<u8> data(size);
+    const std::string game_id = "GT" + std::to_string(10 + index % 90) + maker;
+    std::copy(game_id.begin(), game_id.end(), data.begin());
+    const u32 magic = Common::swap32(0xC2339F3D);
+    std::memcpy(data.data() + 0x1C, &magic, sizeof(magic));
+
+    const std::string path = m_temp_dir + "/game" + std::to_string(index) + ".iso";
+    File::IOFile file(path, "wb");
+    file.WriteBytes(data.data(), data.size());
+    return path;
+  }
+
+  std::shared_ptr<const UICommon::GameFile> Find(const UICommon::GameFileCache& cache,
+                                                 const std::string& path)
+  {
+    std::shared_ptr<const UICommon::GameFile> result;
+    cache.ForEach([&](const std::shared_ptr<const UICommon::GameFile>& game) {
+      if (game->GetFilePath() == path)
+        result = game;
+    });
+    return result;
+  }
+
+  std::string m_temp_dir;
+};
+
+// A 2x1 image with a red and a blue pixel
+constexpr u8 CUSTOM_BANNER_PNG[] = {
+    0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44,
+    0x52, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x08, 0x06, 0x00, 0x00, 0x00, 0xF4,
+    0x22, 0x7F, 0x8A, 0x00, 0x00, 0x00, 0x0E, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9C, 0x63, 0xF8,
+    0xCF, 0xC0, 0x00, 0x42, 0xFF, 0x01, 0x0F, 0xF9, 0x03, 0xFD, 0x85, 0x11, 0x99, 0x76, 0x00,
+    0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82};
+}  // namespace
+
+TEST_F(GameFileCacheTest, UpdateAddsAndRemovesFiles)
+{
+  std::vector<std::string> paths;
+  for (int i = 0; i < 40; ++i)
+    paths.push_back(CreateDisc(i));
+  // Files that aren't games are skipped
+  File::WriteStringToFile("not a game", m_temp_dir + "/invalid.iso");
+  paths.push_back(m_temp_dir + "/invalid.iso");
+
+  UICommon::GameFileCache cache(m_temp_dir + "/gamelist.cache");
+  const std::thread::id this_thread = std::this_thread::get_id();
+  std::set<std::string> added;
+  ASSERT_TRUE(cache.Update(paths, [&](const std::shared_ptr<const UICommon::GameFile>& game) {
+    // The callbacks must run on the calling thread even though the files are read on others
+    EXPECT_EQ(this_thread, std::this_thread::get_id());
+    EXPECT_TRUE(added.insert(game->GetFilePath()).second);
+  }));
+  EXPECT_EQ(40u, added.size());
+  EXPECT_EQ(40u, cache.GetSize());
+  EXPECT_EQ(0u, added.count(m_temp_dir + "/invalid.iso"));
+
+  // Nothing changes the second time
+  EXPECT_FALSE(cache.Update(paths));
+
+  std::vector<std::string> removed;
+  paths.erase(paths.begin(), paths.begin() + 5);
+  EXPECT_TRUE(cache.Update(paths, {}, [&](const std::string& path) { removed.push_back(path); }));
+  EXPECT_EQ(5u, removed.size());
+  EXPECT_EQ(35u, cache.GetSize());
+}
+
+TEST_F(GameFileCacheTest, SaveAndLoad)
+{
+  std::vector<std::string> paths;
+  for (int i = 0; i < 10; ++i)
+    paths.push_back(CreateDisc(i));
+
+  const std::string cache_path = m_temp_dir + "/gamelist.cache";
+  {
+    UICommon::GameFileCache cache(cache_path);
+    cache.Update(paths);
+    ASSERT_TRUE(cache.Save());
+    // The temporary file has replaced the cache
+    EXPECT_FALSE(File::Exists(cache_path + ".tmp"));
+  }
+
+  UICommon::GameFileCache cache(cache_path);
+  ASSERT_TRUE(cache.Load());
+  EXPECT_EQ(10u, cache.GetSize());
+  std::set<std::string> game_ids;
+  cache.ForEach([&](const std::shared_ptr<const UICommon::GameFile>& game) {
+    game_ids.insert(game->GetGameID());
+  });
+  EXPECT_EQ(10u, game_ids.size());
+  EXPECT_FALSE(cache.Update(paths));
+}
+
+TEST_F(GameFileCacheTest, ImagesAreLoadedLazily)
+{
+  std::vector<std::string> paths;
+  for (int i = 0; i < 5; ++i)
+    paths.push_back(CreateDisc(i));
+  File::IOFile png(m_temp_dir + "/game0.png", "wb");
+  png.WriteBytes(CUSTOM_BANNER_PNG, sizeof(CUSTOM_BANNER_PNG));
+  png.Close();
+
+  const std::string cache_path = m_temp_dir + "/gamelist.cache";
+  {
+    UICommon::GameFileCache cache(cache_path);
+    cache.Update(paths);
+    EXPECT_TRUE(cache.UpdateAdditionalMetadata());
+    ASSERT_TRUE(cache.Save());
+  }
+
+  UICommon::GameFileCache cache(cache_path);
+  ASSERT_TRUE(cache.Load());
+  std::shared_ptr<const UICommon::GameFile> game = Find(cache, paths[0]);
+  ASSERT_TRUE(game);
+  EXPECT_FALSE(game->AreImagesLoaded());
+
+  // Checking whether the banner has changed doesn't need the banner itself
+  EXPECT_FALSE(cache.UpdateAdditionalMetadata());
+  EXPECT_FALSE(cache.Update(paths));
+  game = Find(cache, paths[0]);
+  EXPECT_FALSE(game->AreImagesLoaded());
+
+  const UICommon::GameBanner& banner = game->GetBannerImage();
+  EXPECT_TRUE(game->AreImagesLoaded());
+  ASSERT_EQ(2u, banner.width);
+  ASSERT_EQ(1u, banner.height);
+  EXPECT_EQ(0xFFFF0000u, banner.buffer[0]);
+  EXPECT_EQ(0x000000FFu, banner.buffer[1]);
+  EXPECT_TRUE(Find(cache, paths[1])->GetBannerImage().empty());
+
+  // The images that weren't loaded survive the cache file being rewritten
+  cache.Clear(UICommon::GameFileCache::DeleteOnDisk::No);
+  cache.Update(paths);
+  ASSERT_TRUE(cache.Load());
+  paths.pop_back();
+  cache.Update(paths);
+  ASSERT_TRUE(cache.Save());
+  UICommon::GameFileCache reloaded(cache_path);
+  ASSERT_TRUE(reloaded.Load());
+  EXPECT_EQ(4u, reloaded.GetSize());
+  EXPECT_EQ(2u, Find(reloaded, paths[0])->GetBannerImage().width);
+}
+
+TEST_F(GameFileCacheTest, ImagesThatCantBeReadStayUnloaded)
+{
+  const std::string path = CreateDisc(0);
+  File::IOFile png(m_temp_dir + "/game0.png", "wb");
+  png.WriteBytes(CUSTOM_BANNER_PNG, sizeof(CUSTOM_BANNER_PNG));
+  png.Close();
+
+  UICommon::GameFile game(path);
+  ASSERT_TRUE(game.IsValid());
+  auto readable = std::make_shared<bool>(false);
+  game.SetImageLoader([readable](UICommon::GameImages* images) {
+    images->default_cover.buffer = {1, 2, 3};
+    return *readable;
+  });
+
+  EXPECT_FALSE(game.LoadImages());
+  EXPECT_TRUE(game.GetImages().default_cover.empty());
+  EXPECT_FALSE(game.AreImagesLoaded());
+
+  // The modification of a copy waits for the images that it doesn't modify
+  UICommon::GameFile copy(game);
+  ASSERT_TRUE(copy.CustomBannerChanged());
+  copy.CustomBannerCommit();
+  EXPECT_FALSE(copy.AreImagesLoaded());
+  EXPECT_FALSE(copy.CustomBannerChanged());
+
+  *readable = true;
+  EXPECT_TRUE(copy.LoadImages());
+  EXPECT_EQ(2u, copy.GetBannerImage().width);
+  EXPECT_EQ(3u, copy.GetImages().default_cover.buffer.size());
+  EXPECT_TRUE(game.GetBannerImage().empty());
+  EXPECT_EQ(3u, game.GetImages().default_cover.buffer.size());
+}
+
+TEST_F(GameFileCacheTest, SaveOnlyAppendsChangedFiles)
+{
+  std::vector<std::string> paths;
+  for (int i = 0; i < 20; ++i)
+    paths.push_back(CreateDisc(i));
+
+  const std::string cache_path = m_temp_dir + "/gamelist.cache";
+  UICommon::GameFileCache cache(cache_path);
+  cache.Update(paths);
+  ASSERT_TRUE(cache.Save());
+  const u64 full_size = File::GetSize(cache_path);
+
+  // Saving without changes doesn't touch the file
+  ASSERT_TRUE(cache.Save());
+  EXPECT_EQ(full_size, File::GetSize(cache_path));
+
+  // Replacing one file appends one record and marks one as dead
+  paths[0] = CreateDisc(20);
+  EXPECT_TRUE(cache.Update(paths));
+  ASSERT_TRUE(cache.Save());
+  const u64 appended_size = File::GetSize(cache_path);
+  EXPECT_GT(appended_size, full_size);
+  EXPECT_LT(appended_size, full_size + full_size / 10);
+
+  {
+    UICommon::GameFileCache reloaded(cache_path);
+    ASSERT_TRUE(reloaded.Load());
+    EXPECT_EQ(20u, reloaded.GetSize());
+    EXPECT_TRUE(Find(reloaded, paths[0]));
+    EXPECT_FALSE(reloaded.Update(paths));
+  }
+
+  // Once most of the file is dead records, it gets rewritten
+  paths.resize(5);
+  EXPECT_TRUE(cache.Update(paths));
+  ASSERT_TRUE(cache.Save());
+  ASSERT_TRUE(cache.Save());
+  EXPECT_LT(File::GetSize(cache_path), full_size / 2);
+
+  UICommon::GameFileCache reloaded(cache_path);
+  ASSERT_TRUE(reloaded.Load());
+  EXPECT_EQ(5u, reloaded.GetSize());
+  EXPECT_FALSE(reloaded.Update(paths));
+}
+
+TEST_F(GameFileCacheTest, ModifiedFilesAreReadAgain)
+{
+  std::vector<std::string> paths;
+  for (int i = 0; i < 3; ++i)
+    paths.push_back(CreateDisc(i));
+
+  const std::string cache_path = m_temp_dir + "/gamelist.cache";
+  {
+    UICommon::GameFileCache cache(cache_path);
+    cache.Update(paths);
+    ASSERT_TRUE(cache.Save());
+  }
+
+  // A different size is detected even if the modification time has a coarse resolution
+  CreateDisc(1, 0x4000, "02");
+
+  UICommon::GameFileCache cache(cache_path);
+  ASSERT_TRUE(cache.Load());
+  std::vector<std::string> added;
+  std::vector<std::string> removed;
+  EXPECT_TRUE(cache.Update(
+      paths,
+      [&](const std::shared_ptr<const UICommon::GameFile>& game) {
+        added.push_back(game->GetFilePath());
+      },
+      [&](const std::string& path) { removed.push_back(path); }));
+  EXPECT_EQ(std::vector<std::string>{paths[1]}, added);
+  EXPECT_EQ(std::vector<std::string>{paths[1]}, removed);
+  EXPECT_EQ(3u, cache.GetSize());
+  EXPECT_EQ("GT1102", Find(cache, paths[1])->GetGameID());
+  EXPECT_FALSE(cache.Update(paths));
+}
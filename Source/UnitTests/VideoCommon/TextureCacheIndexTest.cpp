@@ -0,0 +1,198 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/TextureCacheIndex.h"
+
+namespace
+{
+struct Entry
+{
+  VideoCommon::IndexLink<Entry, u32> address_link;
+  VideoCommon::IndexLink<Entry, u64> hash_link;
+};
+
+using AddressIndex = VideoCommon::AddressIndex<Entry, &Entry::address_link>;
+using HashIndex = VideoCommon::HashIndex<Entry, &Entry::hash_link>;
+
+template <typename Iterator>
+std::vector<Entry*> ToVector(Iterator begin, Iterator end)
+{
+  std::vector<Entry*> entries;
+  for (; begin != end; ++begin)
+    entries.push_back(*begin);
+  return entries;
+}
+
+template <typename Iterator>
+std::vector<Entry*> ValuesOf(Iterator begin, Iterator end)
+{
+  std::vector<Entry*> entries;
+  for (; begin != end; ++begin)
+    entries.push_back(begin->second);
+  return entries;
+}
+
+Entry* Get(AddressIndex::iterator iter)
+{
+  return *iter;
+}
+
+Entry* Get(std::multimap<u32, Entry*>::const_iterator iter, const std::multimap<u32, Entry*>& map)
+{
+  return iter == map.end() ? nullptr : iter->second;
+}
+
+// Mostly texture-like addresses, with many entries on the same page or the same address, and the
+// occasional address at the very top.
+u32 RandomAddress(std::mt19937& rng)
+{
+  switch (rng() % 4)
+  {
+  case 0:
+    return static_cast<u32>(rng() % 64) * 32;
+  case 1:
+    return 0x10000000 + static_cast<u32>(rng() % 0x100000) * 32;
+  case 2:
+    return static_cast<u32>(rng() % 0x1800000) & ~31u;
+  default:
+    return rng() % 8 ? static_cast<u32>(rng() % 0x20000000) : ~static_cast<u32>(rng() % 4);
+  }
+}
+}  // namespace
+
+TEST(TextureCacheIndex, AddressIndexMatchesMultimap)
+{
+  std::mt19937 rng(1);
+  std::vector<std::unique_ptr<Entry>> entries;
+  AddressIndex index;
+  std::multimap<u32, Entry*> expected;
+
+  const auto erase = [&](Entry* entry) {
+    const u32 addr = entry->address_link.key;
+    auto range = expected.equal_range(addr);
+    while (range.first->second != entry)
+      ++range.first;
+    expected.erase(range.first);
+    return index.erase(AddressIndex::iterator(entry));
+  };
+
+  for (int step = 0; step < 20000; ++step)
+  {
+    if (rng() % 3 != 0 || expected.empty())
+    {
+      entries.push_back(std::make_unique<Entry>());
+      const u32 addr = RandomAddress(rng);
+      index.insert(addr, entries.back().get());
+      expected.emplace(addr, entries.back().get());
+    }
+    else
+    {
+      auto iter = expected.begin();
+      std::advance(iter, rng() % expected.size());
+      erase(iter->second);
+    }
+
+    const u32 addr = RandomAddress(rng);
+    ASSERT_EQ(Get(expected.lower_bound(addr), expected), Get(index.lower_bound(addr)));
+    ASSERT_EQ(Get(expected.upper_bound(addr), expected), Get(index.upper_bound(addr)));
+    ASSERT_EQ(expected.size(), index.size());
+
+    if (step % 1000 == 0)
+    {
+      ASSERT_EQ(ValuesOf(expected.cbegin(), expected.cend()), ToVector(index.begin(), index.end()));
+    }
+  }
+
+  // Walk a range like the texture cache does, removing some entries and adding others on the way
+  const u32 first = 0x10000000;
+  const u32 last = 0x10400000;
+  std::vector<Entry*> visited;
+  for (auto iter = index.lower_bound(first); iter != index.upper_bound(last);)
+  {
+    Entry* entry = *iter;
+    visited.push_back(entry);
+    if (rng() % 2)
+    {
+      ++iter;
+      continue;
+    }
+
+    iter = erase(entry);
+    entries.push_back(std::make_unique<Entry>());
+    const u32 addr = first + static_cast<u32>(rng() % (last - first));
+    index.insert(addr, entries.back().get());
+    expected.emplace(addr, entries.back().get());
+  }
+  EXPECT_FALSE(visited.empty());
+  EXPECT_EQ(ValuesOf(expected.cbegin(), expected.cend()), ToVector(index.begin(), index.end()));
+
+  for (const auto& pair : expected)
+  {
+    auto range = index.equal_range(pair.first);
+    auto expected_range = expected.equal_range(pair.first);
+    EXPECT_EQ(ValuesOf(expected_range.first, expected_range.second),
+              ToVector(range.first, range.second));
+  }
+
+  while (!expected.empty())
+    erase(expected.begin()->second);
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(index.begin(), index.end());
+  EXPECT_EQ(index.lower_bound(0), index.end());
+}
+
+TEST(TextureCacheIndex, HashIndexMatchesMultimap)
+{
+  std::mt19937_64 rng(2);
+  std::vector<std::unique_ptr<Entry>> entries;
+  HashIndex index;
+  std::multimap<u64, Entry*> expected;
+
+  const auto check = [&](u64 hash) {
+    auto range = index.equal_range(hash);
+    auto expected_range = expected.equal_range(hash);
+    ASSERT_EQ(ValuesOf(expected_range.first, expected_range.second),
+              ToVector(range.first, range.second))
+        << hash;
+  };
+
+  for (int step = 0; step < 50000; ++step)
+  {
+    // Enough distinct hashes to grow the table a few times, and enough repeats for long chains
+    const u64 hash = rng() % 4 ? rng() : rng() % 16;
+    if (rng() % 5 < 3 || expected.empty())
+    {
+      entries.push_back(std::make_unique<Entry>());
+      index.insert(hash, entries.back().get());
+      expected.emplace(hash, entries.back().get());
+    }
+    else
+    {
+      auto iter = expected.begin();
+      std::advance(iter, rng() % std::min<size_t>(expected.size(), 64));
+      const u64 erased_hash = iter->first;
+      Entry* entry = iter->second;
+      expected.erase(iter);
+      EXPECT_TRUE(index.contains(entry));
+      EXPECT_TRUE(index.erase(entry));
+      EXPECT_FALSE(index.contains(entry));
+      EXPECT_FALSE(index.erase(entry));
+      check(erased_hash);
+    }
+
+    check(hash);
+    ASSERT_EQ(expected.size(), index.size());
+  }
+
+  for (const auto& pair : expected)
+    check(pair.first);
+}
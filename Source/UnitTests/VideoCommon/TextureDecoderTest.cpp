@@ -0,0 +1,173 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "VideoCommon/TextureDecoder.h"
+
+namespace
+{
+constexpr TextureFormat FORMATS[] = {
+    TextureFormat::I4,     TextureFormat::I8,     TextureFormat::IA4, TextureFormat::IA8,
+    TextureFormat::RGB565, TextureFormat::RGB5A3, TextureFormat::RGBA8, TextureFormat::C4,
+    TextureFormat::C8,     TextureFormat::C14X2,  TextureFormat::CMPR,
+};
+
+struct Size
+{
+  int width;
+  int height;
+};
+
+// Typical sizes, already expanded to whole blocks. 640x456 doesn't split into equal bands.
+constexpr Size SIZES[] = {{64, 64}, {256, 256}, {640, 456}, {1024, 1024}};
+
+std::vector<u8> MakeRandomData(size_t size, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<u8> data(size);
+  std::generate(data.begin(), data.end(), [&rng] { return static_cast<u8>(rng()); });
+  return data;
+}
+
+u32 GetNumThreads()
+{
+  return std::max(2u, std::thread::hardware_concurrency()) - 1;
+}
+
+class TextureDecoderTest : public testing::Test
+{
+protected:
+  ~TextureDecoderTest() override { TexDecoder_SetDecodingThreads(0); }
+
+  std::vector<u8> Decode(const std::vector<u8>& src, Size size, TextureFormat format)
+  {
+    std::vector<u8> dst(size.width * size.height * sizeof(u32));
+    TexDecoder_Decode(dst.data(), src.data(), size.width, size.height, format, m_tlut.data(),
+                      TLUTFormat::RGB5A3);
+    return dst;
+  }
+
+  // Big enough for C14X2
+  const std::vector<u8> m_tlut = MakeRandomData(0x8000, 1);
+};
+}  // namespace
+
+TEST_F(TextureDecoderTest, ParallelDecodingIsBitExact)
+{
+  for (TextureFormat format : FORMATS)
+  {
+    for (Size size : SIZES)
+    {
+      const std::vector<u8> src = MakeRandomData(
+          TexDecoder_GetTextureSizeInBytes(size.width, size.height, format), size.width);
+
+      TexDecoder_SetDecodingThreads(0);
+      const std::vector<u8> expected = Decode(src, size, format);
+      TexDecoder_SetDecodingThreads(GetNumThreads());
+      EXPECT_EQ(expected, Decode(src, size, format))
+          << static_cast<int>(format) << " " << size.width << "x" << size.height;
+    }
+  }
+}
+
+TEST_F(TextureDecoderTest, DecodeLevelsMatchesDecodingEachLevel)
+{
+  TexDecoder_SetDecodingThreads(GetNumThreads());
+
+  for (TextureFormat format : FORMATS)
+  {
+    // A full mip chain, down to a single block
+    std::vector<Size> sizes;
+    for (int size = 1024; size >= 8; size /= 2)
+      sizes.push_back({size, size});
+
+    std::vector<std::vector<u8>> sources;
+    std::vector<std::vector<u8>> decoded;
+    std::vector<TextureDecodeLevel> levels;
+    for (Size size : sizes)
+    {
+      sources.push_back(MakeRandomData(
+          TexDecoder_GetTextureSizeInBytes(size.width, size.height, format), size.width));
+      decoded.emplace_back(size.width * size.height * sizeof(u32));
+    }
+    for (size_t i = 0; i < sizes.size(); ++i)
+      levels.push_back({decoded[i].data(), sources[i].data(), sizes[i].width, sizes[i].height});
+
+    TexDecoder_DecodeLevels(levels.data(), levels.size(), format, m_tlut.data(),
+                            TLUTFormat::RGB5A3);
+
+    for (size_t i = 0; i < sizes.size(); ++i)
+      EXPECT_EQ(Decode(sources[i], sizes[i], format), decoded[i]) << static_cast<int>(format);
+  }
+}
+
+#ifdef _M_X86
+TEST_F(TextureDecoderTest, EveryDecoderMatchesGenericDecoder)
+{
+  struct InstructionSets
+  {
+    const char* name;
+    bool ssse3;
+    bool avx2;
+  };
+  std::vector<InstructionSets> instruction_sets = {{"SSE2", false, false}};
+  if (cpu_info.bSSSE3)
+    instruction_sets.push_back({"SSSE3", true, false});
+  if (cpu_info.bAVX2)
+    instruction_sets.push_back({"AVX2", true, true});
+
+  std::mt19937 rng(1234);
+  for (int i = 0; i < 50; ++i)
+  {
+    // Any size made of whole 8x8 tiles, which covers the blocks of every format
+    const int width = 8 * static_cast<int>(rng() % 24 + 1);
+    const Size size = {width, 8 * static_cast<int>(rng() % 24 + 1)};
+    const std::vector<u8> tlut = MakeRandomData(0x8000, rng());
+
+    for (TextureFormat format : FORMATS)
+    {
+      const int size_in_bytes = TexDecoder_GetTextureSizeInBytes(size.width, size.height, format);
+      std::vector<u8> src = MakeRandomData(size_in_bytes, rng());
+      if (format == TextureFormat::CMPR)
+      {
+        // Random DXT blocks hardly ever have two equal colors, which is where blending the colors
+        // turns into averaging them
+        for (size_t block = 0; block < src.size(); block += 24)
+          std::copy_n(&src[block], 2, &src[block + 2]);
+      }
+
+      for (TLUTFormat tlutfmt : {TLUTFormat::IA8, TLUTFormat::RGB565, TLUTFormat::RGB5A3})
+      {
+        if (!IsColorIndexed(format) && tlutfmt != TLUTFormat::IA8)
+          continue;
+
+        std::vector<u32> expected(size.width * size.height);
+        _TexDecoder_DecodeImpl_Generic(expected.data(), src.data(), size.width, size.height,
+                                       format, tlut.data(), tlutfmt);
+
+        for (const InstructionSets& sets : instruction_sets)
+        {
+          _TexDecoder_SelectDecoders(sets.ssse3, sets.avx2);
+          std::vector<u32> decoded(expected.size());
+          _TexDecoder_DecodeImpl(decoded.data(), src.data(), size.width, size.height, format,
+                                 tlut.data(), tlutfmt);
+          EXPECT_EQ(expected, decoded)
+              << sets.name << " format 0x" << std::hex << static_cast<int>(format) << " tlut "
+              << static_cast<int>(tlutfmt) << std::dec << " " << size.width << "x" << size.height;
+        }
+      }
+    }
+  }
+
+  _TexDecoder_SelectDecoders(cpu_info.bSSSE3, cpu_info.bAVX2);
+}
+#endif